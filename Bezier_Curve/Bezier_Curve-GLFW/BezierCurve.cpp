@@ -3,8 +3,14 @@
 #include "RenderShape.h"
 #include "InteractiveShape.h"
 #include "Init_Shader.h"
+#include "BezierEvaluator.h"
+#include "BasisCache.h"
+#include "StreamBuffer.h"
+#include "RenderBackend.h"
+#include "Profiler.h"
 
 #include <vector>
+#include <cstring>
 
 BezierCurve::BezierCurve(InteractiveShape& markerTemplate, RenderShape& slopeLineTemplate, int maxNumVerts)
 {
@@ -14,20 +20,20 @@ BezierCurve::BezierCurve(InteractiveShape& markerTemplate, RenderShape& slopeLin
 	_controlPoints[3] = glm::vec3(+0.75f, 0.0f, 0.0f);
 
 	_controlPointerMarkers[0] = new InteractiveShape(markerTemplate);
-	_controlPointerMarkers[0]->transform().scale = glm::vec3(0.025f, 0.025f, 0.025f);
-	_controlPointerMarkers[0]->transform().position = _controlPoints[0];
+	_controlPointerMarkers[0]->transform().scale(glm::vec3(0.025f, 0.025f, 0.025f));
+	_controlPointerMarkers[0]->transform().position(_controlPoints[0]);
 
 	_controlPointerMarkers[1] = new InteractiveShape(markerTemplate);
-	_controlPointerMarkers[1]->transform().scale = glm::vec3(0.025f, 0.025f, 0.025f);
-	_controlPointerMarkers[1]->transform().position = _controlPoints[1];
+	_controlPointerMarkers[1]->transform().scale(glm::vec3(0.025f, 0.025f, 0.025f));
+	_controlPointerMarkers[1]->transform().position(_controlPoints[1]);
 
 	_controlPointerMarkers[2] = new InteractiveShape(markerTemplate);
-	_controlPointerMarkers[2]->transform().scale = glm::vec3(0.025f, 0.025f, 0.025f);
-	_controlPointerMarkers[2]->transform().position = _controlPoints[2];
+	_controlPointerMarkers[2]->transform().scale(glm::vec3(0.025f, 0.025f, 0.025f));
+	_controlPointerMarkers[2]->transform().position(_controlPoints[2]);
 
 	_controlPointerMarkers[3] = new InteractiveShape(markerTemplate);
-	_controlPointerMarkers[3]->transform().scale = glm::vec3(0.025f, 0.025f, 0.025f);
-	_controlPointerMarkers[3]->transform().position = _controlPoints[3];
+	_controlPointerMarkers[3]->transform().scale(glm::vec3(0.025f, 0.025f, 0.025f));
+	_controlPointerMarkers[3]->transform().position(_controlPoints[3]);
 
 	RenderManager::AddShape(_controlPointerMarkers[0]);
 	RenderManager::AddShape(_controlPointerMarkers[1]);
@@ -43,27 +49,27 @@ BezierCurve::BezierCurve(InteractiveShape& markerTemplate, RenderShape& slopeLin
 	_numVerts = maxNumVerts;
 	_maxNumVerts = maxNumVerts;
 
-	GLfloat data = 0.0f;
-	GLint elements = 0;
+	_mode = TESSELLATE_UNIFORM;
+	_tolerance = 0.001f;
 
-	glGenVertexArrays(1, &_vao);
-	glBindVertexArray(_vao);
+	// Either mode fits, adaptive mode emits at most one vertex per span at the deepest level plus the first one
+	int maxDrawnVerts = glm::max(maxNumVerts, (1 << MAX_DEPTH) + 1);
 
-	glGenBuffers(1, &_vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat), &data, GL_DYNAMIC_DRAW);
+	// The curve is a line strip, so the same run of indices works for any vertex count
+	std::vector<GLint> elements = std::vector<GLint>();
+	elements.resize(maxDrawnVerts);
+	for (int i = 0; i < maxDrawnVerts; ++i)
+	{
+		elements[i] = i;
+	}
 
-	glGenBuffers(1, &_ebo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLint), &elements, GL_DYNAMIC_DRAW);
+	RenderBackend& backend = RenderBackend::Get();
+	_stream = new StreamBuffer(sizeof(GLfloat) * 3, maxDrawnVerts);
+	_ebo = backend.CreateBuffer(sizeof(GLint) * maxDrawnVerts, (void*)&elements[0], GL_STATIC_DRAW);
+	_vao = backend.CreateVertexArray(_ebo);
 
 	// Bind buffer data to shader values
-	GLint posAttrib = glGetAttribLocation(slopeLineTemplate.shader().shaderPointer, "position");
-	glEnableVertexAttribArray(posAttrib);
-	glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-	GLint uTransform = glGetUniformLocation(slopeLineTemplate.shader().shaderPointer, "transform");
-	GLint uColor = glGetUniformLocation(slopeLineTemplate.shader().shaderPointer, "color");
+	backend.VertexAttribute(_vao, _stream->vbo(), backend.AttribLocation(slopeLineTemplate.shader().shaderPointer, "position"), 3, 0, 0);
 	
 	_curve = new RenderShape(_vao, 0, GL_LINE_STRIP, slopeLineTemplate.shader());
 
@@ -72,18 +78,20 @@ BezierCurve::BezierCurve(InteractiveShape& markerTemplate, RenderShape& slopeLin
 }
 BezierCurve::~BezierCurve()
 {
-	glDeleteVertexArrays(1, &_vao);
-	glDeleteBuffers(1, &_vbo);
-	glDeleteBuffers(1, &_vao);
+	RenderBackend::Get().DeleteVertexArray(_vao);
+	delete _stream;
+	RenderBackend::Get().DeleteBuffer(_ebo);
 }
 
 void BezierCurve::Update()
 {
+	PROFILE_ZONE("BezierCurve::Update");
+
 	bool markerMoved[4];
-	markerMoved[0] = _controlPoints[0] != _controlPointerMarkers[0]->transform().position;
-	markerMoved[1] = _controlPoints[1] != _controlPointerMarkers[1]->transform().position;
-	markerMoved[2] = _controlPoints[2] != _controlPointerMarkers[2]->transform().position;
-	markerMoved[3] = _controlPoints[3] != _controlPointerMarkers[3]->transform().position;
+	markerMoved[0] = _controlPoints[0] != _controlPointerMarkers[0]->transform().position();
+	markerMoved[1] = _controlPoints[1] != _controlPointerMarkers[1]->transform().position();
+	markerMoved[2] = _controlPoints[2] != _controlPointerMarkers[2]->transform().position();
+	markerMoved[3] = _controlPoints[3] != _controlPointerMarkers[3]->transform().position();
 
 	if (markerMoved[0] || markerMoved[1] || markerMoved[2] || markerMoved[3])
 	{
@@ -94,10 +102,10 @@ void BezierCurve::Update()
 void  BezierCurve::UpdateShapes()
 {
 	// Update the control points
-	_controlPoints[0] = _controlPointerMarkers[0]->transform().position;
-	_controlPoints[1] = _controlPointerMarkers[1]->transform().position;
-	_controlPoints[2] = _controlPointerMarkers[2]->transform().position;
-	_controlPoints[3] = _controlPointerMarkers[3]->transform().position;
+	_controlPoints[0] = _controlPointerMarkers[0]->transform().position();
+	_controlPoints[1] = _controlPointerMarkers[1]->transform().position();
+	_controlPoints[2] = _controlPointerMarkers[2]->transform().position();
+	_controlPoints[3] = _controlPointerMarkers[3]->transform().position();
 
 	// Update the slope lines
 	glm::vec3 start0 = _controlPoints[0];
@@ -110,8 +118,8 @@ void  BezierCurve::UpdateShapes()
 
 	glm::vec3 startingVec = glm::vec3(0.7071f, 0.7071f, 0.0f);
 
-	_slopeLines[0]->transform().position = (start0 + end0) / 2.0f;
-	_slopeLines[1]->transform().position = (start1 + end1) / 2.0f;
+	_slopeLines[0]->transform().position((start0 + end0) / 2.0f);
+	_slopeLines[1]->transform().position((start1 + end1) / 2.0f);
 
 	float angle0 = acosf(glm::dot(line0, startingVec) / glm::length(line0));
 	float angle1 = acosf(glm::dot(line1, startingVec) / glm::length(line1));
@@ -119,11 +127,11 @@ void  BezierCurve::UpdateShapes()
 	glm::vec3 axis0 = glm::cross(line0, startingVec);
 	glm::vec3 axis1 = glm::cross(line1, startingVec);
 
-	_slopeLines[0]->transform().rotation = glm::angleAxis(angle0, axis0);
-	_slopeLines[1]->transform().rotation = glm::angleAxis(angle1, axis1);
+	_slopeLines[0]->transform().rotation(glm::angleAxis(angle0, axis0));
+	_slopeLines[1]->transform().rotation(glm::angleAxis(angle1, axis1));
 
-	_slopeLines[0]->transform().scale = line0 / 2.0f;
-	_slopeLines[1]->transform().scale = line1 / 2.0f;
+	_slopeLines[0]->transform().scale(line0 / 2.0f);
+	_slopeLines[1]->transform().scale(line1 / 2.0f);
 
 	// Update the curve
 	UpdateCurve();
@@ -131,34 +139,73 @@ void  BezierCurve::UpdateShapes()
 
 void BezierCurve::UpdateCurve()
 {
-	int numDataPoints = _numVerts * 3;
-	std::vector<GLfloat> data = std::vector<GLfloat>();
-	data.resize(numDataPoints);
-	std::vector<GLint> elements = std::vector<GLint>();
-	elements.resize(_numVerts);
-	for (int i = 0; i < _numVerts; ++i)
+	int numVerts = 0;
+	if (_mode == TESSELLATE_ADAPTIVE)
+	{
+		// The first point is emitted here, every accepted span adds its end point
+		_data.clear();
+		_data.push_back(_controlPoints[0].x);
+		_data.push_back(_controlPoints[0].y);
+		_data.push_back(_controlPoints[0].z);
+		TessellateAdaptive(_controlPoints, 0);
+
+		numVerts = _data.size() / 3;
+		memcpy(_stream->Map(), &_data[0], sizeof(GLfloat) * _data.size());
+	}
+	else
 	{
-		float t = (float)i / ((float)_numVerts - 1.0f);
+		numVerts = _numVerts;
+		TessellateUniform((GLfloat*)_stream->Map());
+	}
+	_stream->Unmap(0, sizeof(GLfloat) * numVerts * 3);
 
-		//Blending factors
-		float factor0 = (1 - t) * (1 - t) * (1 - t);	// 1-u^3
-		float factor1 = 3 * t * ((1 - t) * (1 - t));	// 3u(1-u)^2
-		float factor2 = 3 * (t * t) * (1 - t);			// 3u^2(1-u)
-		float factor3 = t * t * t;						// u^3
+	_curve->baseVertex(_stream->baseVertex());
+	_curve->count(numVerts);
+}
 
-		data[i * 3] = factor0 * _controlPoints[0].x + factor1 * _controlPoints[1].x + factor2 * _controlPoints[2].x + factor3 * _controlPoints[3].x;
-		data[i * 3 + 1] = factor0 * _controlPoints[0].y + factor1 * _controlPoints[1].y + factor2 * _controlPoints[2].y + factor3 * _controlPoints[3].y;
-		data[i * 3 + 2] = factor0 * _controlPoints[0].z + factor1 * _controlPoints[1].z + factor2 * _controlPoints[2].z + factor3 * _controlPoints[3].z;
-		elements[i] = i;
+void BezierCurve::TessellateUniform(GLfloat* data)
+{
+	//Blending factors, shared by every curve with the same vertex count
+	const GLfloat* basis = BasisCache::Bernstein(3, _numVerts);
+
+	BezierEvaluator::EvaluateCurve(_controlPoints, basis, BezierEvaluator::Stride(_numVerts), _numVerts, data);
+}
+
+void BezierCurve::TessellateAdaptive(const glm::vec3* controlPoints, int depth)
+{
+	// The curve stays inside the hull of its control points, so if the inner two are within tolerance of the chord
+	// the whole span is as well
+	glm::vec3 chord = controlPoints[3] - controlPoints[0];
+	GLfloat chordLengthSqr = glm::dot(chord, chord);
+	GLfloat deviationSqr = 0.0f;
+	for (int i = 1; i < 3; ++i)
+	{
+		glm::vec3 offset = controlPoints[i] - controlPoints[0];
+		GLfloat t = chordLengthSqr > 0.0f ? glm::clamp(glm::dot(offset, chord) / chordLengthSqr, 0.0f, 1.0f) : 0.0f;
+		glm::vec3 distance = offset - chord * t;
+		deviationSqr = glm::max(deviationSqr, glm::dot(distance, distance));
 	}
-	glBindVertexArray(_vao);
 
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * numDataPoints, (void*)&data[0], GL_DYNAMIC_DRAW);
+	if (deviationSqr <= _tolerance * _tolerance || depth >= MAX_DEPTH)
+	{
+		_data.push_back(controlPoints[3].x);
+		_data.push_back(controlPoints[3].y);
+		_data.push_back(controlPoints[3].z);
+		return;
+	}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLint) * _numVerts, (void*)&elements[0], GL_DYNAMIC_DRAW);
-	_curve->count(_numVerts);
+	// Split in half with de Casteljau
+	glm::vec3 ab = (controlPoints[0] + controlPoints[1]) * 0.5f;
+	glm::vec3 bc = (controlPoints[1] + controlPoints[2]) * 0.5f;
+	glm::vec3 cd = (controlPoints[2] + controlPoints[3]) * 0.5f;
+	glm::vec3 abc = (ab + bc) * 0.5f;
+	glm::vec3 bcd = (bc + cd) * 0.5f;
+	glm::vec3 mid = (abc + bcd) * 0.5f;
+
+	glm::vec3 left[4] = { controlPoints[0], ab, abc, mid };
+	glm::vec3 right[4] = { mid, bcd, cd, controlPoints[3] };
+	TessellateAdaptive(left, depth + 1);
+	TessellateAdaptive(right, depth + 1);
 }
 
 void BezierCurve::numVerts(int newNumVerts)
@@ -166,7 +213,29 @@ void BezierCurve::numVerts(int newNumVerts)
 	if (newNumVerts != _numVerts && newNumVerts <= _maxNumVerts && newNumVerts >= 1)
 	{
 		_numVerts = newNumVerts;
-		UpdateCurve();
+		if (_mode == TESSELLATE_UNIFORM) UpdateCurve();
 	}
 }
 int BezierCurve::numVerts() { return _numVerts; }
+
+void BezierCurve::mode(TessellationMode newMode)
+{
+	if (newMode != _mode)
+	{
+		_mode = newMode;
+		UpdateCurve();
+	}
+}
+BezierCurve::TessellationMode BezierCurve::mode() { return _mode; }
+
+void BezierCurve::tolerance(GLfloat newTolerance)
+{
+	if (newTolerance != _tolerance && newTolerance > 0.0f)
+	{
+		_tolerance = newTolerance;
+		if (_mode == TESSELLATE_ADAPTIVE) UpdateCurve();
+	}
+}
+GLfloat BezierCurve::tolerance() { return _tolerance; }
+
+int BezierCurve::drawnVerts() { return _curve->count(); }
@@ -1,13 +1,21 @@
 #pragma once
-#include <GLEW\GL\glew.h>
-#include <GLM\gtc\matrix_transform.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <vector>
 
 class InteractiveShape;
 class RenderShape;
+class StreamBuffer;
 
 class BezierCurve
 {
 public:
+	enum TessellationMode
+	{
+		TESSELLATE_UNIFORM,
+		TESSELLATE_ADAPTIVE
+	};
+
 	BezierCurve(InteractiveShape& markerTemplate, RenderShape& slopeLineTemplate, int maxNumVerts);
 	~BezierCurve();
 
@@ -16,17 +24,39 @@ public:
 	void numVerts(int newNumVerts);
 	int numVerts();
 
+	// Uniform mode samples numVerts evenly spaced parameters, adaptive mode subdivides until every span is within tolerance
+	void mode(TessellationMode newMode);
+	TessellationMode mode();
+
+	// Largest distance allowed between the curve and the line drawn for it, in world units
+	void tolerance(GLfloat newTolerance);
+	GLfloat tolerance();
+
+	// Vertices produced by the last tessellation, in either mode
+	int drawnVerts();
+
 private:
 	void UpdateShapes();
 	void UpdateCurve();
+	void TessellateUniform(GLfloat* data);
+	void TessellateAdaptive(const glm::vec3* controlPoints, int depth);
 private:
 	glm::vec3 _controlPoints[4];
 	InteractiveShape* _controlPointerMarkers[4];
 	RenderShape* _slopeLines[2];
 	RenderShape* _curve;
 	GLuint _vao;
-	GLuint _vbo;
+	StreamBuffer* _stream;
 	GLuint _ebo;
 	int _numVerts;
 	int _maxNumVerts;
+
+	TessellationMode _mode;
+	GLfloat _tolerance;
+
+	// Adaptive output is only known once the recursion finishes, kept between tessellations so it doesn't reallocate
+	std::vector<GLfloat> _data;
+
+	// Deepest subdivision in adaptive mode, caps a span at 2^12 segments
+	static const int MAX_DEPTH = 12;
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "InputManager.h"
+#include "Profiler.h"
 #include <iostream>
 
 double InputManager::_mousePos[2];
@@ -8,6 +9,8 @@ bool InputManager::_upKey = false;
 bool InputManager::_prevUpKey = false;
 bool InputManager::_downKey = false;
 bool InputManager::_prevDownKey = false;
+bool InputManager::_tabKey = false;
+bool InputManager::_prevTabKey = false;
 GLFWwindow* InputManager::_window;
 float InputManager::_aspectRatio = 0.0f;
 int InputManager::_windowSize[2];
@@ -21,12 +24,16 @@ void InputManager::Init(GLFWwindow* window)
 
 void InputManager::Update()
 {
+	PROFILE_ZONE("InputManager::Update");
+
 	_prevLeftMouseButton = _leftMouseButton;
 	_leftMouseButton = glfwGetMouseButton(_window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
 	_prevDownKey = _downKey;
 	_downKey = glfwGetKey(_window, GLFW_KEY_DOWN) == GLFW_PRESS;
 	_prevUpKey = _upKey;
 	_upKey = glfwGetKey(_window, GLFW_KEY_UP) == GLFW_PRESS;
+	_prevTabKey = _tabKey;
+	_tabKey = glfwGetKey(_window, GLFW_KEY_TAB) == GLFW_PRESS;
 	glfwGetCursorPos(_window, &_mousePos[0], &_mousePos[1]);
 }
 
@@ -40,3 +47,4 @@ glm::vec2 InputManager::GetMouseCoords()
 bool InputManager::leftMouseButton(bool prev) { if (prev) return _prevLeftMouseButton; else return _leftMouseButton; }
 bool InputManager::upKey(bool prev) { if (prev) return _prevUpKey; else return _upKey; }
 bool InputManager::downKey(bool prev) { if (prev) return _prevDownKey; else return _downKey; }
+bool InputManager::tabKey(bool prev) { if (prev) return _prevTabKey; else return _tabKey; }
@@ -1,7 +1,7 @@
 #pragma once
-#include <GLEW\GL\glew.h>
-#include <GLFW\glfw3.h>
-#include <GLM\glm.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <GLM/glm.hpp>
 
 class InputManager
 {
@@ -14,6 +14,7 @@ public:
 	static bool leftMouseButton(bool prev = false);
 	static bool downKey(bool prev = false);
 	static bool upKey(bool prev = false);
+	static bool tabKey(bool prev = false);
 
 private:
 
@@ -24,6 +25,8 @@ private:
 	static bool _prevUpKey;
 	static bool _downKey;
 	static bool _prevDownKey;
+	static bool _tabKey;
+	static bool _prevTabKey;
 	static GLFWwindow* _window;
 	static float _aspectRatio;
 	static int _windowSize[2];
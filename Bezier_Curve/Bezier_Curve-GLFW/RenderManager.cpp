@@ -1,9 +1,11 @@
 #include "RenderManager.h"
 #include "RenderShape.h"
+#include "TransformManager.h"
 #include "InteractiveShape.h"
 #include "Init_Shader.h"
 #include "InputManager.h"
-#include <GLM\gtc\random.hpp>
+#include "Profiler.h"
+#include <GLM/gtc/random.hpp>
 
 std::vector<RenderShape*> RenderManager::_shapes = std::vector<RenderShape*>();
 std::vector<InteractiveShape*> RenderManager::_interactiveShapes = std::vector<InteractiveShape*>();
@@ -38,8 +40,12 @@ void RenderManager::AddShape(InteractiveShape* shape)
 
 void RenderManager::Update(float dt)
 {
+	PROFILE_ZONE("RenderManager::Update");
+
+	// Only the transforms with a velocity are integrated, all of them in one pass
+	TransformManager::Integrate(dt);
+
 	_shapeMoved = false;
-	std::vector<InteractiveShape*>& moused = std::vector<InteractiveShape*>();
 	unsigned int numShapes = _shapes.size();
 	for (unsigned int i = 0; i < numShapes; ++i)
 	{
@@ -51,15 +57,15 @@ void RenderManager::Update(float dt)
 		_interactiveShapes[i]->Update(dt);
 		if (_interactiveShapes[i]->moved()) _shapeMoved = true;
 	}
-	unsigned int size = moused.size();
-	for (unsigned int i = 0; i < size; ++i)
-	{
-		moused[i]->currentColor() = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
-	}
 }
 
 void RenderManager::Draw()
 {
+	PROFILE_ZONE("RenderManager::Draw");
+
+	// Every shape only reads its model matrix, whatever moved since the last frame is rebuilt here in parent order
+	TransformManager::Update();
+
 	unsigned int numShapes = _shapes.size();
 	for (unsigned int i = 0; i < numShapes; ++i)
 	{
@@ -1,9 +1,9 @@
 #pragma once
-#include <GLEW\GL\glew.h>
-#include <GLM\gtc\matrix_transform.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
 #include <vector>
 
-struct Transform;
+class Transform;
 struct Collider;
 struct Shader;
 class RenderShape;
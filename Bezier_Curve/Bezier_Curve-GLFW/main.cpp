@@ -46,6 +46,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *	- Holds the instance data for a shape that can be rendered to the screen. This includes a transform, a vao, a shader, the drawing
 *	mode (eg triangles, lines), it's active state, and its color
 *
+*	TransformManager
+*	- Holds the position, rotation and scale of every Transform in arrays ordered parents first, and the velocities of just the
+*	ones that move. Once a frame the moving ones are integrated in one pass, and before anything is drawn it rebuilds the model
+*	matrices of the transforms that changed and of their children, so shapes only read a finished matrix.
+*
 *	InteractiveShape
 *	- Inherits from RenderShape, possessing all the same properties. Additionally, it has a collider and can use it to check collisions against
 *	world boundries, other colliders, and the cursor. 
@@ -55,17 +60,64 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *
 *	Bezier_Curve
 *	- Holds data for the bezier curve and the helper shapes that go along with it. Generates and dynamically adjusts the vertices of the curve
-*	based on the positions of the control points and the mathematical function above.
+*	based on the positions of the control points and the mathematical function above. Tab switches it between evenly spaced samples
+*	and adaptive subdivision, which only splits the curve where it bends further from a straight line than the tolerance allows.
+*	Up and down change the sample count or the tolerance, and the resulting vertex count is printed.
+*
+*	BezierEvaluator
+*	- Contains static functions that evaluate cubic curves and patches several parameters at a time. The SSE2 or AVX2 version is picked
+*	at startup depending on what the cpu supports, with a plain C++ version as the fallback.
+*
+*	BasisCache
+*	- Builds each sampled Bernstein basis table once and hands the same read-only copy to every curve and patch that asks for it.
+*
+*	StreamBuffer
+*	- Vertex buffer for tessellated data that changes while the gpu may still be drawing the old version. Writes go into a fenced ring
+*	of persistently mapped regions when ARB_buffer_storage is available, and through glBufferSubData of the changed bytes otherwise.
+*
+*	RenderBackend
+*	- Everything the shapes and buffers ask of the graphics api goes through it. GLRenderBackend passes the calls on to GL,
+*	NullRenderBackend only counts the buffers and draws it is given. Running the program with -headless [frames] updates and
+*	draws the curve in both tessellation modes without a window or a GL context.
+*
+*	GLRenderBackend
+*	- Remembers the program, vao, buffer bindings, depth test and uniform values it last set and leaves out every call that would
+*	set them to what they already are. Run the program with -check-gl-state to have it read each remembered value back with
+*	glGet* before relying on it, log any that GL disagrees with, and print how many calls were left out on exit.
+*
+*	Profiler
+*	- Times named zones of each frame, like the input, the updates and the draws. Run the program with -profile [trace.json]
+*	to print the p50, p95 and p99 time of each zone every 256 frames and write every zone as a trace for chrome://tracing or
+*	Perfetto on exit. Without it the zones are skipped, and defining NO_PROFILER compiles them out.
+*
+*	CountingRenderBackend
+*	- Sits between the code and another backend and counts the draw calls, vao and program binds, depth test changes, uniforms
+*	and uploads of every frame, and which binds and changes set what was already set. Run the program with -gl-stats [frames]
+*	to log the average per frame every that many frames, 60 by default. Under -headless it counts the calls made to the null
+*	backend.
+*
+*	AllocationTracker
+*	- Counts every heap allocation through a replacement operator new, per frame and per Profiler zone. The update and draw
+*	code keeps its scratch memory between frames so a frame that has warmed up allocates nothing. Running the program with
+*	-verify-allocations [frames] runs the curve in both tessellation modes on the null backend and fails if any frame after the
+*	first few allocates.
+*
+*	Core
+*	- Init_Shader, the render backends, StreamBuffer, BezierEvaluator, BasisCache, Profiler, AllocationTracker, PatchLod,
+*	Transform and TransformManager live in Core at the root of the repository, shared by the examples. The CMakeLists.txt
+*	there builds them as the NurbsCore library, which never links GL, and builds each example on top of it.
 */
 
-#include <GLEW\GL\glew.h>
-#include <GLFW\glfw3.h>
-#include <GLM\gtc\type_ptr.hpp>
-#include <GLM\gtc\matrix_transform.hpp>
-#include <GLM\gtc\quaternion.hpp>
-#include <GLM\gtc\random.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <GLM/gtc/type_ptr.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include <GLM/gtc/random.hpp>
 #include <iostream>
 #include <ctime>
+#include <chrono>
+#include <cstring>
 
 #include "RenderShape.h"
 #include "InteractiveShape.h"
@@ -73,9 +125,30 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "RenderManager.h"
 #include "InputManager.h"
 #include "BezierCurve.h"
+#include "StreamBuffer.h"
+#include "RenderBackend.h"
+#include "GLRenderBackend.h"
+#include "NullRenderBackend.h"
+#include "CountingRenderBackend.h"
+#include "Profiler.h"
+#include "AllocationTracker.h"
 
 GLFWwindow* window;
 
+// Set by -headless, there are no shaders and no window to clean up
+bool headless = false;
+
+// Set by -profile, where the trace goes when the program exits
+const char* tracePath = NULL;
+
+// Set by -gl-stats, the layer counting the GL calls of every frame and how many frames go into each log
+CountingRenderBackend* glStats = NULL;
+int glStatsInterval = 0;
+
+// Set by -check-gl-state, the GL backend reads back what it remembers before relying on it
+bool checkGlState = false;
+GLRenderBackend* glBackend = NULL;
+
 GLuint vertexShader;
 GLuint fragmentShader;
 GLuint shaderProgram;
@@ -109,7 +182,7 @@ BezierCurve* bezierCurve;
 
 void initShaders()
 {
-	char* shaders[] = { "fshader.glsl", "vshader.glsl" };
+	char* shaders[] = { "fShader.glsl", "vShader.glsl" };
 	GLenum types[] = { GL_FRAGMENT_SHADER, GL_VERTEX_SHADER };
 	int numShaders = 2;
 	
@@ -121,36 +194,51 @@ void initShaders()
 
 void initGeometry()
 {
+	RenderBackend& backend = RenderBackend::Get();
+
 	// Store the data for the triangles in a buffer that the gpu can use to draw
-	glGenVertexArrays(1, &vao0);
-	glBindVertexArray(vao0);
+	vbo = backend.CreateBuffer(sizeof(vertices), vertices, GL_STATIC_DRAW);
+	ebo0 = backend.CreateBuffer(sizeof(elements), elements, GL_STATIC_DRAW);
+	ebo1 = backend.CreateBuffer(sizeof(outlineElements), outlineElements, GL_STATIC_DRAW);
 
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	// Bind buffer data to shader values
+	posAttrib = backend.AttribLocation(shaderProgram, "position");
 
-	glGenBuffers(1, &ebo0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo0);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements), elements, GL_STATIC_DRAW);
+	vao0 = backend.CreateVertexArray(ebo0);
+	backend.VertexAttribute(vao0, vbo, posAttrib, 2, 0, 0);
 
-	// Bind buffer data to shader values
-	posAttrib = glGetAttribLocation(shaderProgram, "position");
-	glEnableVertexAttribArray(posAttrib);
-	glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, 0, 0);
+	vao1 = backend.CreateVertexArray(ebo1);
+	backend.VertexAttribute(vao1, vbo, posAttrib, 2, 0, 0);
+}
 
-	glGenVertexArrays(1, &vao1);
-	glBindVertexArray(vao1);
+void initScene()
+{
+	Shader shader;
+	shader.shaderPointer = shaderProgram;
+	shader.uTransform = uTransform;
+	shader.uColor = uColor;
 
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	time_t timer;
+	time(&timer);
+	srand((unsigned int)timer);
 
-	glGenBuffers(1, &ebo1);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo1);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(outlineElements), outlineElements, GL_STATIC_DRAW);
+	Collider collider;
+	collider.height = 0.05f;
+	collider.width = 0.05f;
+	InteractiveShape markerTemplate = InteractiveShape(collider, vao0, 6, GL_TRIANGLES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
+	RenderShape slopeLineTemplate = RenderShape(vao1, 2, GL_LINES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
+	bezierCurve = new BezierCurve(markerTemplate, slopeLineTemplate, 64);
+}
 
-	glEnableVertexAttribArray(posAttrib);
-	glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, 0, 0);
+// Puts backend under the layer counting its calls when -gl-stats asked for them
+void setBackend(RenderBackend* backend)
+{
+	if (glStatsInterval > 0)
+	{
+		glStats = new CountingRenderBackend(backend, glStatsInterval);
+		backend = glStats;
+	}
+	RenderBackend::Set(backend);
 }
 
 void init()
@@ -159,7 +247,7 @@ void init()
 
 	//Create window
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 
 	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 
@@ -171,30 +259,41 @@ void init()
 	glewExperimental = true;
 	glewInit();
 
+	glBackend = new GLRenderBackend(checkGlState);
+	setBackend(glBackend);
+
 	initShaders();
 	initGeometry();
 
 	glfwSetTime(0.0);
 
-	Shader shader;
-	shader.shaderPointer = shaderProgram;
-	shader.uTransform = uTransform;
-	shader.uColor = uColor;
-
-	time_t timer;
-	time(&timer);
-	srand((unsigned int)timer);
-
-	Collider collider;
-	collider.height = 0.05f;
-	collider.width = 0.05f;
-	bezierCurve = new BezierCurve(InteractiveShape(collider, vao0, 6, GL_TRIANGLES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f)), RenderShape(vao1, 2, GL_LINES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f)), 64);
-
+	initScene();
 	InputManager::Init(window);
 }
 
+void ReportVerts()
+{
+	if (bezierCurve->mode() == BezierCurve::TESSELLATE_ADAPTIVE)
+	{
+		std::cout << "Adaptive, tolerance " << bezierCurve->tolerance() << ": " << bezierCurve->drawnVerts()
+			<< " verts (uniform uses " << bezierCurve->numVerts() << ")" << std::endl;
+	}
+	else
+	{
+		std::cout << "Uniform: " << bezierCurve->drawnVerts() << " verts" << std::endl;
+	}
+	std::cout << StreamBuffer::bytesUploaded() << " bytes uploaded" << std::endl;
+}
+
 void step()
 {
+	Profiler::BeginFrame();
+	PROFILE_ZONE("Frame");
+
+	// Once every frame in the ring is new
+	if (tracePath && Profiler::frame() > 1 && (Profiler::frame() - 1) % Profiler::NUM_FRAMES == 0)
+		Profiler::PrintSummary(std::cout);
+
 	// Clear to black
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -205,42 +304,221 @@ void step()
 	float dt = (float)glfwGetTime();
 	glfwSetTime(0.0);
 
-	int verts = bezierCurve->numVerts();
-	if (InputManager::downKey(true) && !InputManager::downKey()) verts /= 2;
-	if (InputManager::upKey(true) && !InputManager::upKey()) verts *= 2;
-	bezierCurve->numVerts(verts);
+	// Tab switches between uniform and adaptive tessellation, up and down refine or coarsen the current mode
+	int drawnVerts = bezierCurve->drawnVerts();
+	if (InputManager::tabKey(true) && !InputManager::tabKey())
+	{
+		bool adaptive = bezierCurve->mode() == BezierCurve::TESSELLATE_ADAPTIVE;
+		bezierCurve->mode(adaptive ? BezierCurve::TESSELLATE_UNIFORM : BezierCurve::TESSELLATE_ADAPTIVE);
+	}
+
+	if (bezierCurve->mode() == BezierCurve::TESSELLATE_ADAPTIVE)
+	{
+		GLfloat tolerance = bezierCurve->tolerance();
+		if (InputManager::downKey(true) && !InputManager::downKey()) tolerance *= 2.0f;
+		if (InputManager::upKey(true) && !InputManager::upKey()) tolerance /= 2.0f;
+		bezierCurve->tolerance(glm::clamp(tolerance, 0.0000625f, 0.064f));
+	}
+	else
+	{
+		int verts = bezierCurve->numVerts();
+		if (InputManager::downKey(true) && !InputManager::downKey()) verts /= 2;
+		if (InputManager::upKey(true) && !InputManager::upKey()) verts *= 2;
+		bezierCurve->numVerts(verts);
+	}
 
 	RenderManager::Update(dt);
 
 	bezierCurve->Update();
 
+	if (bezierCurve->drawnVerts() != drawnVerts) ReportVerts();
+
 	RenderManager::Draw();
+	StreamBuffer::EndFrame();
+	if (glStats) glStats->EndFrame();
+	AllocationTracker::EndFrame();
 
 	// Swap buffers
+	PROFILE_ZONE("SwapBuffers");
 	glfwSwapBuffers(window);
 }
 
 void cleanUp()
 {
-	glDeleteProgram(shaderProgram);
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+	if (!headless)
+	{
+		glDeleteProgram(shaderProgram);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+	}
 
-	glDeleteBuffers(1, &vbo);
-	glDeleteBuffers(1, &ebo0);
-	glDeleteBuffers(1, &ebo1);
-	glDeleteVertexArrays(1, &vao0);
-	glDeleteVertexArrays(1, &vao1);
+	RenderBackend::Get().DeleteBuffer(vbo);
+	RenderBackend::Get().DeleteBuffer(ebo0);
+	RenderBackend::Get().DeleteBuffer(ebo1);
+	RenderBackend::Get().DeleteVertexArray(vao0);
+	RenderBackend::Get().DeleteVertexArray(vao1);
 
 	RenderManager::DumpData();
 
 	delete bezierCurve;
 
-	glfwTerminate();
+	if (glBackend && checkGlState)
+		std::cout << "GL state: " << glBackend->numSkipped() << " calls left out, " << glBackend->numDesyncs() << " desyncs" << std::endl;
+
+	RenderBackend::Release();
+	glStats = NULL;
+	glBackend = NULL;
+
+	if (tracePath)
+	{
+		Profiler::PrintSummary(std::cout);
+		if (Profiler::WriteTrace(tracePath)) std::cout << "Wrote " << tracePath << std::endl;
+	}
+	if (!headless) glfwTerminate();
+}
+
+// Re-tessellates the curve with the current settings, then updates and draws it for a number of frames on the null backend
+void runHeadlessFrames(NullRenderBackend* backend, int frames)
+{
+	backend->ResetCounters();
+
+	typedef std::chrono::high_resolution_clock Clock;
+	Clock::time_point start = Clock::now();
+
+	BezierCurve::TessellationMode mode = bezierCurve->mode();
+	bezierCurve->mode(mode == BezierCurve::TESSELLATE_ADAPTIVE ? BezierCurve::TESSELLATE_UNIFORM : BezierCurve::TESSELLATE_ADAPTIVE);
+	bezierCurve->mode(mode);
+
+	for (int i = 0; i < frames; ++i)
+	{
+		Profiler::BeginFrame();
+		PROFILE_ZONE("Frame");
+
+		RenderManager::Update(1.0f / 60.0f);
+		bezierCurve->Update();
+		RenderManager::Draw();
+		StreamBuffer::EndFrame();
+		if (glStats) glStats->EndFrame();
+		AllocationTracker::EndFrame();
+	}
+
+	double ms = 1000.0 * std::chrono::duration<double>(Clock::now() - start).count();
+	ReportVerts();
+	std::cout << backend->numDraws() / frames << " draws, " << backend->numIndices() / frames << " indices, "
+		<< AllocationTracker::allocationsLastFrame() << " allocations in the last frame, " << ms / frames << " ms per frame" << std::endl;
+}
+
+void runHeadless(int frames)
+{
+	headless = true;
+	NullRenderBackend* backend = new NullRenderBackend();
+	setBackend(backend);
+
+	initGeometry();
+	initScene();
+
+	for (int verts = 64; verts >= 4; verts /= 4)
+	{
+		bezierCurve->numVerts(verts);
+		runHeadlessFrames(backend, frames);
+	}
+
+	bezierCurve->mode(BezierCurve::TESSELLATE_ADAPTIVE);
+	for (GLfloat tolerance = 0.064f; tolerance >= 0.0000625f; tolerance /= 8.0f)
+	{
+		bezierCurve->tolerance(tolerance);
+		runHeadlessFrames(backend, frames);
+	}
+
+	std::cout << backend->numBuffers() << " buffers holding " << backend->bufferBytes() << " bytes, "
+		<< backend->numVertexArrays() << " vertex arrays" << std::endl;
+
+	cleanUp();
+}
+
+// Re-tessellates the curve every frame in both modes on the null backend, and counts the heap allocations made after the
+// first few frames of each. Once the buffers have grown to fit, there should be none.
+bool verifyAllocations(int frames)
+{
+	const int WARM_UP_FRAMES = 8;
+
+	headless = true;
+	setBackend(new NullRenderBackend());
+
+	initGeometry();
+	initScene();
+
+	const char* modeNames[] = { "Uniform", "Adaptive" };
+	long long totalAllocations = 0;
+	for (int m = 0; m < 2; ++m)
+	{
+		BezierCurve::TessellationMode mode = m == 0 ? BezierCurve::TESSELLATE_UNIFORM : BezierCurve::TESSELLATE_ADAPTIVE;
+		BezierCurve::TessellationMode otherMode = m == 0 ? BezierCurve::TESSELLATE_ADAPTIVE : BezierCurve::TESSELLATE_UNIFORM;
+
+		long long allocations = 0;
+		long long bytes = 0;
+		for (int i = 0; i < WARM_UP_FRAMES + frames; ++i)
+		{
+			Profiler::BeginFrame();
+			{
+				PROFILE_ZONE("Frame");
+
+				// Switching modes there and back tessellates the curve again
+				bezierCurve->mode(otherMode);
+				bezierCurve->mode(mode);
+
+				RenderManager::Update(1.0f / 60.0f);
+				bezierCurve->Update();
+				RenderManager::Draw();
+				StreamBuffer::EndFrame();
+				if (glStats) glStats->EndFrame();
+			}
+			AllocationTracker::EndFrame();
+
+			if (i >= WARM_UP_FRAMES)
+			{
+				allocations += AllocationTracker::allocationsLastFrame();
+				bytes += AllocationTracker::bytesLastFrame();
+			}
+		}
+
+		std::cout << modeNames[m] << ": " << allocations << " allocations of " << bytes << " bytes in " << frames << " frames" << std::endl;
+		totalAllocations += allocations;
+	}
+
+	cleanUp();
+	return totalAllocations == 0;
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	// Can follow any of the other options
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-profile") == 0)
+		{
+			tracePath = i + 1 < argc && argv[i + 1][0] != '-' ? argv[i + 1] : "trace.json";
+			Profiler::Enable();
+		}
+		if (strcmp(argv[i], "-gl-stats") == 0)
+			glStatsInterval = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[i + 1]) : 60;
+		if (strcmp(argv[i], "-check-gl-state") == 0)
+			checkGlState = true;
+	}
+
+	// Runs the update and draw code for both tessellation modes without a window, on a backend that only counts what it is given
+	if (argc > 1 && strcmp(argv[1], "-headless") == 0)
+	{
+		runHeadless(argc > 2 && argv[2][0] != '-' ? atoi(argv[2]) : 100);
+		return 0;
+	}
+
+	// Fails when a frame allocates once the curve has warmed up
+	if (argc > 1 && strcmp(argv[1], "-verify-allocations") == 0)
+	{
+		return verifyAllocations(argc > 2 && argv[2][0] != '-' ? atoi(argv[2]) : 100) ? 0 : 1;
+	}
+
 	init();
 
 	while (!glfwWindowShouldClose(window))
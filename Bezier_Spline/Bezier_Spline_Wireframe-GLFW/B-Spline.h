@@ -1,15 +1,27 @@
 #pragma once
 #include "RenderShape.h"
+#include "PatchTopology.h"
+#include "PatchLod.h"
 
 #include <vector>
 
 class Patch;
 class RenderShape;
+class StreamBuffer;
+class GeometryArena;
+class MultiDrawShape;
+class GpuPatchEvaluator;
+class GpuPatchShape;
 
 class B_Spline
 {
 public:
-	B_Spline(RenderShape& markerTemplate, RenderShape& slopeLineTemplate, int numPatches = 1);
+	// gpuShader is the vShaderBezier.glsl program, without one the surface is only ever evaluated on the cpu. Without
+	// helper shapes the patches get no control point markers or slope lines and only the slope line template's shader is
+	// used, for scenes of many patches where only the surface matters. No patch is drawn finer than maxLevel, every patch
+	// takes the memory of that level when it is made so changing level never reallocates.
+	B_Spline(RenderShape& markerTemplate, RenderShape& slopeLineTemplate, int numPatches = 1, Shader gpuShader = Shader(), bool helperShapes = true,
+		int maxLevel = PatchLod::NUM_LEVELS - 1);
 	~B_Spline();
 
 	void Update(float dt);
@@ -19,9 +31,144 @@ public:
 		glm::vec3 controlPointPos8, glm::vec3 controlPointPos9, glm::vec3 controlPointPos10, glm::vec3 controlPointPos11,
 		glm::vec3 controlPointPos12, glm::vec3 controlPointPos13, glm::vec3 controlPointPos14, glm::vec3 controlPointPos15);
 
+	// Patches can come and go at runtime, their vertices are suballocated from the arena without moving the others
+	int AddPatch();
+	void RemovePatch(int patch);
+	int numPatches();
+	Patch& patch(int index);
+
 	Transform& transform(); 
+
+	// What every patch copies for its control point markers and slope lines
+	RenderShape& markerTemplate();
+	RenderShape& slopeLineTemplate();
+	int numPatchesTessellated();
+	int numTriangles();
+	int numDrawRanges();
+	GeometryArena& arena();
+
+	// Shared edges, degenerate edges and welded corners of the patches, rebuilt whenever a control point moves
+	PatchTopology& topology();
+
+	// Welded mode draws the whole model from one vertex and index buffer, storing the vertices on shared edges and
+	// corners once. Every patch is tessellated at the finest level any of them picked, so the shared rows line up. A
+	// patch skips evaluating the first or last row of its grid when every vertex on it is copied from another patch.
+	void welded(bool newWelded);
+	bool welded();
+	int numWeldedVerts();
+	int numUnweldedVerts();
+
+	// Evaluates the surface in the vertex shader from the control points instead of tessellating it on the cpu. Takes
+	// precedence over welding, the cpu path stays as the reference.
+	void gpuEvaluated(bool newGpuEvaluated);
+	bool gpuEvaluated();
+	GpuPatchEvaluator* gpuEvaluator();
+
+	// Pipelined mode evaluates the patches and moves the transforms on a TaskPool job that runs while the frame is drawn,
+	// and uploads and applies the result at the start of the next Update. The surface and transforms drawn are a frame
+	// behind, in exchange the frame only takes as long as the longer of the job and drawing instead of both.
+	void pipelined(bool newPipelined);
+	bool pipelined();
+
+	// Tessellates every patch at every level, and at mixed levels so the stitched edges are covered, on both paths and
+	// returns the largest distance between a cpu vertex and the vertex shader's
+	GLfloat VerifyGpuEvaluation(int& numVertsCompared);
+private:
+	// Evaluates the patches that changed on the TaskPool and uploads them
+	void Tessellate();
+
+	// The steps of Tessellate. Begin finds the patches that changed and returns how many, Evaluate only writes to their
+	// back buffers so it can run as a launched job, Upload needs the context.
+	int BeginTessellation();
+	void EvaluateTessellation();
+	void UploadTessellation();
+
+	// Waits for a pipelined tessellation still being evaluated and uploads it, anything that changes the patches or how
+	// they are drawn calls it first
+	void FinishTessellation();
+	void BuildTopology();
+	void StitchEdgeLevels();
+	void BuildWeldMap(int level);
+	// Tells every patch which of its edge rows are entirely copied from other patches when welded
+	void BorrowWeldedRows();
+	void UpdateWelded(int level, bool retessellated);
+	void ReserveWelded(GLsizei numVerts);
 private:
 	Transform _transform;
 
+	// Copied so patches added later get the same helper shapes
+	RenderShape _markerTemplate;
+	RenderShape _slopeLineTemplate;
+	bool _helperShapes;
+	int _maxLevel;
+
+	// Every patch's surface and wireframe, drawn with one multi-draw per arena page
+	GeometryArena* _arena;
+	MultiDrawShape* _surface;
+	MultiDrawShape* _wireframe;
+
+	bool _gpuEvaluated;
+	GpuPatchEvaluator* _gpuEvaluator;
+	GpuPatchShape* _gpuSurface;
+	GpuPatchShape* _gpuWireframe;
+
+	// Number of patches whose surface was re-tessellated during the last Update
+	int _numPatchesTessellated;
+
+	// Rows evaluated by one task, the finest level is split into 5 blocks
+	static const int ROWS_PER_BLOCK = 16;
+
+	struct RowBlock
+	{
+		Patch* patch;
+		int firstRow;
+		int numRows;
+	};
+
+	// Kept between frames so tessellating doesn't allocate once they are large enough
+	std::vector<Patch*> _tessellating;
+	std::vector<RowBlock> _rowBlocks;
+
+	bool _pipelined;
+	bool _tessellationInFlight;
+
+	// Level every patch was tessellated at for welding when the tessellation in flight was started
+	int _inFlightWeldLevel;
+	// Whether the job in flight also integrates the transforms' motion
+	bool _motionInFlight;
+
 	std::vector<Patch*>* _spline;
+
+	PatchTopology _topology;
+	unsigned int _topologyGeneration;
+	bool _topologyDirty;
+
+	// Every patch's control points back to back, the input to the topology
+	std::vector<glm::vec3> _controlPoints;
+
+	bool _welded;
+
+	// Level the weld map was built for, -1 when it has to be rebuilt
+	int _weldedLevel;
+
+	// Welded vertex of every patch's grid vertex, at patch * numVerts * numVerts + grid index
+	std::vector<GLuint> _weldMap;
+
+	// Patch grid vertex each welded vertex is copied from, so shared vertices come out bit for bit the same
+	std::vector<int> _weldSource;
+
+	// Welded vertex of every corner vertex of the topology, kept so rebuilding the map doesn't allocate
+	std::vector<GLuint> _weldCornerVerts;
+
+	std::vector<GLuint> _weldedElements;
+	std::vector<GLuint> _weldedLineElements;
+
+	RenderShape* _weldedSurface;
+	RenderShape* _weldedLines;
+	GLuint _weldedVaoTris;
+	GLuint _weldedVaoLines;
+	StreamBuffer* _weldedStream;
+	GLsizei _weldedCapacity;
+	GLuint _weldedEboTris;
+	GLuint _weldedEboLines;
 };
\ No newline at end of file
@@ -1,30 +1,105 @@
 #include "B-Spline.h"
 #include "Patch.h"
+#include "RenderManager.h"
+#include "RenderShape.h"
+#include "TransformManager.h"
+#include "GridIndexRegistry.h"
+#include "StreamBuffer.h"
+#include "GeometryArena.h"
+#include "MultiDrawShape.h"
+#include "GpuPatchEvaluator.h"
+#include "GpuPatchShape.h"
+#include "TaskPool.h"
+#include "RenderBackend.h"
+#include "Profiler.h"
 
-B_Spline::B_Spline(RenderShape& markerTemplate, RenderShape& slopeLineTemplate, int numPatches)
+#include <algorithm>
+
+B_Spline::B_Spline(RenderShape& markerTemplate, RenderShape& slopeLineTemplate, int numPatches, Shader gpuShader, bool helperShapes, int maxLevel)
 {
+	_markerTemplate = markerTemplate;
+	_slopeLineTemplate = slopeLineTemplate;
+	_helperShapes = helperShapes;
+	_maxLevel = std::min(std::max(maxLevel, 0), PatchLod::NUM_LEVELS - 1);
+
+	// Every level's indices once, and a first page holding the blocks of all the patches the spline starts with
+	std::vector<int> gridSizes = std::vector<int>();
+	for (int level = 0; level <= _maxLevel; ++level)
+	{
+		gridSizes.push_back(PatchLod::LevelVerts(level));
+	}
+	int maxVerts = PatchLod::LevelVerts(_maxLevel);
+	GLsizei pageVerts = (numPatches > 0 ? numPatches : 1) * StreamBuffer::FootprintVerts(maxVerts * maxVerts);
+	_arena = new GeometryArena(slopeLineTemplate.shader(), sizeof(GLfloat) * 3, pageVerts, gridSizes);
+
 	_spline = new std::vector<Patch*>();
 	_spline->reserve(numPatches);
 
 	for (int i = 0; i < numPatches; ++i)
 	{
-		(*_spline).push_back(new Patch(markerTemplate, slopeLineTemplate));
-		(*_spline)[i]->transform().parent = &_transform;
+		(*_spline).push_back(new Patch(markerTemplate, slopeLineTemplate, _arena, _maxLevel, _helperShapes));
+		(*_spline)[i]->transform().parent(&_transform);
 	}
 
-	_transform = Transform();
-	_transform.position = glm::vec3();
-	_transform.rotation = glm::quat();
-	_transform.scale = glm::vec3(1.0f, 1.0f, 1.0f);
+	_numPatchesTessellated = 0;
+	_pipelined = false;
+	_tessellationInFlight = false;
+	_inFlightWeldLevel = 0;
+	_motionInFlight = false;
+	_topologyGeneration = 0;
+	_topologyDirty = true;
+
+	// Patches keep the spline's transform, so all of them can be drawn with its model matrix
+	_surface = new MultiDrawShape(_arena, GL_TRIANGLES, slopeLineTemplate.shader(), glm::vec4(0.6f, 0.6f, 0.6f, 1.0f));
+	_surface->transform().parent(&_transform);
+	RenderManager::AddShape(_surface);
 
-	_transform.angularVelocity = glm::quat();
-	_transform.linearVelocity = glm::vec3();
+	_wireframe = new MultiDrawShape(_arena, GL_LINES, slopeLineTemplate.shader(), glm::vec4(0.0f, 0.8f, 0.0f, 1.0f), false);
+	_wireframe->transform().parent(&_transform);
+	RenderManager::AddShape(_wireframe);
+
+	// Made the first time the spline is welded, with room for the level it is welded at
+	_weldedStream = NULL;
+	_weldedCapacity = 0;
+	_weldedEboTris = RenderBackend::Get().CreateBuffer(0, NULL, GL_STATIC_DRAW);
+	_weldedEboLines = RenderBackend::Get().CreateBuffer(0, NULL, GL_STATIC_DRAW);
+	_weldedVaoTris = RenderBackend::Get().CreateVertexArray(_weldedEboTris);
+	_weldedVaoLines = RenderBackend::Get().CreateVertexArray(_weldedEboLines);
+
+	_weldedSurface = new RenderShape(_weldedVaoTris, 0, GL_TRIANGLES, slopeLineTemplate.shader(), glm::vec4(0.6f, 0.6f, 0.6f, 1.0f));
+	_weldedSurface->transform().parent(&_transform);
+	_weldedSurface->active() = false;
+	RenderManager::AddShape(_weldedSurface);
+
+	_weldedLines = new RenderShape(_weldedVaoLines, 0, GL_LINES, slopeLineTemplate.shader(), glm::vec4(0.0f, 0.8f, 0.0f, 1.0f), false);
+	_weldedLines->transform().parent(&_transform);
+	_weldedLines->active() = false;
+	RenderManager::AddShape(_weldedLines);
+
+	_welded = false;
+	_weldedLevel = -1;
+
+	_gpuEvaluated = false;
+	_gpuEvaluator = NULL;
+	_gpuSurface = NULL;
+	_gpuWireframe = NULL;
+	if (gpuShader.shaderPointer != 0)
+	{
+		_gpuEvaluator = new GpuPatchEvaluator(gpuShader);
 
-	_transform.rotationOrigin = glm::vec3();
-	_transform.scaleOrigin = glm::vec3();
+		_gpuSurface = new GpuPatchShape(_gpuEvaluator, GridIndexRegistry::TRIANGLES, gpuShader, glm::vec4(0.6f, 0.6f, 0.6f, 1.0f));
+		_gpuSurface->transform().parent(&_transform);
+		RenderManager::AddShape(_gpuSurface);
+
+		_gpuWireframe = new GpuPatchShape(_gpuEvaluator, GridIndexRegistry::LINES, gpuShader, glm::vec4(0.0f, 0.8f, 0.0f, 1.0f), false);
+		_gpuWireframe->transform().parent(&_transform);
+		RenderManager::AddShape(_gpuWireframe);
+	}
 }
 B_Spline::~B_Spline()
 {
+	FinishTessellation();
+
 	while (!_spline->empty())
 	{
 		Patch* toDelete = _spline->back();
@@ -32,32 +107,452 @@ B_Spline::~B_Spline()
 		delete toDelete;
 	}
 	delete _spline;
+
+	// Only once every patch has handed its block back
+	delete _arena;
+	delete _gpuEvaluator;
+
+	delete _weldedStream;
+	RenderBackend::Get().DeleteBuffer(_weldedEboTris);
+	RenderBackend::Get().DeleteBuffer(_weldedEboLines);
+	RenderBackend::Get().DeleteVertexArray(_weldedVaoTris);
+	RenderBackend::Get().DeleteVertexArray(_weldedVaoLines);
 }
 
-void B_Spline::Update(float dt)
+int B_Spline::AddPatch()
+{
+	FinishTessellation();
+
+	Patch* patch = new Patch(_markerTemplate, _slopeLineTemplate, _arena, _maxLevel, _helperShapes);
+	patch->transform().parent(&_transform);
+	patch->welded(_welded);
+	_spline->push_back(patch);
+
+	_topologyDirty = true;
+	_weldedLevel = -1;
+	return _spline->size() - 1;
+}
+
+void B_Spline::RemovePatch(int patch)
 {
-	_transform.position += _transform.linearVelocity * dt;
-	_transform.rotation = glm::slerp(_transform.rotation, _transform.rotation * _transform.angularVelocity, dt);
+	FinishTessellation();
 
-	glm::mat4 translateMat = glm::translate(glm::mat4(), _transform.position);
+	delete (*_spline)[patch];
+	_spline->erase(_spline->begin() + patch);
 
-	glm::mat4 rotateOriginMat = glm::translate(glm::mat4(), _transform.rotationOrigin);
-	glm::mat4 rotateMat = rotateOriginMat * glm::mat4_cast(_transform.rotation) * glm::inverse(rotateOriginMat);
+	_topologyDirty = true;
+	_weldedLevel = -1;
+}
 
-	glm::mat4 scaleOriginMat = glm::translate(glm::mat4(), _transform.scaleOrigin);
-	glm::mat4 scaleMat = scaleOriginMat * glm::scale(glm::mat4(), _transform.scale) * glm::inverse(scaleOriginMat);
+int B_Spline::numPatches() { return _spline->size(); }
+Patch& B_Spline::patch(int index) { return *(*_spline)[index]; }
 
-	glm::mat4 *parentModelMat = _transform.parent ? &_transform.parent->modelMat : &glm::mat4();
+void B_Spline::Update(float dt)
+{
+	PROFILE_ZONE("B_Spline::Update");
 
-	_transform.modelMat = (*parentModelMat) * (translateMat * scaleMat* rotateMat);
+	// What was evaluated while the last frame was drawn is drawn this frame
+	FinishTessellation();
 
 	unsigned int size = _spline->size();
+	unsigned int generation = 0;
 	for (unsigned int i = 0; i < size; ++i)
 	{
 		(*_spline)[i]->Update(dt);
+		generation += (*_spline)[i]->generation();
+	}
+
+	// Levels are picked from where the patches are this frame
+	TransformManager::Update();
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		(*_spline)[i]->SelectLevel();
+	}
+
+	// Generations only ever go up, so the sum changes whenever any control point moved
+	if (generation != _topologyGeneration || _topologyDirty)
+	{
+		BuildTopology();
+		BorrowWeldedRows();
+		_topologyGeneration = generation;
+		_topologyDirty = false;
+		_weldedLevel = -1;
+	}
+
+	_surface->Clear();
+	_wireframe->Clear();
+	if (size == 0)
+	{
+		_weldedSurface->active() = false;
+		_weldedLines->active() = false;
+		return;
+	}
+
+	int weldLevel = 0;
+	if (_welded && !_gpuEvaluated)
+	{
+		// One level for the whole model, so every shared edge is sampled the same on both sides
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			weldLevel = std::max(weldLevel, (*_spline)[i]->level());
+		}
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			(*_spline)[i]->level(weldLevel);
+		}
+	}
+	else
+	{
+		StitchEdgeLevels();
+	}
+
+	if (_gpuEvaluated)
+	{
+		// Nothing is tessellated, the vertex shader only needs the control points and levels
+		_numPatchesTessellated = 0;
+		_gpuEvaluator->Update(*_spline);
+
+		// Toggled together for every patch, so the first one speaks for all of them
+		_gpuSurface->active() = (*_spline)[0]->baseActive();
+		_gpuWireframe->active() = (*_spline)[0]->wireframeActive();
+		return;
+	}
+
+	if (_pipelined)
+	{
+		if (BeginTessellation() > 0)
+		{
+			// The transforms move on the job too, from a snapshot of their velocities
+			_inFlightWeldLevel = weldLevel;
+			_tessellationInFlight = true;
+			_motionInFlight = RenderManager::SnapshotMotion();
+			TaskPool::Launch([this]()
+			{
+				if (_motionInFlight) RenderManager::IntegrateMotion();
+				EvaluateTessellation();
+			});
+
+			// Patches with nothing in their blocks yet would vanish for a frame, so those wait for it
+			bool mustFinish = _welded && _weldedLevel < 0;
+			for (unsigned int i = 0; i < _tessellating.size() && !mustFinish; ++i)
+			{
+				mustFinish = !_welded && !_tessellating[i]->uploaded();
+			}
+			if (mustFinish) FinishTessellation();
+		}
+		else if (_welded) UpdateWelded(weldLevel, false);
+	}
+	else
+	{
+		Tessellate();
+		if (_welded) UpdateWelded(weldLevel, _numPatchesTessellated > 0);
+	}
+
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		(*_spline)[i]->QueueDraws(*_surface, *_wireframe);
+	}
+}
+
+void B_Spline::Tessellate()
+{
+	BeginTessellation();
+	EvaluateTessellation();
+	UploadTessellation();
+}
+
+int B_Spline::BeginTessellation()
+{
+	// Finding the patches that changed is cheap, evaluating them is split into blocks of rows so a few fine patches
+	// still spread over every thread
+	_tessellating.clear();
+	_rowBlocks.clear();
+	unsigned int size = _spline->size();
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		Patch* patch = (*_spline)[i];
+		if (!patch->BeginTessellate()) continue;
+
+		_tessellating.push_back(patch);
+		int numRows = patch->numRows();
+		for (int row = 0; row < numRows; row += ROWS_PER_BLOCK)
+		{
+			RowBlock block = { patch, row, numRows - row < ROWS_PER_BLOCK ? numRows - row : ROWS_PER_BLOCK };
+			_rowBlocks.push_back(block);
+		}
+	}
+	_numPatchesTessellated = _tessellating.size();
+	return _numPatchesTessellated;
+}
+
+void B_Spline::EvaluateTessellation()
+{
+	TaskPool::ParallelFor(_rowBlocks.size(), 1, [this](int begin, int end)
+	{
+		PROFILE_ZONE("Patch::EvaluateRows");
+		for (int b = begin; b < end; ++b)
+		{
+			_rowBlocks[b].patch->EvaluateRows(_rowBlocks[b].firstRow, _rowBlocks[b].numRows);
+		}
+	});
+
+	// Stitching reads the rows next to the edges, so it waits until every block is done
+	TaskPool::ParallelFor(_tessellating.size(), 1, [this](int begin, int end)
+	{
+		PROFILE_ZONE("Patch::EndTessellate");
+		for (int i = begin; i < end; ++i)
+		{
+			_tessellating[i]->EndTessellate();
+		}
+	});
+}
+
+void B_Spline::UploadTessellation()
+{
+	PROFILE_ZONE("B_Spline::UploadTessellation");
+
+	// GL calls stay on the thread that owns the context
+	for (unsigned int i = 0; i < _tessellating.size(); ++i)
+	{
+		_tessellating[i]->Upload();
+	}
+}
+
+void B_Spline::FinishTessellation()
+{
+	if (!_tessellationInFlight)
+		return;
+
+	{
+		PROFILE_ZONE("B_Spline::WaitTessellation");
+		TaskPool::Wait();
+	}
+	_tessellationInFlight = false;
+	if (_motionInFlight) RenderManager::ApplyMotion();
+	_motionInFlight = false;
+
+	UploadTessellation();
+	if (_welded) UpdateWelded(_inFlightWeldLevel, true);
+}
+
+void B_Spline::StitchEdgeLevels()
+{
+	// Shared edges are sampled at the coarser of the two levels so neighbours never leave cracks between them
+	unsigned int size = _spline->size();
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		for (int edge = 0; edge < Patch::NUM_EDGES; ++edge)
+		{
+			int neighbour = _topology.neighbour(i, edge);
+			if (neighbour >= 0) (*_spline)[i]->edgeLevel(edge, (*_spline)[neighbour / Patch::NUM_EDGES]->level());
+		}
+	}
+}
+
+void B_Spline::UpdateWelded(int level, bool retessellated)
+{
+	PROFILE_ZONE("B_Spline::UpdateWelded");
+
+	if (level != _weldedLevel)
+	{
+		BuildWeldMap(level);
+		_weldedLevel = level;
+		retessellated = true;
+	}
+
+	// Toggled together for every patch, so the first one speaks for all of them
+	Patch* first = (*_spline)[0];
+	_weldedSurface->active() = first->baseActive();
+	_weldedLines->active() = first->wireframeActive();
+
+	if (!retessellated)
+		return;
+
+	int numVerts = PatchLod::LevelVerts(level);
+	int gridSize = numVerts * numVerts;
+	unsigned int numWelded = _weldSource.size();
+	GLfloat* weldedVerts = (GLfloat*)_weldedStream->Map();
+	for (unsigned int w = 0; w < numWelded; ++w)
+	{
+		const GLfloat* vert = (*_spline)[_weldSource[w] / gridSize]->verts() + (_weldSource[w] % gridSize) * 3;
+		weldedVerts[w * 3] = vert[0];
+		weldedVerts[w * 3 + 1] = vert[1];
+		weldedVerts[w * 3 + 2] = vert[2];
+	}
+	_weldedStream->Unmap(0, sizeof(GLfloat) * numWelded * 3);
+
+	_weldedSurface->baseVertex(_weldedStream->baseVertex());
+	_weldedLines->baseVertex(_weldedStream->baseVertex());
+}
+
+void B_Spline::BuildWeldMap(int level)
+{
+	const GLuint UNASSIGNED = 0xffffffff;
+
+	unsigned int size = _spline->size();
+	int numVerts = PatchLod::LevelVerts(level);
+	int gridSize = numVerts * numVerts;
+
+	_weldMap.assign(size * gridSize, UNASSIGNED);
+	_weldSource.clear();
+
+	// Corners the topology welded share one vertex, whichever patch reaches them first owns it
+	_weldCornerVerts.assign(_topology.numCornerVertices(), UNASSIGNED);
+	for (unsigned int p = 0; p < size; ++p)
+	{
+		for (int corner = 0; corner < 4; ++corner)
+		{
+			int grid = Patch::EdgeVertex(corner < 2 ? 0 : 1, corner % 2 == 0 ? 0 : numVerts - 1, numVerts);
+			GLuint& weld = _weldCornerVerts[_topology.cornerVertex(p, corner)];
+			if (weld == UNASSIGNED)
+			{
+				weld = _weldSource.size();
+				_weldSource.push_back(p * gridSize + grid);
+			}
+			_weldMap[p * gridSize + grid] = weld;
+		}
+	}
+
+	for (unsigned int p = 0; p < size; ++p)
+	{
+		for (int edge = 0; edge < Patch::NUM_EDGES; ++edge)
+		{
+			// A collapsed edge is a single point, the corner at its start
+			if (_topology.degenerate(p, edge))
+			{
+				GLuint apex = _weldMap[p * gridSize + Patch::EdgeVertex(edge, 0, numVerts)];
+				for (int k = 1; k < numVerts - 1; ++k)
+				{
+					_weldMap[p * gridSize + Patch::EdgeVertex(edge, k, numVerts)] = apex;
+				}
+				continue;
+			}
+
+			// Interior vertices of a shared edge belong to the side with the lower edge index
+			int neighbour = _topology.neighbour(p, edge);
+			int self = p * Patch::NUM_EDGES + edge;
+			if (neighbour < 0 || neighbour < self) continue;
+
+			int otherPatch = neighbour / Patch::NUM_EDGES;
+			int otherEdge = neighbour % Patch::NUM_EDGES;
+			bool reversed = _topology.reversed(p, edge);
+			for (int k = 1; k < numVerts - 1; ++k)
+			{
+				int grid = Patch::EdgeVertex(edge, k, numVerts);
+				GLuint weld = _weldSource.size();
+				_weldSource.push_back(p * gridSize + grid);
+				_weldMap[p * gridSize + grid] = weld;
+				_weldMap[otherPatch * gridSize + Patch::EdgeVertex(otherEdge, reversed ? numVerts - 1 - k : k, numVerts)] = weld;
+			}
+		}
+	}
+
+	// Everything left is only used by its own patch
+	unsigned int numMapped = _weldMap.size();
+	for (unsigned int v = 0; v < numMapped; ++v)
+	{
+		if (_weldMap[v] == UNASSIGNED)
+		{
+			_weldMap[v] = _weldSource.size();
+			_weldSource.push_back(v);
+		}
+	}
+
+	ReserveWelded(_weldSource.size());
+
+	// Same grid topology every patch draws with, pointed at the welded vertices
+	const std::vector<GLuint>& elements = GridIndexRegistry::Elements(numVerts, GridIndexRegistry::TRIANGLES);
+	const std::vector<GLuint>& lineElements = GridIndexRegistry::Elements(numVerts, GridIndexRegistry::LINES);
+	_weldedElements.resize(size * elements.size());
+	_weldedLineElements.resize(size * lineElements.size());
+	for (unsigned int p = 0; p < size; ++p)
+	{
+		const GLuint* map = &_weldMap[p * gridSize];
+		GLuint* patchElements = &_weldedElements[p * elements.size()];
+		for (unsigned int e = 0; e < elements.size(); ++e)
+		{
+			patchElements[e] = map[elements[e]];
+		}
+		GLuint* patchLineElements = &_weldedLineElements[p * lineElements.size()];
+		for (unsigned int e = 0; e < lineElements.size(); ++e)
+		{
+			patchLineElements[e] = map[lineElements[e]];
+		}
+	}
+
+	RenderBackend::Get().BufferData(_weldedEboTris, sizeof(GLuint) * _weldedElements.size(), (void*)&_weldedElements[0], GL_STATIC_DRAW);
+	RenderBackend::Get().BufferData(_weldedEboLines, sizeof(GLuint) * _weldedLineElements.size(), (void*)&_weldedLineElements[0], GL_STATIC_DRAW);
+
+	_weldedSurface->count(_weldedElements.size());
+	_weldedLines->count(_weldedLineElements.size());
+}
+
+void B_Spline::BorrowWeldedRows()
+{
+	const GLuint UNASSIGNED = 0xffffffff;
+
+	// Owners are the same at every level, the first patch to reach a welded corner and the side of a shared edge with
+	// the lower edge index, as BuildWeldMap hands them out. Holds the owning patch until BuildWeldMap reuses it.
+	unsigned int size = _spline->size();
+	_weldCornerVerts.assign(_topology.numCornerVertices(), UNASSIGNED);
+	for (unsigned int p = 0; p < size; ++p)
+	{
+		for (int corner = 0; corner < 4; ++corner)
+		{
+			GLuint& owner = _weldCornerVerts[_topology.cornerVertex(p, corner)];
+			if (owner == UNASSIGNED) owner = p;
+		}
+	}
+
+	// The u = 0 and u = 1 edges are the first and last rows of the grid, corners 0 and 2 lie on the first and 1 and 3 on
+	// the last
+	for (unsigned int p = 0; p < size; ++p)
+	{
+		bool borrowed[2];
+		for (int row = 0; row < 2; ++row)
+		{
+			int edge = 2 + row;
+			int neighbour = _topology.neighbour(p, edge);
+			borrowed[row] = _topology.degenerate(p, edge) || (neighbour >= 0 && neighbour < (int)p * Patch::NUM_EDGES + edge);
+			borrowed[row] = borrowed[row] && _weldCornerVerts[_topology.cornerVertex(p, row)] != p &&
+				_weldCornerVerts[_topology.cornerVertex(p, row + 2)] != p;
+		}
+		(*_spline)[p]->borrowedRows(borrowed[0], borrowed[1]);
 	}
 }
 
+void B_Spline::ReserveWelded(GLsizei numVerts)
+{
+	if (numVerts <= _weldedCapacity)
+		return;
+
+	// Patches were added or the level went up since the stream was made, replace it with one twice the size
+	delete _weldedStream;
+	_weldedCapacity = numVerts > _weldedCapacity * 2 ? numVerts : _weldedCapacity * 2;
+	_weldedStream = new StreamBuffer(sizeof(GLfloat) * 3, _weldedCapacity);
+
+	// Bind buffer data to shader values
+	RenderBackend& backend = RenderBackend::Get();
+	GLint posAttrib = backend.AttribLocation(_slopeLineTemplate.shader().shaderPointer, "position");
+	backend.VertexAttribute(_weldedVaoTris, _weldedStream->vbo(), posAttrib, 3, 0, 0);
+	backend.VertexAttribute(_weldedVaoLines, _weldedStream->vbo(), posAttrib, 3, 0, 0);
+}
+
+void B_Spline::BuildTopology()
+{
+	unsigned int size = _spline->size();
+	_controlPoints.resize(size * 16);
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		const glm::vec3* controlPoints = (*_spline)[i]->controlPoints();
+		for (int k = 0; k < 16; ++k)
+		{
+			_controlPoints[i * 16 + k] = controlPoints[k];
+		}
+	}
+	_topology.Build(_controlPoints);
+}
+
 void B_Spline::SetControlPoints(int patch,
 	glm::vec3 controlPointPos0, glm::vec3 controlPointPos1, glm::vec3 controlPointPos2, glm::vec3 controlPointPos3,
 	glm::vec3 controlPointPos4, glm::vec3 controlPointPos5, glm::vec3 controlPointPos6, glm::vec3 controlPointPos7,
@@ -85,4 +580,115 @@ void B_Spline::SetControlPoints(int patch,
 	(*_spline)[patch]->SetControlPoint(15, controlPointPos15);
 }
 
-Transform& B_Spline::transform() { return _transform; }
\ No newline at end of file
+Transform& B_Spline::transform() { return _transform; }
+RenderShape& B_Spline::markerTemplate() { return _markerTemplate; }
+RenderShape& B_Spline::slopeLineTemplate() { return _slopeLineTemplate; }
+int B_Spline::numPatchesTessellated() { return _numPatchesTessellated; }
+PatchTopology& B_Spline::topology() { return _topology; }
+
+void B_Spline::welded(bool newWelded)
+{
+	if (newWelded == _welded)
+		return;
+
+	FinishTessellation();
+	_welded = newWelded;
+	_weldedLevel = -1;
+	_weldedSurface->active() = false;
+	_weldedLines->active() = false;
+
+	unsigned int size = _spline->size();
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		(*_spline)[i]->welded(newWelded);
+	}
+}
+bool B_Spline::welded() { return _welded; }
+void B_Spline::gpuEvaluated(bool newGpuEvaluated)
+{
+	if (!_gpuEvaluator || newGpuEvaluated == _gpuEvaluated)
+		return;
+
+	FinishTessellation();
+	_gpuEvaluated = newGpuEvaluated;
+	_gpuSurface->active() = false;
+	_gpuWireframe->active() = false;
+
+	// Welding picks up again from scratch when the cpu path comes back
+	_weldedLevel = -1;
+	_weldedSurface->active() = false;
+	_weldedLines->active() = false;
+}
+bool B_Spline::gpuEvaluated() { return _gpuEvaluated; }
+GpuPatchEvaluator* B_Spline::gpuEvaluator() { return _gpuEvaluator; }
+void B_Spline::pipelined(bool newPipelined)
+{
+	if (!newPipelined) FinishTessellation();
+	_pipelined = newPipelined;
+}
+bool B_Spline::pipelined() { return _pipelined; }
+
+GLfloat B_Spline::VerifyGpuEvaluation(int& numVertsCompared)
+{
+	numVertsCompared = 0;
+	if (!_gpuEvaluator)
+		return 0.0f;
+	FinishTessellation();
+
+	// Patches only keep their own grid on the cpu while they are not welded
+	bool wasWelded = _welded;
+	welded(false);
+	BuildTopology();
+
+	GLfloat maxError = 0.0f;
+	std::vector<GLfloat> positions = std::vector<GLfloat>();
+	unsigned int size = _spline->size();
+	for (int pass = 0; pass <= PatchLod::NUM_LEVELS; ++pass)
+	{
+		// Every level on its own first, then neighbours at different levels
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			(*_spline)[i]->level(pass < PatchLod::NUM_LEVELS ? pass : i % PatchLod::NUM_LEVELS);
+		}
+		StitchEdgeLevels();
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			(*_spline)[i]->Tessellate();
+		}
+		_gpuEvaluator->Update(*_spline);
+
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			int level = (*_spline)[i]->level();
+			int numVerts = PatchLod::LevelVerts(level);
+			_gpuEvaluator->Capture(i, level, positions);
+
+			const GLfloat* verts = (*_spline)[i]->verts();
+			for (int v = 0; v < numVerts * numVerts; ++v)
+			{
+				glm::vec3 cpu = glm::vec3(verts[v * 3], verts[v * 3 + 1], verts[v * 3 + 2]);
+				glm::vec3 gpu = glm::vec3(positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2]);
+				maxError = std::max(maxError, glm::length(cpu - gpu));
+			}
+			numVertsCompared += numVerts * numVerts;
+		}
+	}
+
+	welded(wasWelded);
+	return maxError;
+}
+
+int B_Spline::numWeldedVerts() { return _weldSource.size(); }
+int B_Spline::numUnweldedVerts() { return _weldMap.size(); }
+int B_Spline::numTriangles()
+{
+	int numTriangles = 0;
+	unsigned int size = _spline->size();
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		numTriangles += (*_spline)[i]->numTriangles();
+	}
+	return numTriangles;
+}
+int B_Spline::numDrawRanges() { return _surface->numDraws() + _wireframe->numDraws(); }
+GeometryArena& B_Spline::arena() { return *_arena; }
\ No newline at end of file
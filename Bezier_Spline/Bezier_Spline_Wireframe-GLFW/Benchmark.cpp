@@ -0,0 +1,628 @@
+#include "Benchmark.h"
+#include "BezierEvaluator.h"
+#include "BasisCache.h"
+#include "PatchTopology.h"
+#include "TaskPool.h"
+#include "B-Spline.h"
+#include "Patch.h"
+#include "PatchLod.h"
+#include "RenderManager.h"
+#include "Transform.h"
+#include "TransformManager.h"
+#include "CameraManager.h"
+#include "StreamBuffer.h"
+#include "AllocationTracker.h"
+#include "Teapot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	// Minimum time spent on each measurement
+	const double MIN_SECONDS = 0.25;
+
+	// The per vertex loop BezierCurve::UpdateCurve used before the batch evaluator
+	void ScalarCurve(const glm::vec3* controlPoints, int numVerts, GLfloat* data)
+	{
+		for (int i = 0; i < numVerts; ++i)
+		{
+			float t = (float)i / ((float)numVerts - 1.0f);
+
+			float factor0 = (1 - t) * (1 - t) * (1 - t);
+			float factor1 = 3 * t * ((1 - t) * (1 - t));
+			float factor2 = 3 * (t * t) * (1 - t);
+			float factor3 = t * t * t;
+
+			data[i * 3] = factor0 * controlPoints[0].x + factor1 * controlPoints[1].x + factor2 * controlPoints[2].x + factor3 * controlPoints[3].x;
+			data[i * 3 + 1] = factor0 * controlPoints[0].y + factor1 * controlPoints[1].y + factor2 * controlPoints[2].y + factor3 * controlPoints[3].y;
+			data[i * 3 + 2] = factor0 * controlPoints[0].z + factor1 * controlPoints[1].z + factor2 * controlPoints[2].z + factor3 * controlPoints[3].z;
+		}
+	}
+
+	// The AoS loop Patch::UpdateSurface used before the batch evaluator
+	void ScalarPatch(const glm::vec3* controlPoints, int numVerts, GLfloat* verts)
+	{
+		std::vector<glm::vec4> factors(numVerts);
+		for (int i = 0; i < numVerts; ++i)
+		{
+			GLfloat t = (GLfloat)i / ((GLfloat)numVerts - 1.0f);
+			GLfloat t_inv = 1 - t;
+			factors[i] = glm::vec4(t_inv * t_inv * t_inv, 3 * t * t_inv * t_inv, 3 * t * t * t_inv, t * t * t);
+		}
+
+		glm::vec3 newControlPoints[4];
+		for (int i = 0; i < numVerts; ++i)
+		{
+			for (int row = 0; row < 4; ++row)
+			{
+				const glm::vec3* cp = controlPoints + row * 4;
+				newControlPoints[row] = factors[i][0] * cp[0] + factors[i][1] * cp[1] + factors[i][2] * cp[2] + factors[i][3] * cp[3];
+			}
+			for (int j = 0; j < numVerts; ++j)
+			{
+				glm::vec3 newPoint = factors[j][0] * newControlPoints[0] + factors[j][1] * newControlPoints[1] + factors[j][2] * newControlPoints[2] + factors[j][3] * newControlPoints[3];
+				verts[(j + (i * numVerts)) * 3] = newPoint.x;
+				verts[(j + (i * numVerts)) * 3 + 1] = newPoint.y;
+				verts[(j + (i * numVerts)) * 3 + 2] = newPoint.z;
+			}
+		}
+	}
+
+	// Repeats fn until MIN_SECONDS have passed and returns the number of points produced per second
+	template <typename Fn>
+	double PointsPerSecond(Fn fn, int pointsPerCall)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+		long long calls = 0;
+		Clock::time_point start = Clock::now();
+		double elapsed = 0.0;
+		do
+		{
+			for (int i = 0; i < 16; ++i) fn();
+			calls += 16;
+			elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+		} while (elapsed < MIN_SECONDS);
+		return (double)calls * pointsPerCall / elapsed;
+	}
+
+	void PrintRow(const char* label, int numVerts, double pointsPerSecond, double baseline)
+	{
+		std::cout << std::setw(10) << label << std::setw(10) << numVerts
+			<< std::setw(16) << std::fixed << std::setprecision(1) << pointsPerSecond / 1.0e6 << " Mpts/s"
+			<< std::setw(10) << std::setprecision(2) << pointsPerSecond / baseline << "x" << std::endl;
+	}
+
+	void ControlPoints(glm::vec3* controlPoints, int count)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			controlPoints[i] = glm::vec3((float)(i % 4) / 3.0f, (float)((i * 7) % 5) * 0.25f, (float)(i / 4) / 3.0f);
+		}
+	}
+
+	// A sheet of side x side patches, every interior edge is shared by two of them
+	void Sheet(int side, std::vector<glm::vec3>& controlPoints)
+	{
+		controlPoints.resize(side * side * 16);
+		for (int a = 0; a < side; ++a)
+		{
+			for (int b = 0; b < side; ++b)
+			{
+				glm::vec3* patch = &controlPoints[(a * side + b) * 16];
+				for (int k = 0; k < 16; ++k)
+				{
+					glm::vec2 grid = glm::vec2((GLfloat)(a * 3 + k % 4), (GLfloat)(b * 3 + k / 4)) * 0.01f;
+					patch[k] = glm::vec3(grid.x, glm::sin(grid.x) * glm::cos(grid.y), grid.y);
+				}
+			}
+		}
+	}
+
+	// FNV-1a over the bytes, to tell whether two runs produced exactly the same vertices
+	unsigned long long Hash(const std::vector<GLfloat>& data)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		const unsigned char* bytes = (const unsigned char*)&data[0];
+		size_t numBytes = data.size() * sizeof(GLfloat);
+		for (size_t i = 0; i < numBytes; ++i)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	// Largest the process has been in physical memory
+	long long PeakResidentBytes()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize;
+#else
+		// Kilobytes on Linux
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return (long long)usage.ru_maxrss * 1024;
+#endif
+	}
+
+	struct Measurement
+	{
+		long long iterations;
+		double seconds;
+		long long allocations;
+	};
+
+	// Calls fn once to warm up, then until MIN_SECONDS have passed, counting the heap allocations made while it runs
+	template <typename Fn>
+	Measurement Measure(Fn fn)
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+		fn();
+
+		Measurement result = Measurement();
+		long long batch = 1;
+		long long allocations = AllocationTracker::numAllocations();
+		Clock::time_point start = Clock::now();
+		do
+		{
+			for (long long i = 0; i < batch; ++i) fn();
+			result.iterations += batch;
+			result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+			// Short calls are timed in growing batches so reading the clock doesn't dominate them
+			if (result.seconds < MIN_SECONDS / 16.0) batch *= 2;
+		} while (result.seconds < MIN_SECONDS);
+		result.allocations = AllocationTracker::numAllocations() - allocations;
+		return result;
+	}
+
+	// One entry of the results array, size is the vertices per side of a curve or grid, or the number of patches
+	void WriteResult(std::ostream& out, bool& first, const char* name, int size, long long pointsPerIteration, const Measurement& measurement)
+	{
+		double ns = measurement.seconds * 1.0e9 / measurement.iterations;
+		out << (first ? "\n" : ",\n") << "\t\t{ \"name\": \"" << name << "\", \"size\": " << size
+			<< ", \"iterations\": " << measurement.iterations
+			<< ", \"nsPerIteration\": " << ns
+			<< ", \"pointsPerIteration\": " << pointsPerIteration
+			<< ", \"nsPerPoint\": " << ns / pointsPerIteration
+			<< ", \"pointsPerSecond\": " << pointsPerIteration * 1.0e9 / ns
+			<< ", \"allocationsPerIteration\": " << (double)measurement.allocations / measurement.iterations
+			<< ", \"peakResidentBytes\": " << PeakResidentBytes() << " }";
+		first = false;
+	}
+
+	// What BezierCurve::TessellateUniform does, basis lookup included
+	void SuiteCurves(std::ostream& out, bool& first)
+	{
+		glm::vec3 controlPoints[4];
+		ControlPoints(controlPoints, 4);
+
+		for (int numVerts = 4; numVerts <= 65536; numVerts *= 4)
+		{
+			std::vector<GLfloat> data(numVerts * 3);
+			Measurement measurement = Measure([&]()
+			{
+				const GLfloat* basis = BasisCache::Bernstein(3, numVerts);
+				BezierEvaluator::EvaluateCurve(controlPoints, basis, BezierEvaluator::Stride(numVerts), numVerts, &data[0]);
+			});
+			WriteResult(out, first, "curve", numVerts, numVerts, measurement);
+		}
+	}
+
+	// One patch at the grid size of every level of detail
+	void SuitePatches(std::ostream& out, bool& first)
+	{
+		glm::vec3 controlPoints[16];
+		ControlPoints(controlPoints, 16);
+
+		for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+		{
+			int numVerts = PatchLod::LevelVerts(level);
+			std::vector<GLfloat> verts(numVerts * numVerts * 3);
+			Measurement measurement = Measure([&]()
+			{
+				const GLfloat* basis = BasisCache::Bernstein(3, numVerts);
+				BezierEvaluator::EvaluatePatch(controlPoints, basis, BezierEvaluator::Stride(numVerts), numVerts, &verts[0]);
+			});
+			WriteResult(out, first, "patch", numVerts, numVerts * numVerts, measurement);
+		}
+	}
+
+	// Vertices of the surface at the levels the patches picked
+	long long SurfaceVerts(B_Spline* spline)
+	{
+		long long numVerts = 0;
+		for (int i = 0; i < spline->numPatches(); ++i)
+		{
+			int levelVerts = PatchLod::LevelVerts(spline->patch(i).level());
+			numVerts += levelVerts * levelVerts;
+		}
+		return numVerts;
+	}
+
+	// A B_Spline of bare surfaces drawn with surfaceTemplate's shader, the markers and slope lines would cost more to
+	// draw than the patches cost to evaluate
+	B_Spline* BareSpline(int numPatches, int maxLevel = PatchLod::NUM_LEVELS - 1)
+	{
+		RenderShape surfaceTemplate = RenderShape();
+		return new B_Spline(surfaceTemplate, surfaceTemplate, numPatches, Shader(), false, maxLevel);
+	}
+
+	// Whole frames of the teapot, once with nothing changing and once with every control point moving every frame
+	void SuiteTeapot(std::ostream& out, bool& first)
+	{
+		B_Spline* teapot = BareSpline(Teapot::NUM_PATCHES);
+		for (int i = 0; i < Teapot::NUM_PATCHES; ++i)
+		{
+			Teapot::LoadPatch(teapot, i);
+		}
+		teapot->transform().position(glm::vec3(0.0f, -1.5f, 0.0f));
+
+		glm::mat4 viewProj = CameraManager::ViewProjMat();
+		int numPatches = teapot->numPatches();
+		std::function<void()> frame = [&]()
+		{
+			RenderManager::Update(1.0f / 60.0f);
+			teapot->Update(1.0f / 60.0f);
+			RenderManager::Draw(viewProj);
+			StreamBuffer::EndFrame();
+		};
+
+		Measurement measurement = Measure(frame);
+		WriteResult(out, first, "teapot.static", numPatches, SurfaceVerts(teapot), measurement);
+
+		std::vector<glm::vec3> original = std::vector<glm::vec3>();
+		for (int i = 0; i < numPatches; ++i)
+		{
+			original.insert(original.end(), teapot->patch(i).controlPoints(), teapot->patch(i).controlPoints() + 16);
+		}
+
+		// Alternates between two sizes of the teapot, so every patch and the topology is rebuilt every frame
+		int frameCount = 0;
+		measurement = Measure([&]()
+		{
+			GLfloat scale = (++frameCount & 1) ? 1.001f : 1.0f;
+			for (int i = 0; i < numPatches; ++i)
+			{
+				for (int k = 0; k < 16; ++k)
+				{
+					teapot->patch(i).SetControlPoint(k, original[i * 16 + k] * scale);
+				}
+			}
+			frame();
+		});
+		WriteResult(out, first, "teapot.animated", numPatches, SurfaceVerts(teapot), measurement);
+
+		delete teapot;
+	}
+
+	// Frames of B_Splines shaped as sheets of about 1k, 10k and 100k patches, with every control point moving every frame.
+	// Each frame rebuilds the topology, picks the levels, evaluates every patch at its level in blocks of rows on the
+	// TaskPool, uploads them and draws the sheet through the RenderManager, the same as the teapot. The camera looks across
+	// the sheet from just above its near edge, so the levels fall off with distance at any size.
+	void SuiteScenes(std::ostream& out, bool& first)
+	{
+		glm::mat4 viewProj = CameraManager::ViewProjMat();
+
+		// Every patch takes the memory of its sheet's finest level up front, so the sheets are capped at the finest level any
+		// of their patches picks instead of all of them holding 65 x 65 grids
+		int sides[] = { 32, 100, 317 };
+		int maxLevels[] = { 6, 5, 3 };
+		for (int s = 0; s < 3; ++s)
+		{
+			int side = sides[s];
+			int numPatches = side * side;
+			std::vector<glm::vec3> controlPoints;
+			Sheet(side, controlPoints);
+
+			// 20 units wide and deep whatever the number of patches, the height of the waves stays the same
+			B_Spline* sheet = BareSpline(numPatches, maxLevels[s]);
+			GLfloat scale = 20.0f / (side * 0.03f);
+			sheet->transform().scale(glm::vec3(scale, 1.0f, scale));
+			sheet->transform().position(glm::vec3(-10.0f, -1.0f, -4.5f));
+
+			int frameCount = 0;
+			std::function<void()> frame = [&]()
+			{
+				GLfloat height = (++frameCount & 1) ? 1.001f : 1.0f;
+				for (int i = 0; i < numPatches; ++i)
+				{
+					for (int k = 0; k < 16; ++k)
+					{
+						glm::vec3 point = controlPoints[i * 16 + k];
+						sheet->patch(i).SetControlPoint(k, glm::vec3(point.x, point.y * height, point.z));
+					}
+				}
+
+				RenderManager::Update(1.0f / 60.0f);
+				sheet->Update(1.0f / 60.0f);
+				RenderManager::Draw(viewProj);
+				StreamBuffer::EndFrame();
+			};
+
+			// Once before measuring, so the first tessellation of every patch isn't counted
+			frame();
+			Measurement measurement = Measure(frame);
+			WriteResult(out, first, "scene", numPatches, SurfaceVerts(sheet), measurement);
+
+			delete sheet;
+		}
+	}
+
+	// The motion pass and the model matrices it leaves to rebuild over 1k, 100k and 1M transforms, every eighth of them
+	// moving and turning. The rest stand still and are never integrated.
+	void SuiteMotion(std::ostream& out, bool& first)
+	{
+		int counts[] = { 1000, 100000, 1000000 };
+		for (int c = 0; c < 3; ++c)
+		{
+			int numTransforms = counts[c];
+			std::vector<Transform> transforms(numTransforms);
+			for (int i = 0; i < numTransforms; i += 8)
+			{
+				transforms[i].linearVelocity(glm::vec3(0.0f, 0.1f, 0.0f));
+				transforms[i].angularVelocity(glm::angleAxis(1.0f, glm::vec3(0.0f, 1.0f, 0.0f)));
+			}
+
+			Measurement measurement = Measure([&]()
+			{
+				RenderManager::Update(1.0f / 60.0f);
+				TransformManager::Update();
+			});
+			WriteResult(out, first, "motion", numTransforms, numTransforms, measurement);
+		}
+	}
+
+	// Frames of the animated teapot among 100k transforms, every eighth of them moving and turning. Once tessellated and
+	// moved before drawing, once on the pipelined job while the frame is drawn, which only pays off with a thread to spare.
+	void SuitePipeline(std::ostream& out, bool& first)
+	{
+		B_Spline* teapot = BareSpline(Teapot::NUM_PATCHES);
+		for (int i = 0; i < Teapot::NUM_PATCHES; ++i)
+		{
+			Teapot::LoadPatch(teapot, i);
+		}
+		teapot->transform().position(glm::vec3(0.0f, -1.5f, 0.0f));
+
+		int numTransforms = 100000;
+		std::vector<Transform> transforms(numTransforms);
+		for (int i = 0; i < numTransforms; i += 8)
+		{
+			transforms[i].linearVelocity(glm::vec3(0.0f, 0.1f, 0.0f));
+			transforms[i].angularVelocity(glm::angleAxis(1.0f, glm::vec3(0.0f, 1.0f, 0.0f)));
+		}
+
+		glm::mat4 viewProj = CameraManager::ViewProjMat();
+		int numPatches = teapot->numPatches();
+		std::vector<glm::vec3> original = std::vector<glm::vec3>();
+		for (int i = 0; i < numPatches; ++i)
+		{
+			original.insert(original.end(), teapot->patch(i).controlPoints(), teapot->patch(i).controlPoints() + 16);
+		}
+
+		const char* names[] = { "pipeline.serial", "pipeline.overlapped" };
+		for (int pipelined = 0; pipelined < 2; ++pipelined)
+		{
+			teapot->pipelined(pipelined == 1);
+			int frameCount = 0;
+			std::function<void()> frame = [&]()
+			{
+				GLfloat scale = (++frameCount & 1) ? 1.001f : 1.0f;
+				for (int i = 0; i < numPatches; ++i)
+				{
+					for (int k = 0; k < 16; ++k)
+					{
+						teapot->patch(i).SetControlPoint(k, original[i * 16 + k] * scale);
+					}
+				}
+
+				RenderManager::Update(1.0f / 60.0f);
+				teapot->Update(1.0f / 60.0f);
+				RenderManager::Draw(viewProj);
+				StreamBuffer::EndFrame();
+			};
+
+			// Twice before measuring, the first frame that tessellates only tells the RenderManager to leave the motion to the
+			// job and the next one takes the first snapshot
+			frame();
+			frame();
+			Measurement measurement = Measure(frame);
+			WriteResult(out, first, names[pipelined], numTransforms, SurfaceVerts(teapot), measurement);
+		}
+
+		teapot->pipelined(false);
+		delete teapot;
+	}
+}
+
+void Benchmark::RunSuite(std::ostream& out)
+{
+	out << "{\n\t\"evaluationPath\": \"" << BezierEvaluator::pathName(BezierEvaluator::bestPath()) << "\",\n\t\"threads\": "
+		<< TaskPool::numThreads() << ",\n\t\"results\": [";
+
+	// The view is only built by the camera's update, the frames are drawn from where the window would start
+	CameraManager::Update(0.0f);
+
+	bool first = true;
+	SuiteCurves(out, first);
+	SuitePatches(out, first);
+	SuiteTeapot(out, first);
+	SuiteScenes(out, first);
+	SuiteMotion(out, first);
+	SuitePipeline(out, first);
+
+	out << "\n\t],\n\t\"peakResidentBytes\": " << PeakResidentBytes() << "\n}" << std::endl;
+}
+
+void Benchmark::Run()
+{
+	std::cout << "Best evaluation path: " << BezierEvaluator::pathName(BezierEvaluator::bestPath()) << std::endl;
+	RunCurveEvaluation();
+	RunPatchEvaluation();
+	RunTopology();
+	RunParallelTessellation();
+}
+
+void Benchmark::RunCurveEvaluation()
+{
+	glm::vec3 controlPoints[4];
+	ControlPoints(controlPoints, 4);
+
+	BezierEvaluator::Path best = BezierEvaluator::bestPath();
+
+	std::cout << std::endl << "Cubic curve evaluation" << std::endl;
+	for (int numVerts = 16; numVerts <= 65536; numVerts *= 16)
+	{
+		std::vector<GLfloat> data(numVerts * 3);
+		int stride = BezierEvaluator::Stride(numVerts);
+		const GLfloat* basis = BasisCache::Bernstein(3, numVerts);
+
+		double baseline = PointsPerSecond([&]() { ScalarCurve(controlPoints, numVerts, &data[0]); }, numVerts);
+		PrintRow("reference", numVerts, baseline, baseline);
+
+		for (int path = BezierEvaluator::PATH_SCALAR; path <= best; ++path)
+		{
+			BezierEvaluator::path((BezierEvaluator::Path)path);
+			double rate = PointsPerSecond([&]() { BezierEvaluator::EvaluateCurve(controlPoints, basis, stride, numVerts, &data[0]); }, numVerts);
+			PrintRow(BezierEvaluator::pathName((BezierEvaluator::Path)path), numVerts, rate, baseline);
+		}
+	}
+	BezierEvaluator::path(best);
+}
+
+void Benchmark::RunPatchEvaluation()
+{
+	glm::vec3 controlPoints[16];
+	ControlPoints(controlPoints, 16);
+
+	BezierEvaluator::Path best = BezierEvaluator::bestPath();
+
+	std::cout << std::endl << "Bicubic patch evaluation (points per side)" << std::endl;
+	for (int numVerts = 10; numVerts <= 160; numVerts *= 4)
+	{
+		std::vector<GLfloat> verts(numVerts * numVerts * 3);
+
+		// The reference loop rebuilt its factors on every call, patches now share one table from the cache
+		double baseline = PointsPerSecond([&]() { ScalarPatch(controlPoints, numVerts, &verts[0]); }, numVerts * numVerts);
+		PrintRow("reference", numVerts, baseline, baseline);
+
+		int stride = BezierEvaluator::Stride(numVerts);
+		const GLfloat* basis = BasisCache::Bernstein(3, numVerts);
+		for (int path = BezierEvaluator::PATH_SCALAR; path <= best; ++path)
+		{
+			BezierEvaluator::path((BezierEvaluator::Path)path);
+			double rate = PointsPerSecond([&]() { BezierEvaluator::EvaluatePatch(controlPoints, basis, stride, numVerts, &verts[0]); }, numVerts * numVerts);
+			PrintRow(BezierEvaluator::pathName((BezierEvaluator::Path)path), numVerts, rate, baseline);
+		}
+	}
+	BezierEvaluator::path(best);
+}
+
+void Benchmark::RunTopology()
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	std::cout << std::endl << "Patch topology build (patches)" << std::endl;
+	for (int side = 10; side <= 400; side *= 2)
+	{
+		std::vector<glm::vec3> controlPoints;
+		Sheet(side, controlPoints);
+
+		PatchTopology topology;
+		Clock::time_point start = Clock::now();
+		topology.Build(controlPoints);
+		double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+		std::cout << std::setw(10) << side * side << std::setw(12) << std::fixed << std::setprecision(1) << elapsed * 1000.0 << " ms"
+			<< std::setw(10) << topology.numSharedEdges() << " shared" << std::setw(10) << topology.numCornerVertices() << " corners" << std::endl;
+	}
+}
+
+void Benchmark::RunParallelTessellation()
+{
+	const int SIDE = 100;
+	const int ROWS_PER_BLOCK = 16;
+
+	std::vector<glm::vec3> controlPoints;
+	Sheet(SIDE, controlPoints);
+	int numPatches = SIDE * SIDE;
+
+	// Powers of two up to every hardware thread, and all of them when that isn't one
+	std::vector<int> threadCounts = std::vector<int>();
+	int maxThreads = std::thread::hardware_concurrency();
+	if (maxThreads < 1) maxThreads = 1;
+	for (int threads = 1; threads < maxThreads; threads *= 2)
+	{
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(maxThreads);
+
+	for (int numVerts = 17; numVerts <= 33; numVerts += 16)
+	{
+		std::cout << std::endl << "Parallel tessellation of " << numPatches << " patches at " << numVerts << " x " << numVerts << " (threads)" << std::endl;
+
+		int gridSize = numVerts * numVerts * 3;
+		std::vector<GLfloat> verts(numPatches * gridSize);
+		int stride = BezierEvaluator::Stride(numVerts);
+		const GLfloat* basis = BasisCache::Bernstein(3, numVerts);
+
+		// Same split as B_Spline, blocks of rows of every patch
+		int blocksPerPatch = (numVerts + ROWS_PER_BLOCK - 1) / ROWS_PER_BLOCK;
+		int numBlocks = numPatches * blocksPerPatch;
+		std::function<void(int, int)> tessellate = [&](int begin, int end)
+		{
+			for (int b = begin; b < end; ++b)
+			{
+				int patch = b / blocksPerPatch;
+				int firstRow = (b % blocksPerPatch) * ROWS_PER_BLOCK;
+				int numRows = numVerts - firstRow < ROWS_PER_BLOCK ? numVerts - firstRow : ROWS_PER_BLOCK;
+				BezierEvaluator::EvaluatePatchRows(&controlPoints[patch * 16], basis, stride, numVerts, firstRow, numRows, &verts[patch * gridSize]);
+			}
+		};
+
+		double baseline = 0.0;
+		unsigned long long reference = 0;
+		for (unsigned int t = 0; t < threadCounts.size(); ++t)
+		{
+			TaskPool::Init(threadCounts[t]);
+			long long steals = TaskPool::numSteals();
+
+			std::fill(verts.begin(), verts.end(), 0.0f);
+			double rate = PointsPerSecond([&]() { TaskPool::ParallelFor(numBlocks, 8, tessellate); }, numPatches * numVerts * numVerts);
+			steals = TaskPool::numSteals() - steals;
+			TaskPool::Shutdown();
+
+			// Every thread count has to produce the same bits as the single threaded run
+			unsigned long long hash = Hash(verts);
+			if (t == 0)
+			{
+				baseline = rate;
+				reference = hash;
+			}
+
+			std::cout << std::setw(10) << threadCounts[t]
+				<< std::setw(16) << std::fixed << std::setprecision(1) << rate / 1.0e6 << " Mpts/s"
+				<< std::setw(10) << std::setprecision(2) << rate / baseline << "x"
+				<< std::setw(12) << steals << " steals"
+				<< (hash == reference ? "   identical" : "   DIFFERENT") << std::endl;
+		}
+	}
+}
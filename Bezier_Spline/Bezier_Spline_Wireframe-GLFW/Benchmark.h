@@ -0,0 +1,20 @@
+#pragma once
+#include <ostream>
+
+// Micro-benchmarks for the geometry code, built on their own as Bezier_Spline_Benchmark.
+// None of them need a window or a GL context.
+class Benchmark
+{
+public:
+	static void Run();
+
+	// The suite run by -json, written as one JSON object so runs of different builds can be compared. Every result has
+	// the time, points and heap allocations per iteration, and the peak resident memory so far. Has to run on a
+	// NullRenderBackend, with the TaskPool and camera set up.
+	static void RunSuite(std::ostream& out);
+private:
+	static void RunCurveEvaluation();
+	static void RunPatchEvaluation();
+	static void RunTopology();
+	static void RunParallelTessellation();
+};
@@ -0,0 +1,53 @@
+#include <GLM/glm.hpp>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+
+#include "Benchmark.h"
+#include "CameraManager.h"
+#include "PatchLod.h"
+#include "RenderManager.h"
+#include "GridIndexRegistry.h"
+#include "TaskPool.h"
+#include "RenderBackend.h"
+#include "NullRenderBackend.h"
+
+// Bezier_Spline_Benchmark, the benchmarks on their own so they build and run without a window. With no arguments it prints
+// the micro-benchmarks, -json [file] writes the suite to file or to the console without one.
+int main(int argc, char** argv)
+{
+	if (argc > 1 && strcmp(argv[1], "-json") != 0)
+	{
+		std::cout << "Run it with no arguments to print the benchmarks, or with -json [file] to write the suite" << std::endl;
+		return 1;
+	}
+
+	if (argc == 1)
+	{
+		Benchmark::Run();
+		return 0;
+	}
+
+	// The suite draws through the RenderManager like the program does, onto a backend that only counts
+	RenderBackend::Set(new NullRenderBackend());
+	TaskPool::Init();
+	CameraManager::Init(800.0f / 600.0f, 60.0f, 0.1f, 100.0f);
+	PatchLod::screenSize(glm::vec2(800.0f, 600.0f));
+
+	if (argc > 2)
+	{
+		std::ofstream file(argv[2]);
+		Benchmark::RunSuite(file);
+		std::cout << "Wrote " << argv[2] << std::endl;
+	}
+	else
+	{
+		Benchmark::RunSuite(std::cout);
+	}
+
+	RenderManager::DumpData();
+	GridIndexRegistry::Release();
+	TaskPool::Shutdown();
+	RenderBackend::Release();
+	return 0;
+}
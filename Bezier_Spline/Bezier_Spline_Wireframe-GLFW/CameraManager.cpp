@@ -1,5 +1,6 @@
 #include "CameraManager.h"
 #include "InputManager.h"
+#include "Profiler.h"
 
 glm::mat4 CameraManager::_proj;
 glm::mat4 CameraManager::_view;
@@ -13,6 +14,8 @@ void CameraManager::Init(float aspectRatio, float fov, float near, float far)
 
 void CameraManager::Update(float dt)
 {
+	PROFILE_ZONE("CameraManager::Update");
+
 	float rotRate = 180.0f;
 	if (InputManager::cursorLocked())
 	{
@@ -0,0 +1,177 @@
+#include "GeometryArena.h"
+#include "StreamBuffer.h"
+#include "RenderBackend.h"
+
+GeometryArena::GeometryArena(Shader shader, GLsizei vertexSize, GLsizei pageVerts, const std::vector<int>& gridSizes)
+{
+	_shader = shader;
+	_vertexSize = vertexSize;
+	_pageVerts = pageVerts;
+	_usedVerts = 0;
+	_retiredVerts = 0;
+
+	// Every grid's triangles and lines back to back, the offsets are the same for every page
+	std::vector<GLuint> elements = std::vector<GLuint>();
+	for (int primitive = 0; primitive < GridIndexRegistry::NUM_PRIMITIVES; ++primitive)
+	{
+		for (unsigned int i = 0; i < gridSizes.size(); ++i)
+		{
+			const std::vector<GLuint>& gridElements = GridIndexRegistry::Elements(gridSizes[i], (GridIndexRegistry::Primitive)primitive);
+			_indexOffsets[primitive][gridSizes[i]] = sizeof(GLuint) * elements.size();
+			elements.insert(elements.end(), gridElements.begin(), gridElements.end());
+		}
+	}
+
+	_ebo = RenderBackend::Get().CreateBuffer(sizeof(GLuint) * elements.size(), (void*)&elements[0], GL_STATIC_DRAW);
+}
+GeometryArena::~GeometryArena()
+{
+	for (std::map<StreamBuffer*, Block>::iterator itr = _blocks.begin(); itr != _blocks.end(); ++itr)
+	{
+		delete itr->first;
+	}
+	for (unsigned int i = 0; i < _retired.size(); ++i)
+	{
+		RenderBackend::Get().DeleteFence(_retired[i].fence);
+	}
+	for (unsigned int i = 0; i < _pages.size(); ++i)
+	{
+		RenderBackend::Get().DeleteBuffer(_pages[i].vbo);
+		RenderBackend::Get().DeleteVertexArray(_pages[i].vao);
+	}
+	RenderBackend::Get().DeleteBuffer(_ebo);
+}
+
+StreamBuffer* GeometryArena::Allocate(GLsizei maxVerts)
+{
+	GLsizei footprint = StreamBuffer::FootprintVerts(maxVerts);
+	Reclaim();
+
+	// First fit over the pages in order, so the early pages stay full and the later ones can drain
+	for (unsigned int p = 0; p <= _pages.size(); ++p)
+	{
+		// Each page twice the size of the last, so an arena that keeps growing only needs a few of them
+		if (p == _pages.size())
+		{
+			GLsizei pageVerts = _pages.empty() ? _pageVerts : _pages.back().numVerts * 2;
+			AddPage(footprint > pageVerts ? footprint : pageVerts);
+		}
+
+		Page& page = _pages[p];
+		for (std::map<GLint, GLsizei>::iterator itr = page.freeRanges.begin(); itr != page.freeRanges.end(); ++itr)
+		{
+			if (itr->second < footprint) continue;
+
+			GLint first = itr->first;
+			GLsizei remaining = itr->second - footprint;
+			page.freeRanges.erase(itr);
+			if (remaining > 0) page.freeRanges[first + footprint] = remaining;
+
+			StreamBuffer* block = new StreamBuffer(page.vbo, page.mapped, first, _vertexSize, maxVerts);
+			Block range = { (int)p, first, footprint };
+			_blocks[block] = range;
+			_usedVerts += footprint;
+			return block;
+		}
+	}
+	return NULL;
+}
+
+void GeometryArena::Free(StreamBuffer* block)
+{
+	std::map<StreamBuffer*, Block>::iterator found = _blocks.find(block);
+	if (found == _blocks.end())
+		return;
+
+	Block range = found->second;
+	_blocks.erase(found);
+	_usedVerts -= range.numVerts;
+	delete block;
+
+	// The next block handed this range writes to it straight away, so draws still in flight have to be done with it first.
+	// Without a persistent mapping every write goes through the driver, which keeps them apart itself.
+	GLsync fence = StreamBuffer::persistent() ? RenderBackend::Get().Fence() : 0;
+	if (fence)
+	{
+		RetiredBlock retired = { range, fence };
+		_retired.push_back(retired);
+		_retiredVerts += range.numVerts;
+		return;
+	}
+	Release(range);
+}
+
+void GeometryArena::Reclaim()
+{
+	// Fences are passed in order, so the first one still ahead of the gpu holds back all the ones after it
+	unsigned int numPassed = 0;
+	while (numPassed < _retired.size() && RenderBackend::Get().FenceSignaled(_retired[numPassed].fence))
+	{
+		RenderBackend::Get().DeleteFence(_retired[numPassed].fence);
+		_retiredVerts -= _retired[numPassed].range.numVerts;
+		Release(_retired[numPassed].range);
+		++numPassed;
+	}
+	_retired.erase(_retired.begin(), _retired.begin() + numPassed);
+}
+
+void GeometryArena::Release(Block range)
+{
+	// Merge with the free ranges on either side
+	std::map<GLint, GLsizei>& freeRanges = _pages[range.page].freeRanges;
+	std::map<GLint, GLsizei>::iterator next = freeRanges.lower_bound(range.firstVertex);
+	if (next != freeRanges.end() && next->first == range.firstVertex + range.numVerts)
+	{
+		range.numVerts += next->second;
+		next = freeRanges.erase(next);
+	}
+	if (next != freeRanges.begin())
+	{
+		std::map<GLint, GLsizei>::iterator previous = next;
+		--previous;
+		if (previous->first + previous->second == range.firstVertex)
+		{
+			previous->second += range.numVerts;
+			return;
+		}
+	}
+	freeRanges[range.firstVertex] = range.numVerts;
+}
+
+int GeometryArena::page(StreamBuffer* block) { return _blocks[block].page; }
+int GeometryArena::numPages() { return _pages.size(); }
+GLuint GeometryArena::vao(int page) { return _pages[page].vao; }
+
+GLsizeiptr GeometryArena::indexOffset(int numVerts, GridIndexRegistry::Primitive primitive) { return _indexOffsets[primitive][numVerts]; }
+GLsizei GeometryArena::indexCount(int numVerts, GridIndexRegistry::Primitive primitive) { return GridIndexRegistry::Count(numVerts, primitive); }
+
+GLsizei GeometryArena::usedVerts() { return _usedVerts; }
+GLsizei GeometryArena::retiredVerts() { return _retiredVerts; }
+GLsizei GeometryArena::capacityVerts()
+{
+	GLsizei capacity = 0;
+	for (unsigned int i = 0; i < _pages.size(); ++i)
+	{
+		capacity += _pages[i].numVerts;
+	}
+	return capacity;
+}
+
+void GeometryArena::AddPage(GLsizei numVerts)
+{
+	Page page;
+	page.numVerts = numVerts;
+	page.mapped = NULL;
+	page.freeRanges[0] = numVerts;
+
+	RenderBackend& backend = RenderBackend::Get();
+	GLsizeiptr size = (GLsizeiptr)_vertexSize * numVerts;
+	if (StreamBuffer::persistent()) page.vbo = backend.CreateMappedBuffer(size, &page.mapped);
+	else page.vbo = backend.CreateBuffer(size, NULL, GL_DYNAMIC_DRAW);
+
+	// Bind buffer data to shader values
+	page.vao = backend.CreateVertexArray(_ebo);
+	backend.VertexAttribute(page.vao, page.vbo, backend.AttribLocation(_shader.shaderPointer, "position"), 3, _vertexSize, 0);
+
+	_pages.push_back(page);
+}
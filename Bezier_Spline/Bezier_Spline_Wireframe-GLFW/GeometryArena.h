@@ -0,0 +1,86 @@
+#pragma once
+#include "RenderShape.h"
+#include "GridIndexRegistry.h"
+
+#include <GLEW/GL/glew.h>
+#include <map>
+#include <vector>
+
+class StreamBuffer;
+
+// Vertex memory shared by many grids that are drawn with the same shader. Vertices live in large pages with one vbo and
+// one vao each, and the triangle and line indices of every grid size the arena was built for are stored once in a
+// single ebo that all the pages bind. Blocks are handed out as StreamBuffers over part of a page and go back on a free
+// list when released, so grids can come and go without moving the others. A page is only added when none of the free
+// ranges of the existing ones is large enough, and is twice the size of the one before it. Persistently mapped ranges
+// the gpu may still be drawing from are retired behind a fence when freed, and only go back on the free list once the
+// gpu has passed it.
+class GeometryArena
+{
+public:
+	GeometryArena(Shader shader, GLsizei vertexSize, GLsizei pageVerts, const std::vector<int>& gridSizes);
+	~GeometryArena();
+
+	// A block for up to maxVerts vertices, with the StreamBuffer regions it needs
+	StreamBuffer* Allocate(GLsizei maxVerts);
+	// Never waits for the gpu, the block's range is reused once the draws already made from it are done
+	void Free(StreamBuffer* block);
+
+	// Page a block lives in
+	int page(StreamBuffer* block);
+	int numPages();
+	GLuint vao(int page);
+
+	// Byte offset and number of a grid size's indices in the shared ebo
+	GLsizeiptr indexOffset(int numVerts, GridIndexRegistry::Primitive primitive);
+	GLsizei indexCount(int numVerts, GridIndexRegistry::Primitive primitive);
+
+	// Vertices handed out in blocks, vertices freed but still waiting on their fence, and vertices in all the pages
+	GLsizei usedVerts();
+	GLsizei retiredVerts();
+	GLsizei capacityVerts();
+private:
+	struct Page
+	{
+		GLuint vbo;
+		GLuint vao;
+		GLvoid* mapped;
+		GLsizei numVerts;
+
+		// Keyed by first vertex, neighbouring ranges are merged as soon as they are freed
+		std::map<GLint, GLsizei> freeRanges;
+	};
+
+	struct Block
+	{
+		int page;
+		GLint firstVertex;
+		GLsizei numVerts;
+	};
+
+	struct RetiredBlock
+	{
+		Block range;
+		GLsync fence;
+	};
+
+	void AddPage(GLsizei numVerts);
+	// Puts the retired ranges whose fences have been passed back on the free lists
+	void Reclaim();
+	void Release(Block range);
+private:
+	Shader _shader;
+	GLsizei _vertexSize;
+	GLsizei _pageVerts;
+	GLsizei _usedVerts;
+	GLsizei _retiredVerts;
+
+	std::vector<Page> _pages;
+	std::map<StreamBuffer*, Block> _blocks;
+
+	// In the order they were freed, which is the order their fences are passed in
+	std::vector<RetiredBlock> _retired;
+
+	GLuint _ebo;
+	std::map<int, GLsizeiptr> _indexOffsets[GridIndexRegistry::NUM_PRIMITIVES];
+};
@@ -0,0 +1,186 @@
+#include "GpuPatchEvaluator.h"
+#include "Patch.h"
+#include "RenderBackend.h"
+
+#include <algorithm>
+#include <cstring>
+
+GpuPatchEvaluator::GpuPatchEvaluator(Shader shader)
+{
+	RenderBackend& backend = RenderBackend::Get();
+
+	_shader = shader;
+	_bytesUploaded = 0;
+	for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+	{
+		_firstPatch[level] = 0;
+		_numPatches[level] = 0;
+		_attribFirstPatch[level] = 0;
+	}
+
+	_controlPointBuffer = backend.CreateBuffer(0, NULL, GL_DYNAMIC_DRAW);
+	_patchIndexBuffer = backend.CreateBuffer(0, NULL, GL_DYNAMIC_DRAW);
+	_feedbackBuffer = backend.CreateBuffer(0, NULL, GL_STREAM_READ);
+
+	// The controlPoints sampler is left on texture unit 0, where the texture is bound
+	_controlPointTexture = backend.CreateBufferTexture(_controlPointBuffer, GL_RGBA32F);
+
+	// Bind buffer data to shader values
+	GLint parameterAttrib = backend.AttribLocation(_shader.shaderPointer, "parameter");
+	_patchIndexAttrib = backend.AttribLocation(_shader.shaderPointer, "patchIndex");
+	for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+	{
+		int numVerts = PatchLod::LevelVerts(level);
+		for (int primitive = 0; primitive < GridIndexRegistry::NUM_PRIMITIVES; ++primitive)
+		{
+			GLuint vao = backend.CreateVertexArray(GridIndexRegistry::Buffer(numVerts, (GridIndexRegistry::Primitive)primitive));
+			backend.VertexAttribute(vao, GridIndexRegistry::ParameterBuffer(numVerts), parameterAttrib, 2, 0, 0);
+
+			// Pointed at the run of patches of this level whenever it moves
+			backend.IntegerVertexAttribute(vao, _patchIndexBuffer, _patchIndexAttrib, 1, 0, 0, 1);
+			_vaos[level][primitive] = vao;
+		}
+	}
+}
+GpuPatchEvaluator::~GpuPatchEvaluator()
+{
+	RenderBackend& backend = RenderBackend::Get();
+	for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+	{
+		for (int primitive = 0; primitive < GridIndexRegistry::NUM_PRIMITIVES; ++primitive)
+		{
+			backend.DeleteVertexArray(_vaos[level][primitive]);
+		}
+	}
+	backend.DeleteTexture(_controlPointTexture);
+	backend.DeleteBuffer(_controlPointBuffer);
+	backend.DeleteBuffer(_patchIndexBuffer);
+	backend.DeleteBuffer(_feedbackBuffer);
+}
+
+void GpuPatchEvaluator::PointPatchIndices(int level, GLint first)
+{
+	if (first == _attribFirstPatch[level]) return;
+
+	for (int primitive = 0; primitive < GridIndexRegistry::NUM_PRIMITIVES; ++primitive)
+	{
+		RenderBackend::Get().IntegerVertexAttribute(_vaos[level][primitive], _patchIndexBuffer, _patchIndexAttrib, 1, 0, sizeof(GLint) * first, 1);
+	}
+	_attribFirstPatch[level] = first;
+}
+
+void GpuPatchEvaluator::Update(std::vector<Patch*>& patches)
+{
+	unsigned int size = patches.size();
+	_nextTexels.assign(size * PATCH_TEXELS * 4, 0.0f);
+	for (unsigned int p = 0; p < size; ++p)
+	{
+		GLfloat* patchTexels = &_nextTexels[p * PATCH_TEXELS * 4];
+		const glm::vec3* controlPoints = patches[p]->controlPoints();
+		for (int k = 0; k < 16; ++k)
+		{
+			patchTexels[k * 4] = controlPoints[k].x;
+			patchTexels[k * 4 + 1] = controlPoints[k].y;
+			patchTexels[k * 4 + 2] = controlPoints[k].z;
+		}
+		for (int edge = 0; edge < Patch::NUM_EDGES; ++edge)
+		{
+			int edgeLevel = patches[p]->edgeLevel(edge);
+			patchTexels[16 * 4 + edge] = edgeLevel >= 0 ? (GLfloat)PatchLod::LevelVerts(edgeLevel) : 0.0f;
+		}
+	}
+
+	// Counting sort by level, so each level is drawn from one run of patch indices
+	for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+	{
+		_numPatches[level] = 0;
+	}
+	for (unsigned int p = 0; p < size; ++p)
+	{
+		++_numPatches[patches[p]->level()];
+	}
+	GLint first = 0;
+	for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+	{
+		_firstPatch[level] = first;
+		first += _numPatches[level];
+	}
+	_nextPatchIndices.resize(size);
+	GLint next[PatchLod::NUM_LEVELS];
+	memcpy(next, _firstPatch, sizeof(next));
+	for (unsigned int p = 0; p < size; ++p)
+	{
+		_nextPatchIndices[next[patches[p]->level()]++] = p;
+	}
+
+	RenderBackend& backend = RenderBackend::Get();
+	if (_nextTexels != _texels)
+	{
+		_texels.swap(_nextTexels);
+		backend.BufferData(_controlPointBuffer, sizeof(GLfloat) * _texels.size(), _texels.empty() ? NULL : (void*)&_texels[0], GL_DYNAMIC_DRAW);
+		_bytesUploaded += sizeof(GLfloat) * _texels.size();
+	}
+	if (_nextPatchIndices != _patchIndices)
+	{
+		_patchIndices.swap(_nextPatchIndices);
+		backend.BufferData(_patchIndexBuffer, sizeof(GLint) * _patchIndices.size(), _patchIndices.empty() ? NULL : (void*)&_patchIndices[0], GL_DYNAMIC_DRAW);
+		_bytesUploaded += sizeof(GLint) * _patchIndices.size();
+	}
+	for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+	{
+		PointPatchIndices(level, _firstPatch[level]);
+	}
+}
+
+void GpuPatchEvaluator::Draw(GridIndexRegistry::Primitive primitive)
+{
+	RenderBackend& backend = RenderBackend::Get();
+	backend.BindBufferTexture(_controlPointTexture);
+
+	GLenum mode = primitive == GridIndexRegistry::TRIANGLES ? GL_TRIANGLES : GL_LINES;
+	for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+	{
+		if (_numPatches[level] == 0) continue;
+
+		backend.DrawElementsInstanced(_vaos[level][primitive], mode, GridIndexRegistry::Count(PatchLod::LevelVerts(level), primitive), _numPatches[level]);
+	}
+}
+
+void GpuPatchEvaluator::Capture(int patch, int level, std::vector<GLfloat>& positions)
+{
+	RenderBackend& backend = RenderBackend::Get();
+	int numVerts = PatchLod::LevelVerts(level);
+	GLsizeiptr numBytes = sizeof(GLfloat) * numVerts * numVerts * 3;
+	positions.resize(numVerts * numVerts * 3);
+
+	// One point per grid vertex in grid order. Without instancing every point reads the first patch index the
+	// attribute points at, so it is pointed at the one slot holding this patch for the capture.
+	std::vector<GLint>::iterator slot = std::find(_patchIndices.begin(), _patchIndices.end(), patch);
+	if (slot == _patchIndices.end())
+	{
+		positions.assign(positions.size(), 0.0f);
+		return;
+	}
+	GLint first = _attribFirstPatch[level];
+	PointPatchIndices(level, (GLint)(slot - _patchIndices.begin()));
+
+	backend.BufferData(_feedbackBuffer, numBytes, NULL, GL_STREAM_READ);
+	GLint program = backend.program();
+	backend.UseProgram(_shader.shaderPointer);
+	backend.BindBufferTexture(_controlPointTexture);
+	backend.CapturePoints(_vaos[level][GridIndexRegistry::TRIANGLES], numVerts * numVerts, _feedbackBuffer, numBytes, (GLvoid*)&positions[0]);
+	backend.UseProgram(program);
+
+	PointPatchIndices(level, first);
+}
+
+int GpuPatchEvaluator::numDrawCalls()
+{
+	int numDrawCalls = 0;
+	for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+	{
+		if (_numPatches[level] > 0) ++numDrawCalls;
+	}
+	return numDrawCalls;
+}
+GLsizeiptr GpuPatchEvaluator::bytesUploaded() { return _bytesUploaded; }
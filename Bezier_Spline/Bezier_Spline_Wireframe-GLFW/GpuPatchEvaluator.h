@@ -0,0 +1,66 @@
+#pragma once
+#include "RenderShape.h"
+#include "PatchLod.h"
+#include "GridIndexRegistry.h"
+
+#include <GLEW/GL/glew.h>
+#include <vector>
+
+class Patch;
+
+// Evaluates the patches of a B_Spline in the vertex shader instead of on the cpu. Every patch tessellated at a level
+// draws the same static (u, v) grid from GridIndexRegistry, and the shader looks its control points and stitched edges
+// up in a texture buffer by patch index. The patches of one level are drawn with a single instanced call, taking the
+// patch index from a per-instance attribute. Only the control points ever go to the gpu, and only when they or a
+// level changed.
+class GpuPatchEvaluator
+{
+public:
+	static const int PATCH_TEXELS = 17;
+
+	// The shader has to be vShaderBezier.glsl, linked with surfacePosition as its transform feedback varying
+	GpuPatchEvaluator(Shader shader);
+	~GpuPatchEvaluator();
+
+	// Packs the control points and edge levels of every patch, and uploads them if anything changed
+	void Update(std::vector<Patch*>& patches);
+
+	// Draws every patch, with the shader's program in use and its transform and color set
+	void Draw(GridIndexRegistry::Primitive primitive);
+
+	// Runs the shader over a patch's grid at a level and reads the evaluated positions back with transform feedback
+	void Capture(int patch, int level, std::vector<GLfloat>& positions);
+
+	int numDrawCalls();
+	GLsizeiptr bytesUploaded();
+private:
+	Shader _shader;
+	GLint _patchIndexAttrib;
+
+	GLuint _controlPointBuffer;
+	GLuint _controlPointTexture;
+	GLuint _patchIndexBuffer;
+	GLuint _feedbackBuffer;
+
+	// One vao per level and primitive, binding the level's parameter and index buffers and the patch indices
+	GLuint _vaos[PatchLod::NUM_LEVELS][GridIndexRegistry::NUM_PRIMITIVES];
+
+	// What was last uploaded, to skip frames where nothing changed
+	std::vector<GLfloat> _texels;
+	std::vector<GLint> _patchIndices;
+
+	// Built by Update and swapped with the two above when they differ, so both buffers are reused frame to frame
+	std::vector<GLfloat> _nextTexels;
+	std::vector<GLint> _nextPatchIndices;
+
+	// Patch indices sorted by level, the patches of each level are a contiguous run
+	GLint _firstPatch[PatchLod::NUM_LEVELS];
+	GLsizei _numPatches[PatchLod::NUM_LEVELS];
+
+	// Where in the patch indices each level's vaos read from, so they are only pointed again when their run moved
+	GLint _attribFirstPatch[PatchLod::NUM_LEVELS];
+
+	void PointPatchIndices(int level, GLint first);
+
+	GLsizeiptr _bytesUploaded;
+};
@@ -0,0 +1,22 @@
+#include "GpuPatchShape.h"
+#include "GpuPatchEvaluator.h"
+
+GpuPatchShape::GpuPatchShape(GpuPatchEvaluator* evaluator, GridIndexRegistry::Primitive primitive, Shader shader, glm::vec4 color, bool useDepthTest)
+	: RenderShape(0, 0, primitive == GridIndexRegistry::TRIANGLES ? GL_TRIANGLES : GL_LINES, shader, color, useDepthTest)
+{
+	_evaluator = evaluator;
+	_primitive = primitive;
+	_active = false;
+}
+GpuPatchShape::~GpuPatchShape()
+{
+
+}
+
+void GpuPatchShape::Draw()
+{
+	if (!_active)
+		return;
+
+	_evaluator->Draw(_primitive);
+}
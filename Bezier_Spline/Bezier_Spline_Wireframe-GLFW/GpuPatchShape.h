@@ -0,0 +1,19 @@
+#pragma once
+#include "RenderShape.h"
+#include "GridIndexRegistry.h"
+
+class GpuPatchEvaluator;
+
+// Draws the patches of a GpuPatchEvaluator as a surface or a wireframe. It brings its own shader program, which
+// RenderManager switches to before drawing it, so it can sit in the RenderManager between ordinary shapes.
+class GpuPatchShape : public RenderShape
+{
+public:
+	GpuPatchShape(GpuPatchEvaluator* evaluator, GridIndexRegistry::Primitive primitive, Shader shader, glm::vec4 color, bool useDepthTest = true);
+	~GpuPatchShape();
+
+	void Draw();
+private:
+	GpuPatchEvaluator* _evaluator;
+	GridIndexRegistry::Primitive _primitive;
+};
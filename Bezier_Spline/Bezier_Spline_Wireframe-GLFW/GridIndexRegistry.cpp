@@ -0,0 +1,111 @@
+#include "GridIndexRegistry.h"
+#include "RenderBackend.h"
+
+std::map<int, GridIndexRegistry::Grid*> GridIndexRegistry::_grids = std::map<int, GridIndexRegistry::Grid*>();
+
+GLuint GridIndexRegistry::Buffer(int numVerts, Primitive primitive)
+{
+	Grid& grid = Find(numVerts);
+	if (grid.buffers[primitive] == 0)
+	{
+		grid.buffers[primitive] = RenderBackend::Get().CreateBuffer(sizeof(GLuint) * grid.elements[primitive].size(), (void*)&grid.elements[primitive][0], GL_STATIC_DRAW);
+	}
+	return grid.buffers[primitive];
+}
+
+const std::vector<GLuint>& GridIndexRegistry::Elements(int numVerts, Primitive primitive) { return Find(numVerts).elements[primitive]; }
+GLsizei GridIndexRegistry::Count(int numVerts, Primitive primitive) { return Find(numVerts).elements[primitive].size(); }
+
+GLuint GridIndexRegistry::ParameterBuffer(int numVerts)
+{
+	Grid& grid = Find(numVerts);
+	if (grid.parameters == 0)
+	{
+		// Same spacing the cpu tessellation samples at, so both land on the same points of the surface
+		std::vector<GLfloat> parameters = std::vector<GLfloat>();
+		parameters.reserve(numVerts * numVerts * 2);
+		for (int i = 0; i < numVerts; ++i)
+		{
+			for (int j = 0; j < numVerts; ++j)
+			{
+				parameters.push_back((GLfloat)i / ((GLfloat)numVerts - 1.0f));
+				parameters.push_back((GLfloat)j / ((GLfloat)numVerts - 1.0f));
+			}
+		}
+
+		grid.parameters = RenderBackend::Get().CreateBuffer(sizeof(GLfloat) * parameters.size(), (void*)&parameters[0], GL_STATIC_DRAW);
+	}
+	return grid.parameters;
+}
+
+int GridIndexRegistry::numBuffers()
+{
+	int numBuffers = 0;
+	for (std::map<int, Grid*>::iterator itr = _grids.begin(); itr != _grids.end(); ++itr)
+	{
+		for (int primitive = 0; primitive < NUM_PRIMITIVES; ++primitive)
+		{
+			if (itr->second->buffers[primitive] != 0) ++numBuffers;
+		}
+		if (itr->second->parameters != 0) ++numBuffers;
+	}
+	return numBuffers;
+}
+
+void GridIndexRegistry::Release()
+{
+	for (std::map<int, Grid*>::iterator itr = _grids.begin(); itr != _grids.end(); ++itr)
+	{
+		for (int primitive = 0; primitive < NUM_PRIMITIVES; ++primitive)
+		{
+			if (itr->second->buffers[primitive] != 0) RenderBackend::Get().DeleteBuffer(itr->second->buffers[primitive]);
+		}
+		if (itr->second->parameters != 0) RenderBackend::Get().DeleteBuffer(itr->second->parameters);
+		delete itr->second;
+	}
+	_grids.clear();
+}
+
+GridIndexRegistry::Grid& GridIndexRegistry::Find(int numVerts)
+{
+	std::map<int, Grid*>::iterator itr = _grids.find(numVerts);
+	if (itr != _grids.end()) return *itr->second;
+
+	Grid* grid = new Grid();
+	grid->buffers[TRIANGLES] = 0;
+	grid->buffers[LINES] = 0;
+	grid->parameters = 0;
+
+	int numQuads = (numVerts - 1) * (numVerts - 1);
+	grid->elements[TRIANGLES].reserve(numQuads * 6);
+	grid->elements[LINES].reserve(numQuads * 12);
+
+	int quadsPerRow = numVerts * (numVerts - 1);
+	for (int i = 0; i < quadsPerRow; i += numVerts)
+	{
+		for (int j = 0; j < numVerts - 1; ++j)
+		{
+			AddFace(i + j, i + j + 1, i + numVerts + j, *grid);
+			AddFace(i + j + 1, i + numVerts + j + 1, i + numVerts + j, *grid);
+		}
+	}
+
+	_grids[numVerts] = grid;
+	return *grid;
+}
+
+void GridIndexRegistry::AddFace(GLuint a, GLuint b, GLuint c, Grid& grid)
+{
+	grid.elements[TRIANGLES].push_back(a);
+	grid.elements[TRIANGLES].push_back(b);
+	grid.elements[TRIANGLES].push_back(c);
+
+	grid.elements[LINES].push_back(a);
+	grid.elements[LINES].push_back(b);
+
+	grid.elements[LINES].push_back(b);
+	grid.elements[LINES].push_back(c);
+
+	grid.elements[LINES].push_back(c);
+	grid.elements[LINES].push_back(a);
+}
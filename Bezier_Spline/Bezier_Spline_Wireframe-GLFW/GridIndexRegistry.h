@@ -0,0 +1,48 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+#include <map>
+#include <vector>
+
+// Index buffers for a square grid of numVerts x numVerts vertices, where vertex (i, j) lives at j + i * numVerts.
+// Every grid of the same size uses the same topology, so each (size, primitive) pair is built and uploaded once and
+// bound by every vao that draws a grid of that size. Buffers are created the first time they are asked for, which has
+// to happen on the thread that owns the GL context.
+class GridIndexRegistry
+{
+public:
+	enum Primitive
+	{
+		TRIANGLES,
+		LINES,
+		NUM_PRIMITIVES
+	};
+
+	static GLuint Buffer(int numVerts, Primitive primitive);
+
+	// The indices uploaded to Buffer, for code that remaps them on the cpu
+	static const std::vector<GLuint>& Elements(int numVerts, Primitive primitive);
+
+	static GLsizei Count(int numVerts, Primitive primitive);
+
+	// Vertex buffer holding the (u, v) parameters of every vertex of the grid, for shaders that evaluate the surface themselves
+	static GLuint ParameterBuffer(int numVerts);
+
+	// Number of index and parameter buffers uploaded so far
+	static int numBuffers();
+
+	// Deletes every buffer, only safe once nothing draws with them anymore
+	static void Release();
+private:
+	struct Grid
+	{
+		std::vector<GLuint> elements[NUM_PRIMITIVES];
+		GLuint buffers[NUM_PRIMITIVES];
+		GLuint parameters;
+	};
+
+	static Grid& Find(int numVerts);
+	static void AddFace(GLuint a, GLuint b, GLuint c, Grid& grid);
+private:
+	// Keyed by numVerts, map nodes never move so references handed out stay valid until Release
+	static std::map<int, Grid*> _grids;
+};
@@ -1,4 +1,5 @@
 #include "InputManager.h"
+#include "Profiler.h"
 
 double InputManager::_mousePos[2];
 
@@ -23,6 +24,10 @@ bool InputManager::_sKey = false;
 bool InputManager::_prevSKey = false;
 bool InputManager::_dKey = false;
 bool InputManager::_prevDKey = false;
+bool InputManager::_gKey = false;
+bool InputManager::_prevGKey = false;
+bool InputManager::_pKey = false;
+bool InputManager::_prevPKey = false;
 bool InputManager::_shiftKey = false;
 bool InputManager::_prevShiftKey = false;
 bool InputManager::_ctrlKey = false;
@@ -35,6 +40,8 @@ GLFWwindow* InputManager::_window;
 float InputManager::_aspectRatio = 0.0f;
 int InputManager::_windowSize[2];
 
+// Without a window there is nothing to poll, every key reads as up
+#ifndef NURBS_HEADLESS
 void InputManager::Init(GLFWwindow* window)
 {
 	_window = window;
@@ -44,6 +51,8 @@ void InputManager::Init(GLFWwindow* window)
 
 void InputManager::Update()
 {
+	PROFILE_ZONE("InputManager::Update");
+
 	_prevLeftMouseButton = _leftMouseButton;
 	_leftMouseButton = glfwGetMouseButton(_window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
 	glfwGetCursorPos(_window, &_mousePos[0], &_mousePos[1]);
@@ -82,6 +91,10 @@ void InputManager::Update()
 	_sKey = glfwGetKey(_window, GLFW_KEY_S) == GLFW_PRESS;
 	_prevDKey = _dKey;
 	_dKey = glfwGetKey(_window, GLFW_KEY_D) == GLFW_PRESS;
+	_prevGKey = _gKey;
+	_gKey = glfwGetKey(_window, GLFW_KEY_G) == GLFW_PRESS;
+	_prevPKey = _pKey;
+	_pKey = glfwGetKey(_window, GLFW_KEY_P) == GLFW_PRESS;
 	_prevShiftKey = _shiftKey;
 	_shiftKey = glfwGetKey(_window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS;
 	_prevCtrlKey = _ctrlKey;
@@ -90,6 +103,7 @@ void InputManager::Update()
 	_prevSpaceKey = _spaceKey;
 	_spaceKey = glfwGetKey(_window, GLFW_KEY_SPACE) == GLFW_PRESS;
 }
+#endif
 
 glm::vec2 InputManager::GetMouseCoords()
 {
@@ -110,6 +124,8 @@ bool InputManager::wKey(bool prev) { if (prev) return _prevWKey; else return _wK
 bool InputManager::aKey(bool prev) { if (prev) return _prevAKey; else return _aKey; }
 bool InputManager::sKey(bool prev) { if (prev) return _prevSKey; else return _sKey; }
 bool InputManager::dKey(bool prev) { if (prev) return _prevDKey; else return _dKey; }
+bool InputManager::gKey(bool prev) { if (prev) return _prevGKey; else return _gKey; }
+bool InputManager::pKey(bool prev) { if (prev) return _prevPKey; else return _pKey; }
 bool InputManager::shiftKey(bool prev) { if (prev) return _prevShiftKey; else return _shiftKey; }
 bool InputManager::ctrlKey(bool prev) { if (prev) return _prevCtrlKey; else return _ctrlKey; }
 bool InputManager::spaceKey(bool prev) { if (prev) return _prevSpaceKey; else return _spaceKey; }
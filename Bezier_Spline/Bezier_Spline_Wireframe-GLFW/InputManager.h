@@ -1,7 +1,7 @@
 #pragma once
-#include <GLEW\GL\glew.h>
-#include <GLFW\glfw3.h>
-#include <GLM\glm.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <GLM/glm.hpp>
 
 class InputManager
 {
@@ -23,6 +23,8 @@ public:
 	static bool aKey(bool prev = false);
 	static bool sKey(bool prev = false);
 	static bool dKey(bool prev = false);
+	static bool gKey(bool prev = false);
+	static bool pKey(bool prev = false);
 	static bool shiftKey(bool prev = false);
 	static bool ctrlKey(bool prev = false);
 	static bool spaceKey(bool prev = false);
@@ -50,6 +52,10 @@ private:
 	static bool _prevSKey;
 	static bool _dKey;
 	static bool _prevDKey;
+	static bool _gKey;
+	static bool _prevGKey;
+	static bool _pKey;
+	static bool _prevPKey;
 	static bool _shiftKey;
 	static bool _prevShiftKey;
 	static bool _ctrlKey;
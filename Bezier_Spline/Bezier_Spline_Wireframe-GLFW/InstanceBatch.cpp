@@ -0,0 +1,138 @@
+#include "InstanceBatch.h"
+#include "RenderBackend.h"
+
+#include <cstddef>
+#include <algorithm>
+
+InstanceBatch::InstanceBatch(Shader shader, GLuint vbo, GLuint ebo, RenderShape& templateShape)
+{
+	_shader = shader;
+	_templateVao = templateShape.vao();
+	_count = templateShape.count();
+	_mode = templateShape.mode();
+	_useDepthTest = templateShape.useDepthTest();
+	_rebuild = true;
+
+	RenderBackend& backend = RenderBackend::Get();
+
+	// Same mesh as the template
+	_vao = backend.CreateVertexArray(ebo);
+	backend.VertexAttribute(_vao, vbo, backend.AttribLocation(shader.shaderPointer, "position"), 3, 0, 0);
+
+	// One model matrix and color per instance, a mat4 attribute takes up four consecutive locations
+	_instanceVbo = backend.CreateBuffer(0, NULL, GL_STREAM_DRAW);
+
+	GLint modelAttrib = backend.AttribLocation(shader.shaderPointer, "instanceModel");
+	for (int column = 0; column < 4 && modelAttrib >= 0; ++column)
+	{
+		backend.VertexAttribute(_vao, _instanceVbo, modelAttrib + column, 4, sizeof(Instance), offsetof(Instance, model) + sizeof(glm::vec4) * column, 1);
+	}
+
+	GLint colorAttrib = backend.AttribLocation(shader.shaderPointer, "instanceColor");
+	backend.VertexAttribute(_vao, _instanceVbo, colorAttrib, 4, sizeof(Instance), offsetof(Instance, color), 1);
+}
+InstanceBatch::~InstanceBatch()
+{
+	RenderBackend::Get().DeleteBuffer(_instanceVbo);
+	RenderBackend::Get().DeleteVertexArray(_vao);
+}
+
+void InstanceBatch::Add(RenderShape* shape)
+{
+	_shapes.push_back(shape);
+	_shapeInstances.push_back(-1);
+	_generations.push_back(0);
+	_instances.reserve(_shapes.size());
+	_rebuild = true;
+}
+bool InstanceBatch::Remove(RenderShape* shape)
+{
+	// Searched from the back, shapes tend to go in the reverse order they came in and then this is only a few steps
+	std::vector<RenderShape*>::reverse_iterator found = std::find(_shapes.rbegin(), _shapes.rend(), shape);
+	if (found == _shapes.rend())
+		return false;
+
+	int index = found.base() - 1 - _shapes.begin();
+	_shapes.erase(_shapes.begin() + index);
+	_shapeInstances.erase(_shapeInstances.begin() + index);
+	_generations.erase(_generations.begin() + index);
+	_rebuild = true;
+	return true;
+}
+
+void InstanceBatch::Draw(const glm::mat4& viewProjMat)
+{
+	// A shape turning on or off moves every instance after it
+	unsigned int numShapes = _shapes.size();
+	for (unsigned int i = 0; i < numShapes && !_rebuild; ++i)
+	{
+		_rebuild = _shapes[i]->active() != (_shapeInstances[i] >= 0);
+	}
+
+	// Range of instances to upload
+	int first = 0;
+	int end = 0;
+	if (_rebuild)
+	{
+		_instances.clear();
+		for (unsigned int i = 0; i < numShapes; ++i)
+		{
+			_shapeInstances[i] = -1;
+			if (!_shapes[i]->active()) continue;
+
+			Instance instance;
+			instance.model = _shapes[i]->transform().modelMat();
+			instance.color = _shapes[i]->currentColor();
+			_shapeInstances[i] = _instances.size();
+			_generations[i] = _shapes[i]->transform().generation();
+			_instances.push_back(instance);
+		}
+		end = _instances.size();
+	}
+	else
+	{
+		first = _instances.size();
+		for (unsigned int i = 0; i < numShapes; ++i)
+		{
+			int k = _shapeInstances[i];
+			if (k < 0) continue;
+
+			Transform& transform = _shapes[i]->transform();
+			if (transform.generation() == _generations[i] && _instances[k].color == _shapes[i]->currentColor())
+				continue;
+
+			_instances[k].model = transform.modelMat();
+			_instances[k].color = _shapes[i]->currentColor();
+			_generations[i] = transform.generation();
+			first = std::min(first, k);
+			end = std::max(end, k + 1);
+		}
+	}
+	if (_instances.empty())
+	{
+		_rebuild = false;
+		return;
+	}
+
+	RenderBackend& backend = RenderBackend::Get();
+	backend.DepthTest(_useDepthTest);
+
+	// A rebuild orphans last frame's instances so the driver doesn't have to wait for them to be drawn, otherwise only the
+	// instances that changed are written over
+	if (_rebuild)
+	{
+		backend.BufferData(_instanceVbo, sizeof(Instance) * _instances.size(), NULL, GL_STREAM_DRAW);
+		_rebuild = false;
+	}
+	if (first < end)
+		backend.BufferSubData(_instanceVbo, sizeof(Instance) * first, sizeof(Instance) * (end - first), (void*)&_instances[first]);
+
+	backend.UseProgram(_shader.shaderPointer);
+	backend.Uniform(_shader.uTransform, viewProjMat);
+
+	backend.DrawElementsInstanced(_vao, _mode, _count, _instances.size());
+}
+
+bool InstanceBatch::Matches(RenderShape* shape) { return shape->vao() == _templateVao && shape->mode() == _mode && shape->count() == _count; }
+int InstanceBatch::numInstances() { return _instances.size(); }
+bool InstanceBatch::useDepthTest() { return _useDepthTest; }
@@ -0,0 +1,52 @@
+#pragma once
+#include "RenderShape.h"
+
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <vector>
+
+// Draws every RenderShape that uses the same mesh with a single glDrawElementsInstanced call. The shapes keep their own
+// transform, color and active state, the batch keeps the model matrix and color of the active ones in one instance
+// buffer. Only the instances whose transform or color changed are written again, the whole buffer is only rebuilt when a
+// shape is added, removed, or turned on or off. The shader takes the view-projection matrix in uTransform and reads the
+// per-instance model matrix and color from the instanceModel and instanceColor attributes.
+class InstanceBatch
+{
+public:
+	InstanceBatch(Shader shader, GLuint vbo, GLuint ebo, RenderShape& templateShape);
+	~InstanceBatch();
+
+	void Add(RenderShape* shape);
+	bool Remove(RenderShape* shape);
+	void Draw(const glm::mat4& viewProjMat);
+
+	// A shape belongs in the batch when it draws the same vao the same way as the template
+	bool Matches(RenderShape* shape);
+	int numInstances();
+	bool useDepthTest();
+private:
+	struct Instance
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+	};
+
+	Shader _shader;
+	GLint _templateVao;
+	GLsizei _count;
+	GLenum _mode;
+	bool _useDepthTest;
+
+	GLuint _vao;
+	GLuint _instanceVbo;
+
+	std::vector<RenderShape*> _shapes;
+	std::vector<Instance> _instances;
+
+	// By shape, the instance it was written to or -1 while it is inactive, and the generation of its transform then
+	std::vector<int> _shapeInstances;
+	std::vector<unsigned int> _generations;
+
+	// Set when the instances have to be gathered and uploaded again from scratch
+	bool _rebuild;
+};
@@ -0,0 +1,59 @@
+#include "MultiDrawShape.h"
+#include "GeometryArena.h"
+#include "RenderBackend.h"
+
+MultiDrawShape::MultiDrawShape(GeometryArena* arena, GLenum mode, Shader shader, glm::vec4 color, bool useDepthTest)
+	: RenderShape(0, 0, mode, shader, color, useDepthTest)
+{
+	_arena = arena;
+	_numDraws = 0;
+	_active = true;
+}
+MultiDrawShape::~MultiDrawShape()
+{
+
+}
+
+void MultiDrawShape::Draw()
+{
+	if (!_active || _numDraws == 0)
+		return;
+
+	RenderBackend& backend = RenderBackend::Get();
+
+	// One call per page, every page binds its own vbo and the arena's shared ebo
+	unsigned int numPages = _pages.size();
+	for (unsigned int page = 0; page < numPages; ++page)
+	{
+		DrawList& list = _pages[page];
+		if (list.counts.empty()) continue;
+
+		backend.MultiDrawElements(_arena->vao(page), mode(), &list.counts[0], &list.offsets[0], list.counts.size(), &list.baseVertices[0]);
+	}
+}
+
+void MultiDrawShape::Clear()
+{
+	// Keeps the capacity, so steady frames don't allocate
+	unsigned int numPages = _pages.size();
+	for (unsigned int page = 0; page < numPages; ++page)
+	{
+		_pages[page].counts.clear();
+		_pages[page].offsets.clear();
+		_pages[page].baseVertices.clear();
+	}
+	_numDraws = 0;
+}
+
+void MultiDrawShape::Add(int page, GLsizei count, GLsizeiptr indexOffset, GLint baseVertex)
+{
+	if (page >= (int)_pages.size()) _pages.resize(page + 1);
+
+	DrawList& list = _pages[page];
+	list.counts.push_back(count);
+	list.offsets.push_back((GLvoid*)indexOffset);
+	list.baseVertices.push_back(baseVertex);
+	++_numDraws;
+}
+
+int MultiDrawShape::numDraws() { return _numDraws; }
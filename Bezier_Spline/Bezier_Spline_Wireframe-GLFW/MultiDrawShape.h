@@ -0,0 +1,35 @@
+#pragma once
+#include "RenderShape.h"
+
+#include <GLEW/GL/glew.h>
+#include <vector>
+
+class GeometryArena;
+
+// Draws many index ranges out of a GeometryArena with one glMultiDrawElementsBaseVertex call per page. Every range is
+// drawn with the shape's transform and color, so the grids it collects have to share one model matrix.
+class MultiDrawShape : public RenderShape
+{
+public:
+	MultiDrawShape(GeometryArena* arena, GLenum mode, Shader shader, glm::vec4 color, bool useDepthTest = true);
+	~MultiDrawShape();
+
+	void Draw();
+
+	// Ranges are collected again every frame
+	void Clear();
+	void Add(int page, GLsizei count, GLsizeiptr indexOffset, GLint baseVertex);
+
+	int numDraws();
+private:
+	struct DrawList
+	{
+		std::vector<GLsizei> counts;
+		std::vector<GLvoid*> offsets;
+		std::vector<GLint> baseVertices;
+	};
+
+	GeometryArena* _arena;
+	std::vector<DrawList> _pages;
+	int _numDraws;
+};
@@ -0,0 +1,128 @@
+#include "NurbsBasis.h"
+
+NurbsBasis::NurbsBasis()
+{
+	_degree = 0;
+	_numSamples = 0;
+}
+NurbsBasis::~NurbsBasis()
+{
+
+}
+
+void NurbsBasis::Build(int degree, const std::vector<GLfloat>& knots, int numSamples)
+{
+	_degree = degree;
+	_numSamples = numSamples;
+	_firstControlPoints.resize(numSamples);
+	_values.resize(numSamples * (degree + 1));
+
+	int numControlPoints = knots.size() - degree - 1;
+	GLfloat start = knots[degree];
+	GLfloat end = knots[numControlPoints];
+
+	for (int i = 0; i < numSamples; ++i)
+	{
+		// Exact end points, no accumulated increment
+		GLfloat t = numSamples > 1 ? (GLfloat)i / ((GLfloat)numSamples - 1.0f) : 0.0f;
+		GLfloat u = i == numSamples - 1 ? end : start + (end - start) * t;
+
+		int span = FindSpan(degree, knots, u);
+		_firstControlPoints[i] = span - degree;
+		BasisFunctions(span, u, degree, knots, &_values[i * (degree + 1)]);
+	}
+}
+
+int NurbsBasis::degree() { return _degree; }
+int NurbsBasis::numSamples() { return _numSamples; }
+int NurbsBasis::firstControlPoint(int sample) { return _firstControlPoints[sample]; }
+const GLfloat* NurbsBasis::values(int sample) { return &_values[sample * (_degree + 1)]; }
+
+int NurbsBasis::FindSpan(int degree, const std::vector<GLfloat>& knots, GLfloat u)
+{
+	int n = knots.size() - degree - 2;
+
+	// The end of the range belongs to the last non-empty span
+	if (u >= knots[n + 1]) return n;
+	if (u <= knots[degree]) return degree;
+
+	int low = degree;
+	int high = n + 1;
+	int mid = (low + high) / 2;
+	while (u < knots[mid] || u >= knots[mid + 1])
+	{
+		if (u < knots[mid]) high = mid;
+		else low = mid;
+		mid = (low + high) / 2;
+	}
+	return mid;
+}
+
+void NurbsBasis::BasisFunctions(int span, GLfloat u, int degree, const std::vector<GLfloat>& knots, GLfloat* values)
+{
+	GLfloat left[MAX_DEGREE + 1];
+	GLfloat right[MAX_DEGREE + 1];
+
+	values[0] = 1.0f;
+	for (int j = 1; j <= degree; ++j)
+	{
+		left[j] = u - knots[span + 1 - j];
+		right[j] = knots[span + j] - u;
+		GLfloat saved = 0.0f;
+		for (int r = 0; r < j; ++r)
+		{
+			GLfloat temp = values[r] / (right[r + 1] + left[j - r]);
+			values[r] = saved + right[r + 1] * temp;
+			saved = left[j - r] * temp;
+		}
+		values[j] = saved;
+	}
+}
+
+std::vector<GLfloat> NurbsBasis::UniformKnots(int degree, int numControlPoints)
+{
+	std::vector<GLfloat> knots = std::vector<GLfloat>();
+	knots.reserve(numControlPoints + degree + 1);
+
+	int numInterior = numControlPoints - degree - 1;
+	for (int i = 0; i <= degree; ++i) knots.push_back(0.0f);
+	for (int i = 1; i <= numInterior; ++i) knots.push_back((GLfloat)i / (GLfloat)(numInterior + 1));
+	for (int i = 0; i <= degree; ++i) knots.push_back(1.0f);
+
+	return knots;
+}
+
+int NurbsBasis::ClampDegree(int degree)
+{
+	// Degrees above MAX_DEGREE are never needed for rendering
+	if (degree < 1) return 1;
+	if (degree > MAX_DEGREE) return MAX_DEGREE;
+	return degree;
+}
+
+int NurbsBasis::ClampNumControlPoints(int degree, int numControlPoints)
+{
+	return numControlPoints > degree ? numControlPoints : degree + 1;
+}
+
+GLfloat NurbsBasis::ClampWeight(GLfloat weight)
+{
+	// Also catches NaN
+	const GLfloat MIN_WEIGHT = 1.0e-6f;
+	return weight > MIN_WEIGHT ? weight : MIN_WEIGHT;
+}
+
+bool NurbsBasis::ValidKnots(int degree, int numControlPoints, const std::vector<GLfloat>& knots)
+{
+	if (degree < 1 || degree > MAX_DEGREE || numControlPoints <= degree) return false;
+	if ((int)knots.size() != numControlPoints + degree + 1) return false;
+
+	unsigned int size = knots.size();
+	for (unsigned int i = 1; i < size; ++i)
+	{
+		if (knots[i] < knots[i - 1]) return false;
+	}
+	// FindSpan puts the start of the range in the first span and the end in the last, so neither can be empty. That also
+	// keeps the whole range from being empty.
+	return knots[degree] < knots[degree + 1] && knots[numControlPoints - 1] < knots[numControlPoints];
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+#include <vector>
+
+// B-spline basis functions of one parametric direction, sampled at evenly spaced parameters over the valid knot range.
+// Only the degree + 1 functions that are non-zero at each sample are stored, together with the index of the first control
+// point they weight, so a surface grid evaluates every basis row once instead of once per vertex.
+class NurbsBasis
+{
+public:
+	// Highest degree the basis functions are evaluated for, curves and surfaces clamp theirs to it
+	static const int MAX_DEGREE = 15;
+
+	NurbsBasis();
+	~NurbsBasis();
+
+	void Build(int degree, const std::vector<GLfloat>& knots, int numSamples);
+
+	int degree();
+	int numSamples();
+	int firstControlPoint(int sample);
+	const GLfloat* values(int sample);
+
+	// Index of the knot span [knots[span], knots[span + 1]) holding u
+	static int FindSpan(int degree, const std::vector<GLfloat>& knots, GLfloat u);
+
+	// Cox-de Boor recurrence over the non-zero span only, writes degree + 1 values. degree can't be above MAX_DEGREE.
+	static void BasisFunctions(int span, GLfloat u, int degree, const std::vector<GLfloat>& knots, GLfloat* values);
+
+	// Clamped knot vector with uniformly spaced interior knots, numControlPoints has to be above degree
+	static std::vector<GLfloat> UniformKnots(int degree, int numControlPoints);
+
+	// Keeps degree within [1, MAX_DEGREE], and gives numControlPoints the degree + 1 the degree needs at least
+	static int ClampDegree(int degree);
+	static int ClampNumControlPoints(int degree, int numControlPoints);
+
+	// Keeps a weight above zero, so the homogeneous w a point is divided by never reaches zero
+	static GLfloat ClampWeight(GLfloat weight);
+
+	// A knot vector is usable when it has numControlPoints + degree + 1 non-decreasing entries, and neither the first nor the
+	// last span of the parametric range is empty
+	static bool ValidKnots(int degree, int numControlPoints, const std::vector<GLfloat>& knots);
+private:
+	int _degree;
+	int _numSamples;
+	std::vector<int> _firstControlPoints;
+	std::vector<GLfloat> _values;
+};
@@ -0,0 +1,128 @@
+#include "NurbsCurve.h"
+#include "RenderManager.h"
+#include "RenderShape.h"
+#include "StreamBuffer.h"
+#include "RenderBackend.h"
+
+NurbsCurve::NurbsCurve(Shader shader, int degree, int numControlPoints, int numVerts)
+{
+	_degree = NurbsBasis::ClampDegree(degree);
+	_numControlPoints = NurbsBasis::ClampNumControlPoints(_degree, numControlPoints);
+	_numVerts = numVerts < 2 ? 2 : numVerts;
+
+	// Start out as a straight line along x
+	_controlPoints.resize(_numControlPoints);
+	for (int i = 0; i < _numControlPoints; ++i)
+	{
+		_controlPoints[i] = glm::vec4((GLfloat)i / (GLfloat)(_numControlPoints - 1) - 0.5f, 0.0f, 0.0f, 1.0f);
+	}
+	_knots = NurbsBasis::UniformKnots(_degree, _numControlPoints);
+	_basisDirty = true;
+
+	std::vector<GLuint> elements = std::vector<GLuint>();
+	elements.resize(_numVerts);
+	for (int i = 0; i < _numVerts; ++i)
+	{
+		elements[i] = i;
+	}
+
+	RenderBackend& backend = RenderBackend::Get();
+	_stream = new StreamBuffer(sizeof(GLfloat) * 3, _numVerts);
+	_ebo = backend.CreateBuffer(sizeof(GLuint) * _numVerts, (void*)&elements[0], GL_STATIC_DRAW);
+	_vao = backend.CreateVertexArray(_ebo);
+
+	// Bind buffer data to shader values
+	backend.VertexAttribute(_vao, _stream->vbo(), backend.AttribLocation(shader.shaderPointer, "position"), 3, 0, 0);
+
+	_curve = new RenderShape(_vao, _numVerts, GL_LINE_STRIP, shader);
+	RenderManager::AddShape(_curve);
+
+	_generation = 1;
+	_tessellatedGeneration = 0;
+}
+NurbsCurve::~NurbsCurve()
+{
+	RenderManager::RemoveShape(_curve);
+
+	RenderBackend::Get().DeleteVertexArray(_vao);
+	delete _stream;
+	RenderBackend::Get().DeleteBuffer(_ebo);
+}
+
+void NurbsCurve::Update()
+{
+	if (_generation != _tessellatedGeneration)
+	{
+		UpdateCurve();
+		_tessellatedGeneration = _generation;
+	}
+}
+
+void NurbsCurve::SetControlPoint(int controlPointIndex, glm::vec3 newPos, GLfloat weight)
+{
+	weight = NurbsBasis::ClampWeight(weight);
+	glm::vec4 homogeneous = glm::vec4(newPos * weight, weight);
+	if (_controlPoints[controlPointIndex] != homogeneous)
+	{
+		_controlPoints[controlPointIndex] = homogeneous;
+		++_generation;
+	}
+}
+
+bool NurbsCurve::SetKnots(const std::vector<GLfloat>& knots)
+{
+	if (!NurbsBasis::ValidKnots(_degree, _numControlPoints, knots)) return false;
+	_knots = knots;
+	_basisDirty = true;
+	++_generation;
+	return true;
+}
+
+glm::vec3 NurbsCurve::Evaluate(GLfloat u)
+{
+	GLfloat basis[NurbsBasis::MAX_DEGREE + 1];
+	int span = NurbsBasis::FindSpan(_degree, _knots, u);
+	NurbsBasis::BasisFunctions(span, u, _degree, _knots, basis);
+
+	glm::vec4 point = glm::vec4();
+	for (int k = 0; k <= _degree; ++k)
+	{
+		point += basis[k] * _controlPoints[span - _degree + k];
+	}
+	return glm::vec3(point) / point.w;
+}
+
+Transform& NurbsCurve::transform() { return _curve->transform(); }
+int NurbsCurve::numVerts() { return _numVerts; }
+
+void NurbsCurve::Tessellate(GLfloat* verts)
+{
+	if (_basisDirty)
+	{
+		_basis.Build(_degree, _knots, _numVerts);
+		_basisDirty = false;
+	}
+
+	for (int i = 0; i < _numVerts; ++i)
+	{
+		const GLfloat* n = _basis.values(i);
+		const glm::vec4* controlPoints = &_controlPoints[_basis.firstControlPoint(i)];
+		glm::vec4 point = glm::vec4();
+		for (int k = 0; k <= _degree; ++k)
+		{
+			point += n[k] * controlPoints[k];
+		}
+
+		verts[i * 3] = point.x / point.w;
+		verts[i * 3 + 1] = point.y / point.w;
+		verts[i * 3 + 2] = point.z / point.w;
+	}
+}
+
+void NurbsCurve::UpdateCurve()
+{
+	// Written straight into the buffer the curve is drawn from
+	Tessellate((GLfloat*)_stream->Map());
+	_stream->Unmap(0, sizeof(GLfloat) * _numVerts * 3);
+	_curve->baseVertex(_stream->baseVertex());
+}
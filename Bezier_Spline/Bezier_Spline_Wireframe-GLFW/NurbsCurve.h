@@ -0,0 +1,54 @@
+#pragma once
+#include "RenderShape.h"
+#include "NurbsBasis.h"
+
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <vector>
+
+class RenderShape;
+class StreamBuffer;
+
+// Rational B-spline curve of any degree, drawn as a line strip through the RenderShape/RenderManager path
+class NurbsCurve
+{
+public:
+	// The degree is kept within [1, NurbsBasis::MAX_DEGREE] and there are always at least degree + 1 control points
+	NurbsCurve(Shader shader, int degree, int numControlPoints, int numVerts = 64);
+	~NurbsCurve();
+
+	void Update();
+
+	// Weights are kept above zero
+	void SetControlPoint(int controlPointIndex, glm::vec3 newPos, GLfloat weight = 1.0f);
+	bool SetKnots(const std::vector<GLfloat>& knots);
+
+	glm::vec3 Evaluate(GLfloat u);
+
+	// Writes the numVerts vertices the curve is drawn from to verts
+	void Tessellate(GLfloat* verts);
+
+	Transform& transform();
+	int numVerts();
+private:
+	void UpdateCurve();
+private:
+	int _degree;
+	int _numControlPoints;
+	int _numVerts;
+
+	// Homogeneous control points, (x * w, y * w, z * w, w)
+	std::vector<glm::vec4> _controlPoints;
+	std::vector<GLfloat> _knots;
+
+	NurbsBasis _basis;
+	bool _basisDirty;
+
+	RenderShape* _curve;
+	GLuint _vao;
+	StreamBuffer* _stream;
+	GLuint _ebo;
+
+	unsigned int _generation;
+	unsigned int _tessellatedGeneration;
+};
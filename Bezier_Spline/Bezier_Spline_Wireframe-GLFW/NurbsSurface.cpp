@@ -0,0 +1,181 @@
+#include "NurbsSurface.h"
+#include "RenderManager.h"
+#include "RenderShape.h"
+#include "GridIndexRegistry.h"
+#include "StreamBuffer.h"
+#include "RenderBackend.h"
+
+NurbsSurface::NurbsSurface(Shader shader, int degreeU, int degreeV, int numControlPointsU, int numControlPointsV, int numVerts)
+{
+	_degreeU = NurbsBasis::ClampDegree(degreeU);
+	_degreeV = NurbsBasis::ClampDegree(degreeV);
+	_numControlPointsU = NurbsBasis::ClampNumControlPoints(_degreeU, numControlPointsU);
+	_numControlPointsV = NurbsBasis::ClampNumControlPoints(_degreeV, numControlPointsV);
+	_numVerts = numVerts < 2 ? 2 : numVerts;
+
+	// Start out as a flat unit square in the xz plane
+	_controlPoints.resize(_numControlPointsU * _numControlPointsV);
+	for (int v = 0; v < _numControlPointsV; ++v)
+	{
+		for (int u = 0; u < _numControlPointsU; ++u)
+		{
+			GLfloat x = (GLfloat)u / (GLfloat)(_numControlPointsU - 1) - 0.5f;
+			GLfloat z = (GLfloat)v / (GLfloat)(_numControlPointsV - 1) - 0.5f;
+			_controlPoints[u + v * _numControlPointsU] = glm::vec4(x, 0.0f, z, 1.0f);
+		}
+	}
+	_knotsU = NurbsBasis::UniformKnots(_degreeU, _numControlPointsU);
+	_knotsV = NurbsBasis::UniformKnots(_degreeV, _numControlPointsV);
+	_basisDirty = true;
+
+	_rowPoints.resize(_numControlPointsV);
+	RenderBackend& backend = RenderBackend::Get();
+	_stream = new StreamBuffer(sizeof(GLfloat) * 3, _numVerts * _numVerts);
+
+	// The grid topology is shared with every other surface of the same resolution
+	_vaoTris = backend.CreateVertexArray(GridIndexRegistry::Buffer(_numVerts, GridIndexRegistry::TRIANGLES));
+	_vaoLines = backend.CreateVertexArray(GridIndexRegistry::Buffer(_numVerts, GridIndexRegistry::LINES));
+
+	// Bind buffer data to shader values
+	GLint posAttrib = backend.AttribLocation(shader.shaderPointer, "position");
+	backend.VertexAttribute(_vaoTris, _stream->vbo(), posAttrib, 3, 0, 0);
+	backend.VertexAttribute(_vaoLines, _stream->vbo(), posAttrib, 3, 0, 0);
+
+	_surface = new RenderShape(_vaoTris, GridIndexRegistry::Count(_numVerts, GridIndexRegistry::TRIANGLES), GL_TRIANGLES, shader, glm::vec4(0.6f, 0.6f, 0.6f, 1.0f));
+	_surface->transform().parent(&_transform);
+	RenderManager::AddShape(_surface);
+
+	_surfaceLines = new RenderShape(_vaoLines, GridIndexRegistry::Count(_numVerts, GridIndexRegistry::LINES), GL_LINES, shader, glm::vec4(0.0f, 0.8f, 0.0f, 1.0f), false);
+	_surfaceLines->transform().parent(&_transform);
+	RenderManager::AddShape(_surfaceLines);
+
+	_generation = 1;
+	_tessellatedGeneration = 0;
+	_tessellated = false;
+}
+NurbsSurface::~NurbsSurface()
+{
+	RenderManager::RemoveShape(_surface);
+	RenderManager::RemoveShape(_surfaceLines);
+
+	delete _stream;
+	RenderBackend::Get().DeleteVertexArray(_vaoTris);
+	RenderBackend::Get().DeleteVertexArray(_vaoLines);
+}
+
+void NurbsSurface::Update(float /*dt*/)
+{
+	_tessellated = _generation != _tessellatedGeneration;
+	if (_tessellated)
+	{
+		UpdateSurface();
+		_tessellatedGeneration = _generation;
+	}
+}
+
+void NurbsSurface::SetControlPoint(int u, int v, glm::vec3 newPos, GLfloat weight)
+{
+	weight = NurbsBasis::ClampWeight(weight);
+	glm::vec4 homogeneous = glm::vec4(newPos * weight, weight);
+	if (_controlPoints[u + v * _numControlPointsU] != homogeneous)
+	{
+		_controlPoints[u + v * _numControlPointsU] = homogeneous;
+		++_generation;
+	}
+}
+
+bool NurbsSurface::SetKnotsU(const std::vector<GLfloat>& knots)
+{
+	if (!NurbsBasis::ValidKnots(_degreeU, _numControlPointsU, knots)) return false;
+	_knotsU = knots;
+	_basisDirty = true;
+	++_generation;
+	return true;
+}
+bool NurbsSurface::SetKnotsV(const std::vector<GLfloat>& knots)
+{
+	if (!NurbsBasis::ValidKnots(_degreeV, _numControlPointsV, knots)) return false;
+	_knotsV = knots;
+	_basisDirty = true;
+	++_generation;
+	return true;
+}
+
+glm::vec3 NurbsSurface::Evaluate(GLfloat u, GLfloat v)
+{
+	GLfloat basisU[NurbsBasis::MAX_DEGREE + 1];
+	GLfloat basisV[NurbsBasis::MAX_DEGREE + 1];
+	int spanU = NurbsBasis::FindSpan(_degreeU, _knotsU, u);
+	int spanV = NurbsBasis::FindSpan(_degreeV, _knotsV, v);
+	NurbsBasis::BasisFunctions(spanU, u, _degreeU, _knotsU, basisU);
+	NurbsBasis::BasisFunctions(spanV, v, _degreeV, _knotsV, basisV);
+
+	glm::vec4 point = glm::vec4();
+	for (int l = 0; l <= _degreeV; ++l)
+	{
+		glm::vec4 row = glm::vec4();
+		for (int k = 0; k <= _degreeU; ++k)
+		{
+			row += basisU[k] * _controlPoints[(spanU - _degreeU + k) + (spanV - _degreeV + l) * _numControlPointsU];
+		}
+		point += basisV[l] * row;
+	}
+	return glm::vec3(point) / point.w;
+}
+
+Transform& NurbsSurface::transform() { return _transform; }
+int NurbsSurface::numVerts() { return _numVerts; }
+bool NurbsSurface::tessellated() { return _tessellated; }
+
+void NurbsSurface::Tessellate(GLfloat* verts)
+{
+	// Basis rows only depend on the knots and the sample count
+	if (_basisDirty)
+	{
+		_basisU.Build(_degreeU, _knotsU, _numVerts);
+		_basisV.Build(_degreeV, _knotsV, _numVerts);
+		_basisDirty = false;
+	}
+
+	for (int i = 0; i < _numVerts; ++i)
+	{
+		// Collapse the control net along u, only the columns with non-zero basis values contribute
+		const GLfloat* nu = _basisU.values(i);
+		int firstU = _basisU.firstControlPoint(i);
+		for (int l = 0; l < _numControlPointsV; ++l)
+		{
+			const glm::vec4* column = &_controlPoints[firstU + l * _numControlPointsU];
+			glm::vec4 rowPoint = glm::vec4();
+			for (int k = 0; k <= _degreeU; ++k)
+			{
+				rowPoint += nu[k] * column[k];
+			}
+			_rowPoints[l] = rowPoint;
+		}
+
+		for (int j = 0; j < _numVerts; ++j)
+		{
+			const GLfloat* nv = _basisV.values(j);
+			int firstV = _basisV.firstControlPoint(j);
+			glm::vec4 point = glm::vec4();
+			for (int l = 0; l <= _degreeV; ++l)
+			{
+				point += nv[l] * _rowPoints[firstV + l];
+			}
+
+			// Back from homogeneous coordinates
+			verts[(j + (i * _numVerts)) * 3] = point.x / point.w;
+			verts[(j + (i * _numVerts)) * 3 + 1] = point.y / point.w;
+			verts[(j + (i * _numVerts)) * 3 + 2] = point.z / point.w;
+		}
+	}
+}
+
+void NurbsSurface::UpdateSurface()
+{
+	// Written straight into the buffer the surface is drawn from
+	Tessellate((GLfloat*)_stream->Map());
+	_stream->Unmap(0, sizeof(GLfloat) * _numVerts * _numVerts * 3);
+	_surface->baseVertex(_stream->baseVertex());
+	_surfaceLines->baseVertex(_stream->baseVertex());
+}
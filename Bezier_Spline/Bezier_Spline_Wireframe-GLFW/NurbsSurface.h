@@ -0,0 +1,68 @@
+#pragma once
+#include "RenderShape.h"
+#include "NurbsBasis.h"
+
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <vector>
+
+class RenderShape;
+class StreamBuffer;
+
+// Rational B-spline surface of any degree. Drawn through the same RenderShape/RenderManager path as Patch, as a filled
+// surface and a wireframe, and only re-tessellated when its control points, weights or knots change.
+class NurbsSurface
+{
+public:
+	// Both degrees are kept within [1, NurbsBasis::MAX_DEGREE] and each direction has at least degree + 1 control points
+	NurbsSurface(Shader shader, int degreeU, int degreeV, int numControlPointsU, int numControlPointsV, int numVerts = 32);
+	~NurbsSurface();
+
+	void Update(float dt);
+
+	// Control point (u, v) is stored at u + v * numControlPointsU, weights are kept above zero
+	void SetControlPoint(int u, int v, glm::vec3 newPos, GLfloat weight = 1.0f);
+	bool SetKnotsU(const std::vector<GLfloat>& knots);
+	bool SetKnotsV(const std::vector<GLfloat>& knots);
+
+	glm::vec3 Evaluate(GLfloat u, GLfloat v);
+
+	// Writes the grid the surface is drawn from to verts, numVerts * numVerts vertices with (i, j) at (j + i * numVerts) * 3
+	void Tessellate(GLfloat* verts);
+
+	Transform& transform();
+	int numVerts();
+	bool tessellated();
+private:
+	void UpdateSurface();
+private:
+	int _degreeU;
+	int _degreeV;
+	int _numControlPointsU;
+	int _numControlPointsV;
+	int _numVerts;
+
+	// Homogeneous control points, (x * w, y * w, z * w, w)
+	std::vector<glm::vec4> _controlPoints;
+	std::vector<GLfloat> _knotsU;
+	std::vector<GLfloat> _knotsV;
+
+	NurbsBasis _basisU;
+	NurbsBasis _basisV;
+	bool _basisDirty;
+
+	// Control points collapsed along u for the current row of the grid
+	std::vector<glm::vec4> _rowPoints;
+
+	RenderShape* _surface;
+	RenderShape* _surfaceLines;
+	GLuint _vaoTris;
+	GLuint _vaoLines;
+	StreamBuffer* _stream;
+
+	Transform _transform;
+
+	unsigned int _generation;
+	unsigned int _tessellatedGeneration;
+	bool _tessellated;
+};
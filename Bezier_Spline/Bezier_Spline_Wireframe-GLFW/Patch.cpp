@@ -3,85 +3,56 @@
 #include "RenderShape.h"
 #include "Init_Shader.h"
 #include "InputManager.h"
+#include "BezierEvaluator.h"
+#include "BasisCache.h"
+#include "CameraManager.h"
+#include "GridIndexRegistry.h"
+#include "StreamBuffer.h"
+#include "GeometryArena.h"
+#include "MultiDrawShape.h"
 
 #include <vector>
+#include <algorithm>
+#include <cstring>
 
-Patch::Patch(RenderShape& markerTemplate, RenderShape& slopeLineTemplate)
+Patch::Patch(RenderShape& markerTemplate, RenderShape& slopeLineTemplate, GeometryArena* arena, int maxLevel, bool helperShapes)
 {
-	_transform = Transform();
-	_transform.position = glm::vec3();
-	_transform.rotation = glm::quat();
-	_transform.scale = glm::vec3(1.0f, 1.0f, 1.0f);
-
-	_transform.angularVelocity = glm::quat();
-	_transform.linearVelocity = glm::vec3();
-
-	_transform.rotationOrigin = glm::vec3();
-	_transform.scaleOrigin = glm::vec3();
-
-	GLfloat data = 0.0f;
-	GLint elements = 0;
-	
-	glGenVertexArrays(1, &_vaoTris);
-	glBindVertexArray(_vaoTris);
-
-	glGenBuffers(1, &_vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat), &data, GL_DYNAMIC_DRAW);
-
-	glGenBuffers(1, &_eboTris);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _eboTris);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLint), &elements, GL_DYNAMIC_DRAW);
-
-	// Bind buffer data to shader values
-	GLint posAttrib = glGetAttribLocation(slopeLineTemplate.shader().shaderPointer, "position");
-	glEnableVertexAttribArray(posAttrib);
-	glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-	_curve = new RenderShape(_vaoTris, NUM_ELEMENTS, GL_TRIANGLES, slopeLineTemplate.shader(), glm::vec4(0.6f, 0.6f, 0.6f, 1.0f));
-
-	_curve->transform().parent = &_transform;
-	
-	RenderManager::AddShape(_curve);
-	
-	// Add the wireframe for the patch as its own render shape
-	glGenVertexArrays(1, &_vaoLines);
-	glBindVertexArray(_vaoLines);
-
-	//glGenBuffers(1, &_vboLines);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-
-	glGenBuffers(1, &_eboLines);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _eboLines);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLint), &elements, GL_DYNAMIC_DRAW);
-	
-	// Bind buffer data to shader values
-	GLint posAttribLines = glGetAttribLocation(slopeLineTemplate.shader().shaderPointer, "position");
-	glEnableVertexAttribArray(posAttribLines);
-	glVertexAttribPointer(posAttribLines, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	
-	_curveLines = new RenderShape(_vaoLines, NUM_LINE_ELEMENTS, GL_LINES, slopeLineTemplate.shader(), glm::vec4(0.0f, 0.8f, 0.0f, 1.0f), false);
-
-	_curveLines->transform().parent = &_transform;
-
-	RenderManager::AddShape(_curveLines);
+	// Everything the finest level needs up front, so picking another level only changes how much of it is used
+	_maxLevel = std::min(std::max(maxLevel, 0), PatchLod::NUM_LEVELS - 1);
+	int maxVerts = PatchLod::LevelVerts(_maxLevel);
+	_arena = arena;
+	_stream = _arena->Allocate(maxVerts * maxVerts);
+	_verts[0].resize(maxVerts * maxVerts * 3);
+	_verts[1].resize(maxVerts * maxVerts * 3);
+
+	for (int level = 0; level < PatchLod::NUM_LEVELS; ++level)
+	{
+		_basis[level] = BasisCache::Bernstein(3, PatchLod::LevelVerts(level));
+	}
 
+	_helperShapes = helperShapes;
 	for (int i = 0; i < 16; ++i)
 	{
+		_controlPointMarkers[i] = NULL;
+		if (!_helperShapes) continue;
+
 		_controlPointMarkers[i] = new RenderShape(markerTemplate);
-		_controlPointMarkers[i]->transform().scale = glm::vec3(0.01f, 0.01f, 0.01f);
-		_controlPointMarkers[i]->transform().position = _controlPoints[i];
+		_controlPointMarkers[i]->transform().scale(glm::vec3(0.01f, 0.01f, 0.01f));
+		_controlPointMarkers[i]->transform().position(_controlPoints[i]);
 
-		_controlPointMarkers[i]->transform().parent = &_curve->transform();
+		_controlPointMarkers[i]->transform().parent(&_transform);
 
 		RenderManager::AddShape(_controlPointMarkers[i]);
 	}
 
 	for (int i = 0; i < 8; ++i)
 	{
+		_slopeLines[i] = NULL;
+		if (!_helperShapes) continue;
+
 		_slopeLines[i] = new RenderShape(slopeLineTemplate);
 
-		_slopeLines[i]->transform().parent = &_curve->transform();
+		_slopeLines[i]->transform().parent(&_transform);
 
 		RenderManager::AddShape(_slopeLines[i]);
 	}
@@ -89,44 +60,198 @@ Patch::Patch(RenderShape& markerTemplate, RenderShape& slopeLineTemplate)
 	_controlPointsActive = true;
 	_wireframeActive = true;
 	_baseActive = true;
+	_welded = false;
+	_borrowedRows[0] = _borrowedRows[1] = false;
+	_tessellatedBorrowedRows[0] = _tessellatedBorrowedRows[1] = false;
+
+	_generation = 1;
+	_tessellatedGeneration = 0;
+	_tessellated = false;
+
+	_level = 0;
+	_tessellatedLevel = 0;
+	_uploadedLevel = -1;
+	_frontVerts = 0;
+	for (int edge = 0; edge < NUM_EDGES; ++edge)
+	{
+		_edgeLevels[edge] = -1;
+		_tessellatedEdgeLevels[edge] = -1;
+	}
 
 	GeneratePlane();
 }
 Patch::~Patch()
 {
-	glDeleteBuffers(1, &_vbo);
-	glDeleteBuffers(1, &_vaoTris);
-	glDeleteBuffers(1, &_vaoLines);
-	glDeleteBuffers(1, &_eboTris);
-	glDeleteBuffers(1, &_eboLines);
+	_arena->Free(_stream);
+	if (!_helperShapes)
+		return;
+
+	for (int i = 0; i < 16; ++i)
+	{
+		RenderManager::RemoveShape(_controlPointMarkers[i]);
+	}
+	for (int i = 0; i < 8; ++i)
+	{
+		RenderManager::RemoveShape(_slopeLines[i]);
+	}
 }
 
-void Patch::Update(float dt)
+void Patch::Update(float /*dt*/)
 {
-		UpdateShapes();
+	UpdateShapes();
+}
+
+void Patch::SelectLevel()
+{
+	// Pick the level of detail from the size of the patch on screen this frame
+	_level = std::min(PatchLod::SelectLevel(_controlPoints, CameraManager::ViewProjMat() * _transform.modelMat()), _maxLevel);
+	for (int edge = 0; edge < NUM_EDGES; ++edge)
+	{
+		_edgeLevels[edge] = -1;
+	}
+}
+
+void Patch::Tessellate()
+{
+	if (BeginTessellate())
+	{
+		EvaluateRows(0, numRows());
+		EndTessellate();
+	}
+	Upload();
+}
+
+bool Patch::BeginTessellate()
+{
+	bool edgesChanged = false;
+	for (int edge = 0; edge < NUM_EDGES; ++edge)
+	{
+		edgesChanged = edgesChanged || _edgeLevels[edge] != _tessellatedEdgeLevels[edge];
+	}
+
+	// A row that stops being borrowed was never evaluated
+	bool borrowedRows[2] = { _welded && _borrowedRows[0], _welded && _borrowedRows[1] };
+	edgesChanged = edgesChanged || (_tessellatedBorrowedRows[0] && !borrowedRows[0]) || (_tessellatedBorrowedRows[1] && !borrowedRows[1]);
 
-		_transform.position += _transform.linearVelocity * dt;
-		_transform.rotation = glm::slerp(_transform.rotation, _transform.rotation * _transform.angularVelocity, dt);
+	// Nothing moved and no level changed since the last tessellation, the surface is still valid
+	_tessellated = _generation != _tessellatedGeneration || _level != _tessellatedLevel || edgesChanged;
+	if (!_tessellated)
+		return false;
 
-		glm::mat4 translateMat = glm::translate(glm::mat4(), _transform.position);
+	// Updates and control point changes made while it is evaluated don't reach it
+	_tessellatedGeneration = _generation;
+	_tessellatedLevel = _level;
+	for (int edge = 0; edge < NUM_EDGES; ++edge)
+	{
+		_tessellatedEdgeLevels[edge] = _edgeLevels[edge];
+	}
+	_tessellatedBorrowedRows[0] = borrowedRows[0];
+	_tessellatedBorrowedRows[1] = borrowedRows[1];
+	for (int i = 0; i < 16; ++i)
+	{
+		_tessellatedControlPoints[i] = _controlPoints[i];
+	}
+	return true;
+}
 
-		glm::mat4 rotateOriginMat = glm::translate(glm::mat4(), _transform.rotationOrigin);
-		glm::mat4 rotateMat = rotateOriginMat * glm::mat4_cast(_transform.rotation) * glm::inverse(rotateOriginMat);
+void Patch::EvaluateRows(int firstRow, int numRows)
+{
+	int numVerts = PatchLod::LevelVerts(_tessellatedLevel);
+	if (_tessellatedBorrowedRows[0] && firstRow == 0)
+	{
+		++firstRow;
+		--numRows;
+	}
+	if (_tessellatedBorrowedRows[1] && firstRow + numRows == numVerts)
+	{
+		--numRows;
+	}
+	if (numRows <= 0)
+		return;
 
-		glm::mat4 scaleOriginMat = glm::translate(glm::mat4(), _transform.scaleOrigin);
-		glm::mat4 scaleMat = scaleOriginMat * glm::scale(glm::mat4(), _transform.scale) * glm::inverse(scaleOriginMat);
+	BezierEvaluator::EvaluatePatchRows(_tessellatedControlPoints, _basis[_tessellatedLevel], BezierEvaluator::Stride(numVerts),
+		numVerts, firstRow, numRows, &_verts[1 - _frontVerts][0]);
+}
 
-		glm::mat4 *parentModelMat = _transform.parent ? &_transform.parent->modelMat : &glm::mat4();
+void Patch::EndTessellate()
+{
+	StitchEdges();
+}
 
-		_transform.modelMat = (*parentModelMat) * (translateMat * scaleMat* rotateMat);
+void Patch::Upload()
+{
+	if (_tessellated) UploadSurface();
+}
+
+void Patch::QueueDraws(MultiDrawShape& surface, MultiDrawShape& wireframe)
+{
+	// Welded patches are drawn by their B_Spline, and a patch that was never uploaded has nothing to draw yet
+	if (_welded || _uploadedLevel < 0)
+		return;
+
+	int numVerts = PatchLod::LevelVerts(_uploadedLevel);
+	int page = _arena->page(_stream);
+	GLint baseVertex = _stream->baseVertex();
+	if (_baseActive)
+		surface.Add(page, _arena->indexCount(numVerts, GridIndexRegistry::TRIANGLES), _arena->indexOffset(numVerts, GridIndexRegistry::TRIANGLES), baseVertex);
+	if (_wireframeActive)
+		wireframe.Add(page, _arena->indexCount(numVerts, GridIndexRegistry::LINES), _arena->indexOffset(numVerts, GridIndexRegistry::LINES), baseVertex);
 }
 
 void Patch::SetControlPoint(int controlPointIndex, glm::vec3 newPos)
 {
-	_controlPointMarkers[controlPointIndex]->transform().position = newPos;
+	if (_controlPoints[controlPointIndex] != newPos)
+	{
+		_controlPoints[controlPointIndex] = newPos;
+		++_generation;
+	}
+	if (_helperShapes) _controlPointMarkers[controlPointIndex]->transform().position(newPos);
 }
 
 Transform& Patch::transform() { return _transform; }
+unsigned int Patch::generation() { return _generation; }
+bool Patch::tessellated() { return _tessellated; }
+int Patch::level() { return _level; }
+void Patch::level(int newLevel) { _level = std::min(newLevel, _maxLevel); }
+int Patch::numRows() { return PatchLod::LevelVerts(_tessellatedLevel); }
+bool Patch::uploaded() { return _uploadedLevel >= 0; }
+int Patch::numTriangles() { return GridIndexRegistry::Count(PatchLod::LevelVerts(_level), GridIndexRegistry::TRIANGLES) / 3; }
+
+void Patch::welded(bool newWelded)
+{
+	if (newWelded != _welded)
+	{
+		_welded = newWelded;
+
+		// The patch's own block went stale while it was welded
+		_tessellatedLevel = -1;
+		_uploadedLevel = -1;
+	}
+}
+void Patch::borrowedRows(bool first, bool last)
+{
+	_borrowedRows[0] = first;
+	_borrowedRows[1] = last;
+}
+const GLfloat* Patch::verts() { return &_verts[_frontVerts][0]; }
+bool Patch::baseActive() { return _baseActive; }
+bool Patch::wireframeActive() { return _wireframeActive; }
+
+const glm::vec3* Patch::controlPoints() { return _controlPoints; }
+
+void Patch::EdgeControlPoints(int edge, glm::vec3* controlPoints)
+{
+	for (int k = 0; k < 4; ++k)
+	{
+		controlPoints[k] = _controlPoints[PatchTopology::EdgeControlPoint(edge, k)];
+	}
+}
+
+void Patch::edgeLevel(int edge, int newLevel)
+{
+	_edgeLevels[edge] = newLevel < _level ? newLevel : _level;
+}
+int Patch::edgeLevel(int edge) { return _edgeLevels[edge]; }
 
 void  Patch::UpdateShapes()
 {
@@ -145,132 +270,138 @@ void  Patch::UpdateShapes()
 			_baseActive = _wireframeActive = _controlPointsActive = true;
 	}
 
-	_curveLines->active() = _wireframeActive;
-	_curve->active() = _baseActive;
+	// Control points only move through SetControlPoint
+	if (!_helperShapes)
+		return;
 
 	for (int i = 0; i < 16; ++i)
 	{
-		_controlPoints[i] = _controlPointMarkers[i]->transform().position;
 		_controlPointMarkers[i]->active() = _controlPointsActive;
+		if (_controlPoints[i] != _controlPointMarkers[i]->transform().position())
+		{
+			_controlPoints[i] = _controlPointMarkers[i]->transform().position();
+			++_generation;
+		}
 	}
 
-	// Update Lines
-
-	std::vector<int> startVec = std::vector<int>();
-	startVec.reserve(8);
-	std::vector<int> endVec = std::vector<int>();
-	endVec.reserve(8);
-
-	// Front
-	startVec.push_back(0);
-	endVec.push_back(1);
-
-	startVec.push_back(2);
-	endVec.push_back(3);
-
-	// Back
-	startVec.push_back(14);
-	endVec.push_back(15);
-
-	startVec.push_back(12);
-	endVec.push_back(13);
-
-	// Left
-	startVec.push_back(3);
-	endVec.push_back(7);
+	for (int i = 0; i < 8; ++i)
+	{
+		_slopeLines[i]->active() = _controlPointsActive;
+	}
 
-	startVec.push_back(11);
-	endVec.push_back(15);
+	// Nothing moved since the last tessellation, the slope lines are still valid
+	if (_generation == _tessellatedGeneration)
+		return;
 
-	// Right
-	startVec.push_back(0);
-	endVec.push_back(4);
+	// Update Lines
 
-	startVec.push_back(8);
-	endVec.push_back(12);
+	// Control points at either end of each slope line, right, left, back and front
+	const int LINE_STARTS[8] = { 8, 0, 11, 3, 12, 14, 2, 0 };
+	const int LINE_ENDS[8] = { 12, 4, 15, 7, 13, 15, 3, 1 };
 
 	glm::vec3 startingVec = glm::vec3(0.7071f, 0.7071f, 1.0f);
 
-	int itr = 0;
-
-	while (!startVec.empty())
+	for (int itr = 0; itr < 8; ++itr)
 	{
-		glm::vec3 start = _controlPoints[startVec.back()];
-		startVec.pop_back();
-		glm::vec3 end = _controlPoints[endVec.back()];
-		endVec.pop_back();
+		glm::vec3 start = _controlPoints[LINE_STARTS[itr]];
+		glm::vec3 end = _controlPoints[LINE_ENDS[itr]];
 
 		glm::vec3 line = end - start;
 
-		_slopeLines[itr]->transform().position = (start + end) / 2.0f;
+		_slopeLines[itr]->transform().position((start + end) / 2.0f);
 
 		float angle = acosf(glm::dot(line, startingVec) / glm::length(line) / 1.414213f);
 		glm::vec3 axis = glm::cross(line, startingVec);
 
-		_slopeLines[itr]->transform().rotation = glm::angleAxis(angle, axis);
-
-		_slopeLines[itr]->transform().scale = line / 2.0f;
+		_slopeLines[itr]->transform().rotation(glm::angleAxis(angle, axis));
 
-		_slopeLines[itr]->active() = _controlPointsActive;
+		_slopeLines[itr]->transform().scale(line / 2.0f);
+	}
+}
 
-		++itr;
+void Patch::StitchEdges()
+{
+	int numVerts = PatchLod::LevelVerts(_tessellatedLevel);
+	for (int edge = 0; edge < NUM_EDGES; ++edge)
+	{
+		if (_tessellatedEdgeLevels[edge] >= 0) StitchEdge(edge, numVerts);
 	}
-	// Update the curve
-	UpdateSurface();
 }
 
-void Patch::UpdateSurface()
+void Patch::UploadSurface()
 {
-	GLfloat  inc = 1.0f / ((float)NUM_VERTS - 1.0f);
-	GLfloat t = 0.0f;
+	_frontVerts = 1 - _frontVerts;
+	if (_welded)
+		return;
+
+	// Stitching reads the grid back, so it is built in _verts and copied into the stream buffer in one go
+	int numVerts = PatchLod::LevelVerts(_tessellatedLevel);
+	GLsizeiptr numBytes = sizeof(GLfloat) * numVerts * numVerts * 3;
+	memcpy(_stream->Map(), &_verts[_frontVerts][0], numBytes);
+	_stream->Unmap(0, numBytes);
+	_uploadedLevel = _tessellatedLevel;
+}
 
-	GLfloat factors[NUM_VERTS][4];
+void Patch::StitchEdge(int edge, int numVerts)
+{
+	glm::vec3 controlPoints[4];
+	for (int k = 0; k < 4; ++k)
+	{
+		controlPoints[k] = _tessellatedControlPoints[PatchTopology::EdgeControlPoint(edge, k)];
+	}
 
-	for (int i = 0; i < NUM_VERTS; ++i, t += inc)
+	// Always sample the curve from the same end, so both patches sharing the edge compute bit-identical points
+	const glm::vec3& first = controlPoints[0];
+	const glm::vec3& last = controlPoints[3];
+	bool reversed = last.x < first.x || (last.x == first.x && (last.y < first.y || (last.y == first.y && last.z < first.z)));
+	if (reversed)
 	{
-		GLfloat t_sqr = t * t;
-		GLfloat t_inv = (1 - t);
-		GLfloat t_inv_sqr = t_inv * t_inv;
-
-		factors[i][0] = t_inv * t_inv_sqr;
-		factors[i][1] = 3 * t * t_inv_sqr;
-		factors[i][2] = 3 * t_sqr * t_inv;
-		factors[i][3] = t * t_sqr;
+		std::swap(controlPoints[0], controlPoints[3]);
+		std::swap(controlPoints[1], controlPoints[2]);
 	}
-	
-	glm::vec3 newControlPoints[4];
-	for (int i = 0; i < NUM_VERTS; ++i)
+
+	int edgeVerts = PatchLod::LevelVerts(_tessellatedEdgeLevels[edge]);
+	const GLfloat* basis = _basis[_tessellatedEdgeLevels[edge]];
+	int stride = BezierEvaluator::Stride(edgeVerts);
+
+	glm::vec3 edgePoints[PatchLod::MAX_VERTS];
+	for (int m = 0; m < edgeVerts; ++m)
 	{
-		newControlPoints[0] = factors[i][0] * _controlPoints[0] + factors[i][1] * _controlPoints[1] + factors[i][2] * _controlPoints[2] + factors[i][3] * _controlPoints[3];
-		newControlPoints[1] = factors[i][0] * _controlPoints[4] + factors[i][1] * _controlPoints[5] + factors[i][2] * _controlPoints[6] + factors[i][3] * _controlPoints[7];
-		newControlPoints[2] = factors[i][0] * _controlPoints[8] + factors[i][1] * _controlPoints[9] + factors[i][2] * _controlPoints[10] + factors[i][3] * _controlPoints[11];
-		newControlPoints[3] = factors[i][0] * _controlPoints[12] + factors[i][1] * _controlPoints[13] + factors[i][2] * _controlPoints[14] + factors[i][3] * _controlPoints[15];
-		for (int j = 0; j < NUM_VERTS; ++j)
-		{
-			glm::vec3 newPoint = factors[j][0] * newControlPoints[0] + factors[j][1] * newControlPoints[1] + factors[j][2] * newControlPoints[2] + factors[j][3] * newControlPoints[3];
-			_verts[(j + (i * NUM_VERTS)) * 3] = newPoint.x;
-			_verts[(j + (i * NUM_VERTS)) * 3 + 1] = newPoint.y;
-			_verts[(j + (i * NUM_VERTS)) * 3 + 2] = newPoint.z;
-		}
+		edgePoints[reversed ? edgeVerts - 1 - m : m] =
+			(basis[m] * controlPoints[0] + basis[stride + m] * controlPoints[1]) +
+			(basis[stride * 2 + m] * controlPoints[2] + basis[stride * 3 + m] * controlPoints[3]);
+	}
+
+	// Vertices between the neighbour's samples are moved onto the straight segments it draws
+	int step = (numVerts - 1) / (edgeVerts - 1);
+	for (int k = 0; k < numVerts; ++k)
+	{
+		int m = k / step;
+		int r = k % step;
+		glm::vec3 point = r == 0 ? edgePoints[m] : glm::mix(edgePoints[m], edgePoints[m + 1], (GLfloat)r / (GLfloat)step);
+
+		int vertNum = EdgeVertex(edge, k, numVerts);
+		GLfloat* verts = &_verts[1 - _frontVerts][0];
+		verts[vertNum * 3] = point.x;
+		verts[vertNum * 3 + 1] = point.y;
+		verts[vertNum * 3 + 2] = point.z;
 	}
-	glBindBuffer(GL_VERTEX_ARRAY, _vaoTris);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(_verts), (void*)&_verts, GL_DYNAMIC_DRAW);
 }
 
-void Patch::GeneratePlane()
+int Patch::EdgeVertex(int edge, int k, int numVerts)
 {
-	// Allocate vertices for the plane
-	int vertNum = 0;
-	GLfloat numVertsf = (GLfloat)NUM_VERTS;
-	for (GLfloat i = 0.0f; i < numVertsf; i += 1.0f)
+	// Vertex (i, j) lives at j + i * numVerts, i runs along the rows of control points
+	switch (edge)
 	{
-		for (GLfloat j = 0.0f; j < numVertsf; j += 1.0f)
-		{
-			AddVert(0.0f, 0.0f, 0.0f, i / (numVertsf - 1.0f), j / (numVertsf - 1.0f), vertNum++);
-		}
+	case 0: return k * numVerts;
+	case 1: return k * numVerts + numVerts - 1;
+	case 2: return k;
+	default: return (numVerts - 1) * numVerts + k;
 	}
+}
 
+void Patch::GeneratePlane()
+{
 	int cp = 0;
 	float zOffset = 1.0f / 3.0f;
 	float xOffset = 1.0f / 3.0f;
@@ -283,47 +414,11 @@ void Patch::GeneratePlane()
 		_controlPoints[cp++] = glm::vec3(baseVec.x + xOffset * 3, baseVec.y, baseVec.z + zOffset * row);
 	}
 
-	// Add elements for faces
-	int faceNum = 0;
-	int quadsPerRow = NUM_VERTS * (NUM_VERTS - 1);
-	for (int i = 0; i < quadsPerRow; i += NUM_VERTS)
+	// Drawn until the first Tessellate, which still counts the plane as out of date
+	for (int i = 0; i < 16; ++i)
 	{
-		for (int j = 0; j < NUM_VERTS - 1; ++j)
-		{
-			AddFace(i + j, i + j + 1, i + NUM_VERTS + j, faceNum++);
-			AddFace(i + j + 1, i + NUM_VERTS + j + 1, i + NUM_VERTS + j, faceNum++);
-		}
+		_tessellatedControlPoints[i] = _controlPoints[i];
 	}
-	glBindBuffer(GL_VERTEX_ARRAY, _vaoTris);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _eboTris);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_elements), (void*)&_elements, GL_DYNAMIC_DRAW);
-
-	glBindBuffer(GL_VERTEX_ARRAY, _vaoLines);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _eboLines);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_lineElements), (void*)&_lineElements, GL_DYNAMIC_DRAW);
-
-	UpdateSurface();
-}
-
-void Patch::AddVert(GLfloat x, GLfloat y, GLfloat z, GLfloat u, GLfloat v, int vertNum)
-{
-	_verts[vertNum * 3] = x;
-	_verts[vertNum * 3 + 1] = y;
-	_verts[vertNum * 3 + 2] = z;
-}
-
-void Patch::AddFace(GLint a, GLint b, GLint c, int faceNum)
-{
-	_elements[faceNum * 3] = a;
-	_elements[faceNum * 3 + 1] = b;
-	_elements[faceNum * 3 + 2] = c;
-
-	_lineElements[faceNum * 6] = a;
-	_lineElements[faceNum * 6 + 1] = b;
-
-	_lineElements[faceNum * 6 + 2] = b;
-	_lineElements[faceNum * 6 + 3] = c;
-
-	_lineElements[faceNum * 6 + 4] = c;
-	_lineElements[faceNum * 6 + 5] = a;
+	EvaluateRows(0, numRows());
+	UploadSurface();
 }
@@ -1,52 +1,128 @@
 #pragma once
 #include "RenderShape.h"
+#include "PatchLod.h"
+#include "PatchTopology.h"
 
-#include <GLEW\GL\glew.h>
-#include <GLM\gtc\matrix_transform.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
 #include <vector>
 
 class RenderShape;
+class StreamBuffer;
+class GeometryArena;
+class MultiDrawShape;
 
 class Patch
 {
 public:
-	Patch(RenderShape& markerTemplate, RenderShape& slopeLineTemplate);
+	// The surface's vertices live in a block of the arena, drawn together with every other patch of the B_Spline. The block
+	// and both halves of the vertices are sized for maxLevel when the patch is made, and the patch is never drawn finer, so
+	// changing level never reallocates. Without helper shapes there are no control point markers or slope lines, only the
+	// surface and its wireframe.
+	Patch(RenderShape& markerTemplate, RenderShape& slopeLineTemplate, GeometryArena* arena, int maxLevel, bool helperShapes = true);
 	~Patch();
 
+	// Moves the patch and picks its level of detail, the surface is only rebuilt by Tessellate
 	void Update(float dt);
+	// Once the transforms are updated, the level is picked from the model matrix
+	void SelectLevel();
+	void Tessellate();
+
+	// Tessellate in steps, for evaluating many patches on the TaskPool. BeginTessellate says whether the surface has to be
+	// rebuilt and takes a copy of the control points and levels to build it from, then every row goes through EvaluateRows
+	// once and EndTessellate stitches the edges. Those two only touch the copy and the back half of the vertices, so they
+	// may run on other threads and even overlap the next Update. Upload swaps the halves and hands the new surface to the
+	// gpu on the context's thread.
+	bool BeginTessellate();
+	void EvaluateRows(int firstRow, int numRows);
+	void EndTessellate();
+	void Upload();
+	int numRows();
+
+	// Whether the patch's block holds a surface it can draw
+	bool uploaded();
+
+	// Adds the index ranges of the current tessellation to the shapes that draw every patch
+	void QueueDraws(MultiDrawShape& surface, MultiDrawShape& wireframe);
 
 	void SetControlPoint(int controlPointIndex, glm::vec3 newPos);
 	Transform& transform();
+	unsigned int generation();
+	bool tessellated();
+	int level();
+	void level(int newLevel);
+	int numTriangles();
+
+	// Welded patches still tessellate but leave drawing the surface to their B_Spline
+	void welded(bool newWelded);
+	// Rows along the u = 0 and u = 1 edges whose vertices a welded B_Spline takes from other patches, left unevaluated
+	// while the patch is welded
+	void borrowedRows(bool first, bool last);
+	const GLfloat* verts();
+	bool baseActive();
+	bool wireframeActive();
+
+	const glm::vec3* controlPoints();
+
+	// Edges of the parameter square: v = 0, v = 1, u = 0 and u = 1
+	static const int NUM_EDGES = PatchTopology::NUM_EDGES;
+	void EdgeControlPoints(int edge, glm::vec3* controlPoints);
+
+	// Samples an edge shared with a neighbour at the given level instead of the patch's own, reset every Update
+	void edgeLevel(int edge, int newLevel);
+	int edgeLevel(int edge);
+
+	// Index in the vertex grid of the k-th vertex along an edge
+	static int EdgeVertex(int edge, int k, int numVerts);
 private:
 	void UpdateShapes();
-	void UpdateSurface();
+	void StitchEdges();
+	void UploadSurface();
 	void GeneratePlane();
-	void AddVert(GLfloat x, GLfloat y, GLfloat z, GLfloat u, GLfloat v, int vertNum);
-	void AddFace(GLint a, GLint b, GLint c, int faceNum);
+	void StitchEdge(int edge, int numVerts);
 private:
 	glm::vec3 _controlPoints[16];
+	bool _helperShapes;
 	RenderShape* _controlPointMarkers[16];
 	RenderShape* _slopeLines[8];
-	RenderShape* _curve;
-	RenderShape* _curveLines;
-	GLuint _vaoTris;
-	GLuint _vaoLines;
-	GLuint _vbo;
-	GLuint _eboTris;
-	GLuint _eboLines;
+	GeometryArena* _arena;
+	StreamBuffer* _stream;
 
 	Transform _transform;
 
-	static const int NUM_VERTS = 10;
-	static const int NUM_VERTS_STORED = NUM_VERTS * NUM_VERTS * 3;
-	static const int NUM_ELEMENTS = (NUM_VERTS - 1) * (NUM_VERTS - 1) * 6;
-	static const int NUM_LINE_ELEMENTS = NUM_ELEMENTS * 2;
+	// Shared with every other patch, owned by BasisCache
+	const GLfloat* _basis[PatchLod::NUM_LEVELS];
+
+	// Double buffered, verts() and the uploads read the front half while the next tessellation is evaluated into the back.
+	// Both halves and the arena block have room for _maxLevel.
+	std::vector<GLfloat> _verts[2];
+	int _frontVerts;
+
+	// Finest level the patch is drawn at
+	int _maxLevel;
+
+	// What BeginTessellate took the last tessellation from
+	glm::vec3 _tessellatedControlPoints[16];
 
-	GLfloat _verts[NUM_VERTS_STORED];
-	GLuint _elements[NUM_ELEMENTS];
-	GLuint _lineElements[NUM_LINE_ELEMENTS];
+	// Bumped whenever a control point changes, the surface is only re-tessellated when it differs from _tessellatedGeneration
+	unsigned int _generation;
+	unsigned int _tessellatedGeneration;
+	bool _tessellated;
+
+	// Level picked this frame, the level of the last tessellation and the level the block currently holds
+	int _level;
+	int _tessellatedLevel;
+	int _uploadedLevel;
+
+	// Level each edge is sampled at, -1 when it isn't shared with another patch
+	int _edgeLevels[NUM_EDGES];
+	int _tessellatedEdgeLevels[NUM_EDGES];
 
 	bool _controlPointsActive;
 	bool _wireframeActive;
 	bool _baseActive;
+	bool _welded;
+
+	bool _borrowedRows[2];
+	bool _tessellatedBorrowedRows[2];
 };
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "PatchTopology.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	struct CellKey
+	{
+		long long q[3];
+
+		bool operator==(const CellKey& other) const
+		{
+			return q[0] == other.q[0] && q[1] == other.q[1] && q[2] == other.q[2];
+		}
+	};
+
+	size_t Mix(size_t hash, long long value)
+	{
+		unsigned long long bits = (unsigned long long)value * 0x9E3779B97F4A7C15ULL;
+		return (hash ^ (size_t)(bits ^ (bits >> 32))) * 16777619u;
+	}
+
+	struct CellKeyHash
+	{
+		size_t operator()(const CellKey& key) const
+		{
+			size_t hash = 2166136261u;
+			for (int i = 0; i < 3; ++i) hash = Mix(hash, key.q[i]);
+			return hash;
+		}
+	};
+
+	// Edges are hashed by the welded corner vertices at their ends, lower one first
+	size_t EdgeHash(int firstVertex, int lastVertex)
+	{
+		return Mix(Mix(2166136261u, firstVertex), lastVertex);
+	}
+
+	// Cells are twice the tolerance across, so a point can only match points in its own cell or, along each axis, the
+	// neighbouring cell on the side it is nearer to
+	CellKey Cell(const glm::vec3& point, double invCellSize)
+	{
+		CellKey key;
+		for (int i = 0; i < 3; ++i) key.q[i] = (long long)std::floor(point[i] * invCellSize);
+		return key;
+	}
+
+	const int EDGE_CONTROL_POINTS[4][4] = {
+		{ 0, 1, 2, 3 },
+		{ 12, 13, 14, 15 },
+		{ 0, 4, 8, 12 },
+		{ 3, 7, 11, 15 }
+	};
+
+	const int CORNER_CONTROL_POINTS[4] = { 0, 3, 12, 15 };
+
+	// Corners at the first and last control point of each edge
+	const int EDGE_CORNERS[4][2] = {
+		{ 0, 1 },
+		{ 2, 3 },
+		{ 0, 2 },
+		{ 1, 3 }
+	};
+
+	// Slots of the hash tables, an edge that found its partner stays behind so the probing past it carries on
+	const int EMPTY = -1;
+	const int MATCHED = -2;
+
+	// Empties table with room for twice count, a power of two so a slot is the hash masked
+	size_t ResetTable(std::vector<int>& table, int count)
+	{
+		size_t size = 16;
+		while (size < (size_t)count * 2) size *= 2;
+		table.assign(size, EMPTY);
+		return size - 1;
+	}
+
+	bool Near(const glm::vec3& a, const glm::vec3& b, GLfloat tolerance)
+	{
+		glm::vec3 d = a - b;
+		return glm::dot(d, d) <= tolerance * tolerance;
+	}
+
+	// Whether the four points of two edges are within tolerance of each other, in the same order or in opposite ones
+	bool EdgesMatch(const glm::vec3* patchPoints, int edge, const glm::vec3* otherPoints, int otherEdge, GLfloat tolerance, bool& reversed)
+	{
+		for (int direction = 0; direction < 2; ++direction)
+		{
+			bool match = true;
+			for (int k = 0; k < 4 && match; ++k)
+			{
+				int otherK = direction == 0 ? k : 3 - k;
+				match = Near(patchPoints[EDGE_CONTROL_POINTS[edge][k]], otherPoints[EDGE_CONTROL_POINTS[otherEdge][otherK]], tolerance);
+			}
+			if (match)
+			{
+				reversed = direction == 1;
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+PatchTopology::PatchTopology()
+{
+	_numPatches = 0;
+	_numCornerVertices = 0;
+	_numSharedEdges = 0;
+	_numDegenerateEdges = 0;
+}
+PatchTopology::~PatchTopology()
+{
+
+}
+
+void PatchTopology::Build(const std::vector<glm::vec3>& controlPoints, GLfloat tolerance, GLfloat degenerateTolerance)
+{
+	_numPatches = controlPoints.size() / 16;
+	_numCornerVertices = 0;
+	_numSharedEdges = 0;
+	_numDegenerateEdges = 0;
+
+	int numEdges = _numPatches * NUM_EDGES;
+	_neighbours.assign(numEdges, -1);
+	_reversed.assign(numEdges, false);
+	_degenerate.assign(numEdges, false);
+	_cornerVertices.assign(_numPatches * NUM_CORNERS, -1);
+
+	GLfloat cellSize = tolerance * 2.0f;
+	double invCellSize = 1.0 / cellSize;
+
+	// Every interior edge is seen twice, so the first sighting waits in the table for its partner. The tables hold edge and
+	// corner indices, the cells and welded vertices they are keyed by are found again when a probe needs to compare them.
+	size_t edgeMask = ResetTable(_openEdges, numEdges);
+	size_t cornerMask = ResetTable(_corners, _numPatches * NUM_CORNERS);
+
+	for (int patch = 0; patch < _numPatches; ++patch)
+	{
+		const glm::vec3* patchPoints = &controlPoints[patch * 16];
+
+		// Corners first, the edges are keyed by the welded vertices at their ends
+		for (int corner = 0; corner < NUM_CORNERS; ++corner)
+		{
+			int cornerIndex = patch * NUM_CORNERS + corner;
+			const glm::vec3& point = patchPoints[CORNER_CONTROL_POINTS[corner]];
+			CellKey key = Cell(point, invCellSize);
+
+			// The own cell and the neighbours on the nearer side of each axis, up to 8 cells
+			int step[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				step[i] = point[i] * invCellSize - (double)key.q[i] < 0.5 ? -1 : 1;
+			}
+
+			int match = -1;
+			size_t ownSlot = 0;
+			for (int neighbour = 0; neighbour < 8 && match < 0; ++neighbour)
+			{
+				CellKey cell = key;
+				for (int i = 0; i < 3; ++i)
+				{
+					if (neighbour & (1 << i)) cell.q[i] += step[i];
+				}
+
+				size_t slot = CellKeyHash()(cell) & cornerMask;
+				while (_corners[slot] != EMPTY)
+				{
+					int other = _corners[slot];
+					const glm::vec3& otherPoint = controlPoints[(other / NUM_CORNERS) * 16 + CORNER_CONTROL_POINTS[other % NUM_CORNERS]];
+					if (Cell(otherPoint, invCellSize) == cell && Near(point, otherPoint, tolerance))
+					{
+						match = other;
+						break;
+					}
+					slot = (slot + 1) & cornerMask;
+				}
+				if (neighbour == 0) ownSlot = slot;
+			}
+
+			if (match < 0)
+			{
+				// Probing the own cell stopped at the empty slot it goes in, unless a neighbour's probe filled it since
+				while (_corners[ownSlot] != EMPTY) ownSlot = (ownSlot + 1) & cornerMask;
+				_corners[ownSlot] = cornerIndex;
+				_cornerVertices[cornerIndex] = _numCornerVertices++;
+			}
+			else
+			{
+				_cornerVertices[cornerIndex] = _cornerVertices[match];
+			}
+		}
+
+		for (int edge = 0; edge < NUM_EDGES; ++edge)
+		{
+			int edgeIndex = patch * NUM_EDGES + edge;
+
+			const glm::vec3& first = patchPoints[EDGE_CONTROL_POINTS[edge][0]];
+			GLfloat extent = 0.0f;
+			for (int k = 1; k < 4; ++k)
+			{
+				extent = glm::max(extent, glm::distance(patchPoints[EDGE_CONTROL_POINTS[edge][k]], first));
+			}
+
+			if (extent <= degenerateTolerance)
+			{
+				_degenerate[edgeIndex] = true;
+				++_numDegenerateEdges;
+				continue;
+			}
+
+			// Edges sharing both end vertices are compared point by point, the ends alone don't decide the middle
+			int firstVertex = _cornerVertices[patch * NUM_CORNERS + EDGE_CORNERS[edge][0]];
+			int lastVertex = _cornerVertices[patch * NUM_CORNERS + EDGE_CORNERS[edge][1]];
+			if (lastVertex < firstVertex) std::swap(firstVertex, lastVertex);
+
+			size_t slot = EdgeHash(firstVertex, lastVertex) & edgeMask;
+			int other = -1;
+			bool reversed = false;
+			while (_openEdges[slot] != EMPTY)
+			{
+				int candidate = _openEdges[slot];
+				if (candidate != MATCHED)
+				{
+					int candidatePatch = candidate / NUM_EDGES;
+					int candidateEdge = candidate % NUM_EDGES;
+					int candidateFirst = _cornerVertices[candidatePatch * NUM_CORNERS + EDGE_CORNERS[candidateEdge][0]];
+					int candidateLast = _cornerVertices[candidatePatch * NUM_CORNERS + EDGE_CORNERS[candidateEdge][1]];
+					if (candidateLast < candidateFirst) std::swap(candidateFirst, candidateLast);
+
+					if (candidateFirst == firstVertex && candidateLast == lastVertex &&
+						EdgesMatch(patchPoints, edge, &controlPoints[candidatePatch * 16], candidateEdge, tolerance, reversed))
+					{
+						other = candidate;
+						_openEdges[slot] = MATCHED;
+						break;
+					}
+				}
+				slot = (slot + 1) & edgeMask;
+			}
+
+			if (other < 0)
+			{
+				_openEdges[slot] = edgeIndex;
+				continue;
+			}
+
+			_neighbours[edgeIndex] = other;
+			_neighbours[other] = edgeIndex;
+			_reversed[edgeIndex] = _reversed[other] = reversed;
+			++_numSharedEdges;
+		}
+	}
+}
+
+int PatchTopology::numPatches() { return _numPatches; }
+
+int PatchTopology::neighbour(int patch, int edge) { return _neighbours[patch * NUM_EDGES + edge]; }
+bool PatchTopology::reversed(int patch, int edge) { return _reversed[patch * NUM_EDGES + edge]; }
+bool PatchTopology::degenerate(int patch, int edge) { return _degenerate[patch * NUM_EDGES + edge]; }
+
+int PatchTopology::cornerVertex(int patch, int corner) { return _cornerVertices[patch * NUM_CORNERS + corner]; }
+int PatchTopology::numCornerVertices() { return _numCornerVertices; }
+
+int PatchTopology::numSharedEdges() { return _numSharedEdges; }
+int PatchTopology::numDegenerateEdges() { return _numDegenerateEdges; }
+int PatchTopology::numBoundaryEdges() { return _numPatches * NUM_EDGES - _numSharedEdges * 2 - _numDegenerateEdges; }
+
+int PatchTopology::EdgeControlPoint(int edge, int k) { return EDGE_CONTROL_POINTS[edge][k]; }
+int PatchTopology::CornerControlPoint(int corner) { return CORNER_CONTROL_POINTS[corner]; }
@@ -0,0 +1,61 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+#include <GLM/glm.hpp>
+#include <vector>
+
+// Connectivity of a set of bicubic patches, found by hashing their boundary control points.
+// Edges are numbered like Patch's, v = 0, v = 1, u = 0 and u = 1, and corners are control points 0, 3, 12 and 15.
+// Corners are hashed into cells twice the tolerance across and compared by distance against the points in their own cell
+// and the neighbouring cells they lie nearest to, so points either side of a cell boundary still weld. Edges are hashed by
+// the welded vertices at their ends, and two edges are shared when their four control points lie within tolerance of
+// each other in either direction. An edge whose four points all
+// lie within degenerateTolerance of each other is degenerate (the apex of the teapot lid, which the data set nudges apart
+// slightly) and corners that coincide share one corner vertex.
+class PatchTopology
+{
+public:
+	static const int NUM_EDGES = 4;
+	static const int NUM_CORNERS = 4;
+
+	PatchTopology();
+	~PatchTopology();
+
+	// The control points of patch p are controlPoints[p * 16] to controlPoints[p * 16 + 15]. Points no further apart than
+	// tolerance are treated as the same point.
+	void Build(const std::vector<glm::vec3>& controlPoints, GLfloat tolerance = 0.0001f, GLfloat degenerateTolerance = 0.005f);
+
+	int numPatches();
+
+	// patch * NUM_EDGES + edge of the edge on the other side, or -1 on a boundary or degenerate edge
+	int neighbour(int patch, int edge);
+	// True when the neighbour runs through the shared control points in the opposite order
+	bool reversed(int patch, int edge);
+	bool degenerate(int patch, int edge);
+
+	// Welded index of a corner, shared by every patch meeting there
+	int cornerVertex(int patch, int corner);
+	int numCornerVertices();
+
+	int numSharedEdges();
+	int numDegenerateEdges();
+	int numBoundaryEdges();
+
+	// Index into the 16 control points of the k-th point along an edge, and of a corner
+	static int EdgeControlPoint(int edge, int k);
+	static int CornerControlPoint(int corner);
+private:
+	std::vector<int> _neighbours;
+	std::vector<bool> _reversed;
+	std::vector<bool> _degenerate;
+	std::vector<int> _cornerVertices;
+
+	// Open addressed hash tables of the edges waiting for a partner and the first patch corner seen at each vertex, kept
+	// between builds so rebuilding the same topology doesn't allocate
+	std::vector<int> _openEdges;
+	std::vector<int> _corners;
+
+	int _numPatches;
+	int _numCornerVertices;
+	int _numSharedEdges;
+	int _numDegenerateEdges;
+};
@@ -1,11 +1,27 @@
 #include "RenderManager.h"
 #include "RenderShape.h"
+#include "RenderQueue.h"
+#include "TransformManager.h"
+#include "InstanceBatch.h"
+#include "RenderBackend.h"
 #include "Init_Shader.h"
 #include "InputManager.h"
-#include <GLM\gtc\random.hpp>
+#include "Profiler.h"
+#include "TaskPool.h"
+#include <GLM/gtc/random.hpp>
+#include <algorithm>
 
 std::vector<RenderShape*> RenderManager::_shapes = std::vector<RenderShape*>();
 std::vector<RenderShape*> RenderManager::_noDepthShapes = std::vector<RenderShape*>();
+std::vector<InstanceBatch*> RenderManager::_batches = std::vector<InstanceBatch*>();
+RenderQueue RenderManager::_queue = RenderQueue();
+std::vector<RenderManager::ProgramUniforms> RenderManager::_programUniforms = std::vector<RenderManager::ProgramUniforms>();
+glm::mat4 RenderManager::_uniformsViewProjMat = glm::mat4();
+int RenderManager::_numStateChanges = 0;
+int RenderManager::_numStateChangesSaved = 0;
+float RenderManager::_owedDt = 0.0f;
+bool RenderManager::_motionOwed = false;
+bool RenderManager::_motionPipelined = false;
 
 void RenderManager::AddShape(Shader shader, GLuint vao, GLenum type, GLsizei count, glm::vec4 color, Transform transform)
 {
@@ -15,41 +31,253 @@ void RenderManager::AddShape(Shader shader, GLuint vao, GLenum type, GLsizei cou
 
 void RenderManager::AddShape(RenderShape* shape)
 {
+	unsigned int numBatches = _batches.size();
+	for (unsigned int i = 0; i < numBatches; ++i)
+	{
+		if (_batches[i]->Matches(shape))
+		{
+			_batches[i]->Add(shape);
+			return;
+		}
+	}
+
 	if (shape->useDepthTest())
 	{
 		_shapes.push_back(shape);
-		_shapes[_shapes.size() - 1]->transform() = shape->transform();
 	}
 	else
 	{
 		_noDepthShapes.push_back(shape);
-		_noDepthShapes[_noDepthShapes.size() - 1]->transform() = shape->transform();
+	}
+}
+
+void RenderManager::AddBatch(InstanceBatch* batch)
+{
+	_batches.push_back(batch);
+}
+
+void RenderManager::RemoveShape(RenderShape* shape)
+{
+	// Another shape may be made at the same address
+	for (unsigned int i = 0; i < _programUniforms.size(); ++i)
+	{
+		if (_programUniforms[i].shape == shape) _programUniforms[i].shape = NULL;
+	}
+
+	std::vector<RenderShape*>* lists[] = { &_shapes, &_noDepthShapes };
+	for (int i = 0; i < 2; ++i)
+	{
+		std::vector<RenderShape*>::iterator found = std::find(lists[i]->begin(), lists[i]->end(), shape);
+		if (found != lists[i]->end())
+		{
+			lists[i]->erase(found);
+			delete shape;
+			return;
+		}
+	}
+
+	unsigned int numBatches = _batches.size();
+	for (unsigned int i = 0; i < numBatches; ++i)
+	{
+		if (_batches[i]->Remove(shape))
+		{
+			delete shape;
+			return;
+		}
 	}
 }
 
 void RenderManager::Update(float dt)
 {
-	unsigned int numShapes = _shapes.size();
-	for (unsigned int i = 0; i < numShapes; ++i)
+	PROFILE_ZONE("RenderManager::Update");
+
+	// Once a job has taken the motion, the next one launched this frame takes it again
+	_owedDt += dt;
+	_motionOwed = true;
+	if (!_motionPipelined) IntegrateOwed();
+}
+
+bool RenderManager::SnapshotMotion()
+{
+	// Update leaves the motion owed from the next frame on, even when there is none to take yet
+	_motionPipelined = true;
+	if (!_motionOwed)
+		return false;
+
+	// The last job is done with the snapshot once it has returned
+	TaskPool::Wait();
+	TransformManager::ApplySnapshot();
+	TransformManager::Snapshot(_owedDt);
+	_owedDt = 0.0f;
+	_motionOwed = false;
+	return true;
+}
+
+void RenderManager::IntegrateMotion()
+{
+	PROFILE_ZONE("RenderManager::IntegrateMotion");
+	TaskPool::ParallelFor(TransformManager::numSnapshot(), MOTION_GRAIN_SIZE, [](int begin, int end) { TransformManager::IntegrateSnapshot(begin, end); });
+}
+
+void RenderManager::ApplyMotion()
+{
+	TransformManager::ApplySnapshot();
+}
+
+void RenderManager::IntegrateOwed()
+{
+	float dt = _owedDt;
+	_owedDt = 0.0f;
+	_motionOwed = false;
+
+	// Only the transforms with a velocity are integrated, on the pool unless a job has it
+	if (TaskPool::jobPending())
 	{
-		_shapes[i]->Update(dt);
+		TransformManager::Integrate(dt);
+		return;
 	}
+	TransformManager::ApplySnapshot();
+	TaskPool::ParallelFor(TransformManager::numMoving(), MOTION_GRAIN_SIZE, [dt](int begin, int end) { TransformManager::Integrate(dt, begin, end); });
 }
 
 void RenderManager::Draw(glm::mat4& viewProjMat)
 {
+	PROFILE_ZONE("RenderManager::Draw");
+
+	// Motion no job took this frame is integrated here, and from the next frame on by Update again
+	if (_motionOwed)
+	{
+		_motionPipelined = false;
+		IntegrateOwed();
+	}
+
+	// Every shape only reads its model matrix, whatever moved since the last frame is rebuilt here in parent order
+	TransformManager::Update();
+
+	// Shapes without the depth test are their own pass after the rest, so they still draw over everything
+	_queue.Clear();
 	unsigned int numShapes = _shapes.size();
 	for (unsigned int i = 0; i < numShapes; ++i)
 	{
-		_shapes[i]->Draw(viewProjMat);
+		if (_shapes[i]->active()) Submit(_shapes[i], 0, i);
 	}
 	unsigned int numNoDepthShapes = _noDepthShapes.size();
 	for (unsigned int i = 0; i < numNoDepthShapes; ++i)
 	{
-		_noDepthShapes[i]->Draw(viewProjMat);
+		if (_noDepthShapes[i]->active()) Submit(_noDepthShapes[i], 1, numShapes + i);
+	}
+	_queue.Sort();
+
+	// Every matrix was built with the old view-projection, the values the programs hold are still right
+	if (viewProjMat != _uniformsViewProjMat)
+	{
+		_uniformsViewProjMat = viewProjMat;
+		for (unsigned int i = 0; i < _programUniforms.size(); ++i)
+		{
+			_programUniforms[i].shape = NULL;
+		}
+	}
+
+	// Only what differs from the draw before is set, a draw needing the same state as the last one sets none of it.
+	// The vao is bound by the draw call itself, sorting only lines up the draws that share one so the backend can
+	// leave out binding it again.
+	RenderBackend& backend = RenderBackend::Get();
+	GLint program = backend.program();
+	GLint currentProgram = program;
+	bool currentDepthTest = false;
+	_numStateChanges = 0;
+	int numDraws = _queue.size();
+	for (int i = 0; i < numDraws; ++i)
+	{
+		int index = _queue.index(i);
+		RenderShape* shape = index < (int)numShapes ? _shapes[index] : _noDepthShapes[index - numShapes];
+
+		if (i == 0 || shape->useDepthTest() != currentDepthTest)
+		{
+			currentDepthTest = shape->useDepthTest();
+			backend.DepthTest(currentDepthTest);
+			++_numStateChanges;
+		}
+		GLint shapeProgram = shape->shader().shaderPointer;
+		if (shapeProgram != currentProgram)
+		{
+			currentProgram = shapeProgram;
+			backend.UseProgram(currentProgram);
+			++_numStateChanges;
+		}
+
+		SetUniforms(shape, viewProjMat);
+		shape->Draw();
+	}
+
+	// Against setting the depth test, program and both uniforms for every draw
+	_numStateChangesSaved = numDraws * 4 - _numStateChanges;
+
+	// Batches bring their own shader, put back the one that was in use before the frame
+	unsigned int numBatches = _batches.size();
+	for (unsigned int i = 0; i < numBatches; ++i)
+	{
+		_batches[i]->Draw(viewProjMat);
+	}
+	backend.UseProgram(program);
+}
+
+int RenderManager::numStateChanges() { return _numStateChanges; }
+int RenderManager::numStateChangesSaved() { return _numStateChangesSaved; }
+
+void RenderManager::Submit(RenderShape* shape, int pass, int index)
+{
+	_queue.Submit(pass, shape->shader().shaderPointer, shape->vao(), shape->mode(), index);
+}
+
+void RenderManager::SetUniforms(RenderShape* shape, const glm::mat4& viewProjMat)
+{
+	RenderBackend& backend = RenderBackend::Get();
+	Shader shader = shape->shader();
+	ProgramUniforms& uniforms = Uniforms(shader.shaderPointer);
+
+	Transform& transform = shape->transform();
+	if (uniforms.shape != shape || uniforms.generation != transform.generation())
+	{
+		// Shapes that share a parent's transform often come out with the same matrix
+		glm::mat4 transformMat = viewProjMat * transform.modelMat();
+		if (transformMat != uniforms.transform)
+		{
+			backend.Uniform(shader.uTransform, transformMat);
+			uniforms.transform = transformMat;
+			++_numStateChanges;
+		}
+		uniforms.shape = shape;
+		uniforms.generation = transform.generation();
+	}
+
+	if (shape->currentColor() != uniforms.color)
+	{
+		backend.Uniform(shader.uColor, shape->currentColor());
+		uniforms.color = shape->currentColor();
+		++_numStateChanges;
 	}
 }
 
+RenderManager::ProgramUniforms& RenderManager::Uniforms(GLint program)
+{
+	// Only a handful of programs, and the draws are sorted by program so the last one found is usually the one
+	for (unsigned int i = _programUniforms.size(); i > 0; --i)
+	{
+		if (_programUniforms[i - 1].program == program) return _programUniforms[i - 1];
+	}
+
+	// A program nothing has been set on yet holds zeroes, so the first draw with it sends both unless they are zero too
+	ProgramUniforms uniforms;
+	uniforms.program = program;
+	uniforms.transform = glm::mat4(0.0f);
+	uniforms.color = glm::vec4(0.0f);
+	uniforms.shape = NULL;
+	uniforms.generation = 0;
+	_programUniforms.push_back(uniforms);
+	return _programUniforms.back();
+}
+
 void RenderManager::DumpData()
 {
 	unsigned int i;
@@ -58,5 +286,14 @@ void RenderManager::DumpData()
 		delete _shapes[i - 1];
 		_shapes.pop_back();
 	}
+	while (!_batches.empty())
+	{
+		delete _batches.back();
+		_batches.pop_back();
+	}
+	_programUniforms.clear();
+	_owedDt = 0.0f;
+	_motionOwed = false;
+	_motionPipelined = false;
 }
 
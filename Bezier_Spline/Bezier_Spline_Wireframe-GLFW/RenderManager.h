@@ -1,27 +1,85 @@
 #pragma once
-#include <GLEW\GL\glew.h>
-#include <GLM\gtc\matrix_transform.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+#include "RenderQueue.h"
 #include <vector>
 
-struct Transform;
+class Transform;
 struct Shader;
 class RenderShape;
+class InstanceBatch;
 
 class RenderManager
 {
 public:
 	static void AddShape(Shader shader, GLuint vao, GLenum type, GLsizei count, glm::vec4 color, Transform transform);
 	
+	// Shapes that match a batch are drawn instanced with it instead of on their own
 	static void AddShape(RenderShape* shape);
+	static void AddBatch(InstanceBatch* batch);
 
+	// Takes a shape out of whichever list or batch holds it and deletes it
+	static void RemoveShape(RenderShape* shape);
+
+	// Moves the transforms that have a velocity, every shape in one go rather than shape by shape
 	static void Update(float dt);
 
+	// Pipelined frames move the transforms on the job B_Spline launches. SnapshotMotion is called right before launching it
+	// and hands the job the motion owed since the last one, returning false when there is none. IntegrateMotion runs on the
+	// job, and ApplyMotion adds its result to the transforms once the job has returned. From then on Update leaves the
+	// motion owed, until a frame launches no job and Draw integrates what is owed itself.
+	static bool SnapshotMotion();
+	static void IntegrateMotion();
+	static void ApplyMotion();
+
+	// Draws the shapes sorted by the state they need, then the batches. The transform and color uniforms of the programs the
+	// shapes use are only ever set here, so what was set last is known and a value a program already holds isn't sent again.
 	static void Draw(glm::mat4& viewProjMat);
 
+	// Depth test, program and uniform changes the last Draw made, and how many fewer that was than setting all four for
+	// every shape
+	static int numStateChanges();
+	static int numStateChangesSaved();
+
 	static void DumpData();
 
 private:
+	// Queues a shape under the index it has in _shapes, or in _noDepthShapes past the end of _shapes
+	static void Submit(RenderShape* shape, int pass, int index);
+
+	// What a program's transform and color uniforms were last set to, and the shape and transform generation the transform
+	// was built from. The same shape with the same generation under the same view-projection skips building its matrix.
+	struct ProgramUniforms
+	{
+		GLint program;
+		glm::mat4 transform;
+		glm::vec4 color;
+		RenderShape* shape;
+		unsigned int generation;
+	};
+
+	// Sets the uniforms shape needs that its program doesn't hold already
+	static void SetUniforms(RenderShape* shape, const glm::mat4& viewProjMat);
+	static ProgramUniforms& Uniforms(GLint program);
+
+	// Adds a snapshot a job is done with and integrates the motion owed on the pool, or on this thread while a job runs
+	static void IntegrateOwed();
+
+	// Moving transforms per chunk of the motion pass
+	static const int MOTION_GRAIN_SIZE = 4096;
 
 	static std::vector<RenderShape*> _shapes;
 	static std::vector<RenderShape*> _noDepthShapes;
+	static std::vector<InstanceBatch*> _batches;
+
+	static RenderQueue _queue;
+	static std::vector<ProgramUniforms> _programUniforms;
+	static glm::mat4 _uniformsViewProjMat;
+	static int _numStateChanges;
+	static int _numStateChangesSaved;
+
+	// Time passed since the motion was last integrated or handed to a job, and whether the last frame's was handed to one
+	static float _owedDt;
+	static bool _motionOwed;
+	static bool _motionPipelined;
 };
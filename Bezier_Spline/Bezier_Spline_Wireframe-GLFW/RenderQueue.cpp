@@ -0,0 +1,61 @@
+#include "RenderQueue.h"
+
+void RenderQueue::Clear()
+{
+	_keys.clear();
+}
+
+void RenderQueue::Submit(int pass, GLint program, GLint vao, GLenum mode, int index)
+{
+	Key key = (Key)pass << PASS_SHIFT;
+	key |= (Key)(program & 0x3fff) << PROGRAM_SHIFT;
+	key |= (Key)(vao & 0xffff) << VAO_SHIFT;
+	key |= (Key)(mode & 0xff) << MODE_SHIFT;
+	key |= (Key)index & (MAX_DRAWS - 1);
+	_keys.push_back(key);
+}
+
+void RenderQueue::Sort()
+{
+	unsigned int numKeys = _keys.size();
+	if (numKeys < 2)
+		return;
+
+	// Every histogram in one pass over the keys, one per byte from the mode up
+	const int NUM_DIGITS = 5;
+	unsigned int counts[NUM_DIGITS][256] = {};
+	for (unsigned int i = 0; i < numKeys; ++i)
+	{
+		Key key = _keys[i];
+		for (int digit = 0; digit < NUM_DIGITS; ++digit)
+		{
+			++counts[digit][(key >> (MODE_SHIFT + digit * 8)) & 0xff];
+		}
+	}
+
+	_sorted.resize(numKeys);
+	for (int digit = 0; digit < NUM_DIGITS; ++digit)
+	{
+		// A byte every key shares would leave them where they are
+		int shift = MODE_SHIFT + digit * 8;
+		if (counts[digit][(_keys[0] >> shift) & 0xff] == numKeys)
+			continue;
+
+		unsigned int offsets[256];
+		unsigned int offset = 0;
+		for (int bucket = 0; bucket < 256; ++bucket)
+		{
+			offsets[bucket] = offset;
+			offset += counts[digit][bucket];
+		}
+		for (unsigned int i = 0; i < numKeys; ++i)
+		{
+			Key key = _keys[i];
+			_sorted[offsets[(key >> shift) & 0xff]++] = key;
+		}
+		_keys.swap(_sorted);
+	}
+}
+
+int RenderQueue::size() { return _keys.size(); }
+int RenderQueue::index(int i) { return (int)(_keys[i] & (MAX_DRAWS - 1)); }
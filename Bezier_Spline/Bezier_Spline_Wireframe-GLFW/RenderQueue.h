@@ -0,0 +1,35 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+#include <vector>
+
+// Orders a frame's draws by the state they need, so consecutive draws share as much of it as possible. Each draw is one
+// 64 bit key, from the top: the pass, the shader program, the vao, the primitive mode and the index it was submitted
+// with. The keys are radix sorted a byte at a time, lowest byte first, and only on the bytes above the index, so draws
+// needing the same state stay in the order they were submitted. A handle too large for its bits only sorts less well.
+class RenderQueue
+{
+public:
+	// Passes are drawn in ascending order, whatever else they need
+	static const int NUM_PASSES = 4;
+	// Largest index a draw can be submitted with, plus one
+	static const int MAX_DRAWS = 1 << 24;
+
+	void Clear();
+	void Submit(int pass, GLint program, GLint vao, GLenum mode, int index);
+	void Sort();
+
+	int size();
+	// Index the i-th draw was submitted with, in sorted order once Sort has run
+	int index(int i);
+private:
+	typedef unsigned long long Key;
+
+	static const int PASS_SHIFT = 62;
+	static const int PROGRAM_SHIFT = 48;
+	static const int VAO_SHIFT = 32;
+	static const int MODE_SHIFT = 24;
+
+	std::vector<Key> _keys;
+	// Keys being sorted into, kept so sorting a frame allocates nothing once the queue has grown to fit it
+	std::vector<Key> _sorted;
+};
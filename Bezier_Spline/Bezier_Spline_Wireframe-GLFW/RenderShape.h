@@ -1,41 +1,10 @@
 #pragma once
 
-#include <GLEW\GL\glew.h>
-#include <GLM\gtc\matrix_transform.hpp>
-#include <GLM\gtc\quaternion.hpp>
-#include <GLM\gtc\type_ptr.hpp>
-
-struct Transform
-{
-	glm::vec3 position;
-	glm::vec3 rotationOrigin;
-	glm::quat rotation;
-	glm::vec3 scale;
-	glm::vec3 scaleOrigin;
-
-	glm::vec3 linearVelocity;
-	glm::quat angularVelocity;
-
-	glm::mat4 modelMat;
-
-	Transform* parent;
-
-	Transform()
-	{
-		position = glm::vec3();
-		rotationOrigin = glm::vec3();
-		rotation = glm::quat();
-		scale = glm::vec3(1.0f, 1.0f, 1.0f);
-		scaleOrigin = glm::vec3();
-
-		linearVelocity = glm::vec3();
-		angularVelocity = glm::quat();
-
-		modelMat = glm::mat4();
-
-		parent = (Transform*)nullptr;
-	}
-};
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include <GLM/gtc/type_ptr.hpp>
+#include "Transform.h"
 
 struct Shader
 {
@@ -55,17 +24,21 @@ class RenderShape
 {
 public:
 	RenderShape(GLint vao = 0, GLsizei count = 0, GLenum mode = 0, Shader shader = Shader(), glm::vec4 color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), bool useDepthTest = true);
-	~RenderShape();
+	virtual ~RenderShape();
 
-	void Update(float dt);
-	void Draw(const glm::mat4& viewProjMat);
+	// Only makes the draw call, RenderManager sets the depth test, program and the transform and color uniforms beforehand
+	virtual void Draw();
 
 	const glm::vec4& color();
 	glm::vec4& currentColor();
 	Transform& transform();
 	GLint vao();
+	void vao(GLint newVao);
 	GLsizei count();
 	void count(GLsizei newSize);
+	// Added to every index, for vertex buffers that hold more than one version of the data
+	GLint baseVertex();
+	void baseVertex(GLint newBaseVertex);
 	GLenum mode();
 	Shader shader();
 	bool& active();
@@ -75,6 +48,7 @@ private:
 
 	GLint _vao;
 	GLsizei _count;
+	GLint _baseVertex;
 	GLenum _mode;
 	Shader _shader;
 
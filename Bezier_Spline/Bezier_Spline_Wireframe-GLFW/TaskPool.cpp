@@ -0,0 +1,241 @@
+#include "TaskPool.h"
+
+std::vector<std::thread> TaskPool::_threads = std::vector<std::thread>();
+std::vector<TaskPool::Queue*> TaskPool::_queues = std::vector<TaskPool::Queue*>();
+
+const std::function<void(int, int)>* TaskPool::_task = nullptr;
+std::atomic<int> TaskPool::_remaining(0);
+
+std::mutex TaskPool::_wakeLock;
+std::condition_variable TaskPool::_wake;
+std::condition_variable TaskPool::_done;
+unsigned int TaskPool::_generation = 0;
+bool TaskPool::_quit = false;
+
+std::atomic<long long> TaskPool::_numSteals(0);
+
+std::thread TaskPool::_launcher;
+std::function<void()> TaskPool::_job;
+bool TaskPool::_jobPending = false;
+std::mutex TaskPool::_jobLock;
+std::condition_variable TaskPool::_jobStart;
+std::condition_variable TaskPool::_jobDone;
+
+void TaskPool::Init(int numThreads)
+{
+	Shutdown();
+
+	if (numThreads <= 0) numThreads = std::thread::hardware_concurrency();
+	if (numThreads <= 0) numThreads = 1;
+
+	// Queue 0 belongs to the thread that calls ParallelFor
+	for (int i = 0; i < numThreads; ++i)
+	{
+		_queues.push_back(new Queue());
+	}
+	_quit = false;
+	for (int i = 1; i < numThreads; ++i)
+	{
+		_threads.push_back(std::thread(WorkerLoop, i));
+	}
+	_launcher = std::thread(LaunchLoop);
+}
+
+void TaskPool::Shutdown()
+{
+	// A launched job may still be handing chunks to the workers
+	if (_launcher.joinable())
+	{
+		Wait();
+		{
+			std::lock_guard<std::mutex> lock(_jobLock);
+			_job = nullptr;
+			_jobPending = true;
+		}
+		_jobStart.notify_one();
+		_launcher.join();
+		_jobPending = false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_wakeLock);
+		_quit = true;
+	}
+	_wake.notify_all();
+	for (unsigned int i = 0; i < _threads.size(); ++i)
+	{
+		_threads[i].join();
+	}
+	_threads.clear();
+
+	for (unsigned int i = 0; i < _queues.size(); ++i)
+	{
+		delete _queues[i];
+	}
+	_queues.clear();
+}
+
+int TaskPool::numThreads() { return _queues.empty() ? 1 : _queues.size(); }
+long long TaskPool::numSteals() { return _numSteals; }
+
+void TaskPool::ParallelFor(int count, int grainSize, const std::function<void(int, int)>& task)
+{
+	if (count <= 0)
+		return;
+	if (grainSize < 1) grainSize = 1;
+
+	// Not worth waking anyone for
+	if (_threads.empty() || count <= grainSize)
+	{
+		for (int begin = 0; begin < count; begin += grainSize)
+		{
+			task(begin, begin + grainSize < count ? begin + grainSize : count);
+		}
+		return;
+	}
+
+	_task = &task;
+	int numChunks = (count + grainSize - 1) / grainSize;
+	_remaining = numChunks;
+
+	// Dealt so every thread starts on a contiguous run of the range
+	int numQueues = _queues.size();
+	for (int q = 0; q < numQueues; ++q)
+	{
+		int firstChunk = numChunks * q / numQueues;
+		int lastChunk = numChunks * (q + 1) / numQueues;
+
+		std::lock_guard<std::mutex> lock(_queues[q]->lock);
+		for (int c = lastChunk - 1; c >= firstChunk; --c)
+		{
+			Chunk chunk;
+			chunk.begin = c * grainSize;
+			chunk.end = chunk.begin + grainSize < count ? chunk.begin + grainSize : count;
+			_queues[q]->chunks.push_back(chunk);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_wakeLock);
+		++_generation;
+	}
+	_wake.notify_all();
+
+	while (RunChunk(0));
+
+	// Chunks other threads took may still be running
+	std::unique_lock<std::mutex> lock(_wakeLock);
+	_done.wait(lock, []() { return _remaining == 0; });
+	_task = nullptr;
+}
+
+void TaskPool::Launch(const std::function<void()>& job)
+{
+	Wait();
+
+	// Without Init there is nobody to hand it to
+	if (!_launcher.joinable())
+	{
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_jobLock);
+		_job = job;
+		_jobPending = true;
+	}
+	_jobStart.notify_one();
+}
+
+void TaskPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(_jobLock);
+	_jobDone.wait(lock, []() { return !_jobPending; });
+}
+
+bool TaskPool::jobPending()
+{
+	std::lock_guard<std::mutex> lock(_jobLock);
+	return _jobPending;
+}
+
+void TaskPool::LaunchLoop()
+{
+	std::unique_lock<std::mutex> lock(_jobLock);
+	while (true)
+	{
+		_jobStart.wait(lock, []() { return _jobPending; });
+		if (!_job)
+			return;
+
+		lock.unlock();
+		_job();
+		lock.lock();
+
+		_jobPending = false;
+		_jobDone.notify_all();
+	}
+}
+
+void TaskPool::WorkerLoop(int thread)
+{
+	unsigned int generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_wakeLock);
+			_wake.wait(lock, [&]() { return _quit || _generation != generation; });
+			if (_quit)
+				return;
+			generation = _generation;
+		}
+
+		while (RunChunk(thread));
+	}
+}
+
+bool TaskPool::RunChunk(int thread)
+{
+	Chunk chunk;
+	bool found = false;
+
+	// Own queue from the back, which is where its run of the range starts
+	{
+		Queue* own = _queues[thread];
+		std::lock_guard<std::mutex> lock(own->lock);
+		if (!own->chunks.empty())
+		{
+			chunk = own->chunks.back();
+			own->chunks.pop_back();
+			found = true;
+		}
+	}
+
+	// Then the other queues from the front, furthest away from where their owners are working
+	int numQueues = _queues.size();
+	for (int i = 1; i < numQueues && !found; ++i)
+	{
+		Queue* victim = _queues[(thread + i) % numQueues];
+		std::lock_guard<std::mutex> lock(victim->lock);
+		if (!victim->chunks.empty())
+		{
+			chunk = victim->chunks.front();
+			victim->chunks.pop_front();
+			found = true;
+			++_numSteals;
+		}
+	}
+
+	if (!found)
+		return false;
+
+	(*_task)(chunk.begin, chunk.end);
+
+	if (--_remaining == 0)
+	{
+		std::lock_guard<std::mutex> lock(_wakeLock);
+		_done.notify_all();
+	}
+	return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads for the cpu heavy loops of the program. ParallelFor cuts a range into chunks and deals
+// them round robin onto one queue per thread. Every thread takes its own chunks from the back of its queue and steals
+// from the front of the others once it runs dry, so uneven chunks even out without a central queue. The calling thread
+// works through chunks too and only returns when all of them are done, so callers never deal with threads themselves.
+class TaskPool
+{
+public:
+	// numThreads counts the calling thread, 0 uses every hardware thread
+	static void Init(int numThreads = 0);
+	static void Shutdown();
+	static int numThreads();
+
+	// Calls task(begin, end) for chunks of at most grainSize indices covering [0, count). Chunks never overlap, so as long
+	// as a task only writes what belongs to its indices the result is the same for any number of threads. Only one
+	// thread may call it at a time, and tasks must not call it themselves.
+	static void ParallelFor(int count, int grainSize, const std::function<void(int, int)>& task);
+
+	// Runs job on a thread of its own and returns straight away, so the caller can get on with something else until it
+	// calls Wait. The job may use ParallelFor, the caller may not while the job runs. Launching waits for the last job.
+	static void Launch(const std::function<void()>& job);
+	static void Wait();
+	// Whether a launched job hasn't returned yet, only then may the caller use ParallelFor
+	static bool jobPending();
+
+	// Chunks run by a thread other than the one they were dealt to, since Init
+	static long long numSteals();
+private:
+	struct Chunk
+	{
+		int begin;
+		int end;
+	};
+
+	struct Queue
+	{
+		std::mutex lock;
+		std::deque<Chunk> chunks;
+	};
+
+	static void WorkerLoop(int thread);
+
+	// Runs one chunk, from the thread's own queue if it has any, returns false when every queue is empty
+	static bool RunChunk(int thread);
+
+	static void LaunchLoop();
+private:
+	static std::vector<std::thread> _threads;
+	static std::vector<Queue*> _queues;
+
+	// The loop being run and how many of its chunks are still unfinished
+	static const std::function<void(int, int)>* _task;
+	static std::atomic<int> _remaining;
+
+	// Workers sleep until the generation changes, ParallelFor sleeps until _remaining reaches 0
+	static std::mutex _wakeLock;
+	static std::condition_variable _wake;
+	static std::condition_variable _done;
+	static unsigned int _generation;
+	static bool _quit;
+
+	static std::atomic<long long> _numSteals;
+
+	// The launched job, an empty one tells the thread to quit. _jobPending stays set until the job has returned.
+	static std::thread _launcher;
+	static std::function<void()> _job;
+	static bool _jobPending;
+	static std::mutex _jobLock;
+	static std::condition_variable _jobStart;
+	static std::condition_variable _jobDone;
+};
@@ -0,0 +1,17 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+
+class B_Spline;
+
+// The Utah teapot's bicubic patches, shared by the program and the benchmarks
+class Teapot
+{
+public:
+	static const int NUM_PATCHES = 28;
+
+	// 16 control points of 3 floats for every patch, in the order B_Spline::SetControlPoints takes them
+	static const GLfloat controlPoints[NUM_PATCHES * 48];
+
+	// Gives patch i of spline the control points of the teapot's patch i
+	static void LoadPatch(B_Spline* spline, int i);
+};
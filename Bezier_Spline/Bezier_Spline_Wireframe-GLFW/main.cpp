@@ -39,6 +39,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *	- Holds the instance data for a shape that can be rendered to the screen. This includes a transform, a vao, a shader, the drawing
 *	mode (eg triangles, lines), it's active state, and its color
 *
+*	TransformManager
+*	- Holds the position, rotation and scale of every Transform in arrays ordered parents first, and the velocities of just the
+*	ones that move. Once a frame the moving ones are integrated in one pass, and before anything is drawn it rebuilds the model
+*	matrices of the transforms that changed and of their children, so shapes only read a finished matrix.
+*
+*	RenderQueue
+*	- Sorts the shapes RenderManager draws each frame by pass, shader, vao and primitive mode with a radix sort on 64 bit keys,
+*	so the depth test and program are only set when they change from one draw to the next. RenderManager also remembers the
+*	transform and color each program holds and skips the uniforms a shape would set to the same values.
+*
+*	InstanceBatch
+*	- Collects every RenderShape drawn with the same mesh, like the control point markers and slope lines of all the patches, and draws
+*	them with one instanced draw call from a buffer of per-instance model matrices and colors.
+*
 *	InteractiveShape
 *	- Inherits from RenderShape, possessing all the same properties. Additionally, it has a collider and can use it to check collisions against
 *	world boundries, other colliders, and the cursor.
@@ -51,26 +65,170 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *	based on the positions of the control points and the mathematical function above.
 *
 *	B_Spline
-*	- Generates and holds an array of Patch objects and gives them a single transform. 
+*	- Generates and holds an array of Patch objects and gives them a single transform. It uses a PatchTopology to find the edges
+*	neighbouring patches share and samples them at the coarser of the two levels of detail so the surface stays free of cracks.
+*	Pressing W welds the patches into one vertex and index buffer, where every vertex on a shared edge or corner is stored once.
+*	Otherwise all the patches are drawn out of one GeometryArena with a single multi-draw call for the surface and one for the
+*	wireframe. Down removes the last patch and up adds it back. Pressing P pipelines the tessellation, the patches for the
+*	next frame are evaluated on a TaskPool job while the current frame is drawn and uploaded when the next Update starts. The
+*	job also moves the transforms with a velocity, from a snapshot of them the RenderManager takes before it is launched.
+*
+*	GeometryArena
+*	- Hands out blocks of a few large vertex buffers to the patches of a B_Spline and keeps the indices of every level of detail in
+*	one shared index buffer. Freed blocks go back on a free list so patches can be added and removed without moving the others,
+*	once the gpu has passed the fence they were retired behind. Every patch takes a block for its finest level when it is made.
+*
+*	MultiDrawShape
+*	- A RenderShape that collects index ranges out of a GeometryArena each frame and draws them with glMultiDrawElementsBaseVertex.
+*
+*	PatchTopology
+*	- Hashes the boundary control points of a set of patches to find which edges they share, which edges collapse to a point and
+*	which corners meet, in a single pass over the patches. Points are compared by distance, so two within the tolerance weld
+*	wherever they fall in the hash. Running the program with -verify-topology checks the teapot gives the same topology when
+*	it is moved across the hash cells and its control points are nudged apart.
+*
+*	PatchLod
+*	- Picks how many vertices each patch is tessellated with every frame, from the projected size of its control net and an error
+*	budget in pixels. Left and right change the budget.
+*
+*	BezierEvaluator
+*	- Contains static functions that evaluate cubic curves and patches several parameters at a time. The SSE2 or AVX2 version is picked
+*	at startup depending on what the cpu supports, with a plain C++ version as the fallback.
+*
+*	BasisCache
+*	- Builds each sampled Bernstein basis table once and hands the same read-only copy to every curve and patch that asks for it.
+*
+*	StreamBuffer
+*	- Vertex buffer for tessellated data that changes while the gpu may still be drawing the old version. Writes go into a fenced ring
+*	of persistently mapped regions when ARB_buffer_storage is available, and through glBufferSubData of the changed bytes otherwise.
+*
+*	GridIndexRegistry
+*	- Holds one triangle and one line index buffer per grid resolution. Every patch and surface of that resolution draws with them
+*	instead of uploading its own copy. It also holds the (u, v) parameters of each grid for the vertex shader evaluation.
+*
+*	GpuPatchEvaluator / GpuPatchShape
+*	- Evaluate the patches in the vertex shader from their control points in a texture buffer, drawing the patches of each level of
+*	detail with one instanced call over a shared (u, v) grid. Pressing G switches to it, and running the program with -verify-gpu
+*	checks it against the cpu tessellation through transform feedback.
+*
+*	TaskPool
+*	- A work-stealing pool of worker threads. B_Spline evaluates the patches that changed on it in blocks of rows, and anything
+*	else that loops over a lot of independent cpu work can hand its loop to ParallelFor too. Launch runs a job on a thread of its
+*	own so it overlaps with whatever the caller does until it waits for it.
+*
+*	Teapot
+*	- The control points of the Utah teapot's 28 patches, loaded into a B_Spline one patch at a time.
+*
+*	Benchmark
+*	- Measures the evaluation code without opening a window, built as Bezier_Spline_Benchmark on the same core as the program.
+*	Run it to print the results, including how tessellating 10000 patches scales from one thread to all of them. -json [file]
+*	runs the suite of curves, patches, teapot frames, B_Spline sheets of up to 100k bare patches and the motion of up to 1M
+*	transforms on the null backend and writes the time, heap allocations and peak memory of each as JSON, to compare
+*	between builds.
+*
+*	NurbsBasis
+*	- Evaluates the non-zero B-spline basis functions for a knot vector and caches them for every sample of a tessellation.
+*
+*	NurbsCurve / NurbsSurface
+*	- Rational B-spline curve and surface of any degree with weighted control points and their own knot vectors. They are drawn the
+*	same way as Patch and are only re-tessellated when a control point, weight or knot changes. The torus above the lid and the
+*	ring around the base are exact circles made of quadratic arcs, which no cubic Bezier patch can make. Running the program with
+*	-verify-nurbs tessellates every teapot patch again as a cubic NurbsSurface with unit weights, compares it with the Bezier
+*	evaluation, checks the torus and ring lie on their circles and that knot vectors and weights that would divide by zero are
+*	kept out, and fails if anything is off.
+*
+*	RenderBackend
+*	- Everything the shapes, buffers and managers ask of the graphics api goes through it. GLRenderBackend passes the calls on to
+*	GL, NullRenderBackend only counts the buffers and draws it is given. Running the program with -headless [frames] runs the
+*	teapot through every drawing mode on the null backend, without a window or a GL context.
+*
+*	GLRenderBackend
+*	- Remembers the program, vao, buffer bindings, depth test and uniform values it last set and leaves out every call that would
+*	set them to what they already are. Run the program with -check-gl-state to have it read each remembered value back with
+*	glGet* before relying on it, log any that GL disagrees with, and print how many calls were left out on exit.
+*
+*	Profiler
+*	- Times named zones of each frame, like the updates, the tessellation on every worker thread and the draws. Run the program
+*	with -profile [trace.json] to print the p50, p95 and p99 time of each zone every 256 frames and write every zone as a trace
+*	for chrome://tracing or Perfetto on exit. Without it the zones are skipped, and defining NO_PROFILER compiles them out.
+*
+*	CountingRenderBackend
+*	- Sits between the code and another backend and counts the draw calls, vao and program binds, depth test changes, uniforms
+*	and uploads of every frame, and which binds and changes set what was already set. Run the program with -gl-stats [frames]
+*	to log the average per frame every that many frames, 60 by default. Under -headless it counts the calls made to the null
+*	backend.
+*
+*	AllocationTracker
+*	- Counts every heap allocation through a replacement operator new, per frame and per Profiler zone. The update and draw
+*	code keeps its scratch memory between frames so a frame that has warmed up allocates nothing. Running the program with
+*	-verify-allocations [frames] runs the teapot in every drawing mode with all of its control points moving on the null
+*	backend and fails if any frame after the first few allocates.
+*
+*	Core
+*	- Init_Shader, the render backends, StreamBuffer, BezierEvaluator, BasisCache, Profiler, AllocationTracker, PatchLod,
+*	Transform and TransformManager live in Core at the root of the repository, shared by the examples. The CMakeLists.txt
+*	there builds them as the NurbsCore library, which never links GL, and builds this program on top of it twice: with a
+*	window, and as Bezier_Spline_Headless, defined NURBS_HEADLESS, which only runs the modes that need no GL context.
 */
-#include <GLEW\GL\glew.h>
-#include <GLFW\glfw3.h>
-#include <GLM\gtc\type_ptr.hpp>
-#include <GLM\gtc\matrix_transform.hpp>
-#include <GLM\gtc\quaternion.hpp>
-#include <GLM\gtc\random.hpp>
+#include <GLEW/GL/glew.h>
+#ifndef NURBS_HEADLESS
+#include <GLFW/glfw3.h>
+#endif
+#include <GLM/gtc/type_ptr.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include <GLM/gtc/random.hpp>
 #include <iostream>
 #include <ctime>
+#include <chrono>
+#include <cstring>
 
 #include "RenderShape.h"
-#include "Init_Shader.h"
 #include "RenderManager.h"
 #include "InputManager.h"
 #include "B-Spline.h"
 #include "Patch.h"
 #include "CameraManager.h"
+#include "PatchLod.h"
+#include "Teapot.h"
+#include "GridIndexRegistry.h"
+#include "InstanceBatch.h"
+#include "GeometryArena.h"
+#include "StreamBuffer.h"
+#include "TaskPool.h"
+#include "RenderBackend.h"
+#include "NullRenderBackend.h"
+#include "CountingRenderBackend.h"
+#include "Profiler.h"
+#include "AllocationTracker.h"
+#include "NurbsCurve.h"
+#include "NurbsSurface.h"
+#include "BezierEvaluator.h"
+#include "BasisCache.h"
+#include "PatchTopology.h"
+
+#ifndef NURBS_HEADLESS
+#include "Init_Shader.h"
+#include "GLRenderBackend.h"
 
 GLFWwindow* window;
+#endif
+
+// Set by -headless, there are no shaders and no window to clean up
+bool headless = false;
+
+// Set by -profile, where the trace goes when the program exits
+const char* tracePath = NULL;
+
+// Set by -gl-stats, the layer counting the GL calls of every frame and how many frames go into each log
+CountingRenderBackend* glStats = NULL;
+int glStatsInterval = 0;
+
+#ifndef NURBS_HEADLESS
+// Set by -check-gl-state, the GL backend reads back what it remembers before relying on it
+bool checkGlState = false;
+GLRenderBackend* glBackend = NULL;
+#endif
 
 GLuint vertexShader;
 GLuint fragmentShader;
@@ -85,6 +243,15 @@ GLint posAttrib;
 GLint uTransform;
 GLint uColor;
 
+// Draws the control point markers and slope lines of every patch in one call each
+GLuint instancedShaderProgram;
+GLint uInstancedTransform;
+
+// Evaluates the teapot in the vertex shader when G is pressed
+GLuint bezierShaderProgram;
+GLint uBezierTransform;
+GLint uBezierColor;
+
 GLfloat vertices[] = {
 	-1.0f, +1.0f, -1.0f,
 	+1.0f, +1.0f, -1.0f,
@@ -126,148 +293,6 @@ GLint outlineElements[] = {
 	2, 5 
 };
 
-// Source http://www.holmes3d.net/graphics/teapot/teapotCGA.bpt
-GLfloat teapotControlPoints[] = {
-	1.4, 2.25, 0,		1.3375,	2.38125, 0,			1.4375,	2.38125, 0,			1.5, 2.25, 0,
-	1.4, 2.25, .784,	1.3375,	2.38125, .749,		1.4375, 2.38125, .805,		1.5, 2.25, .84,
-	.784, 2.25, 1.4,	.749, 2.38125, 1.3375,		.805, 2.38125, 1.4375,		.84, 2.25, 1.5,
-	0, 2.25, 1.4,		0, 2.38125, 1.3375,			0, 2.38125, 1.4375,			0, 2.25, 1.5,
-
-	0, 2.25, 1.4,		0, 2.38125, 1.3375,			0, 2.38125, 1.4375,			0, 2.25, 1.5,
-	-.784, 2.25, 1.4,	-.749, 2.38125, 1.3375,		-.805, 2.38125,	1.4375,		-.84, 2.25, 1.5,
-	-1.4, 2.25, .784,	-1.3375, 2.38125, .749,		-1.4375, 2.38125, .805,		-1.5, 2.25, .84,
-	-1.4, 2.25, 0,		-1.3375, 2.38125, 0,		-1.4375, 2.38125, 0,		-1.5, 2.25, 0,
-
-	-1.4, 2.25, 0,		-1.3375, 2.38125, 0,		-1.4375, 2.38125, 0,		-1.5, 2.25, 0,
-	-1.4, 2.25, -.784,	-1.3375, 2.38125, -.749,	-1.4375, 2.38125, -.805,	-1.5, 2.25, -.84,
-	-.784, 2.25, -1.4,	-.749, 2.38125, -1.3375,	-.805, 2.38125,	-1.4375,	-.84, 2.25, -1.5,
-	0, 2.25, -1.4,		0, 2.38125, -1.3375,		0,	2.38125, -1.4375,		0, 2.25, -1.5,
-
-	0, 2.25, -1.4,		0, 2.38125, -1.3375,		0, 2.38125, -1.4375,		0, 2.25, -1.5,
-	.784, 2.25, -1.4,	.749, 2.38125, -1.3375,		.805, 2.38125, -1.4375,		.84, 2.25, -1.5,
-	1.4, 2.25, -.784,	1.3375,	2.38125, -.749,		1.4375, 2.38125, -.805,		1.5, 2.25, -.84,
-	1.4, 2.25, 0,		1.3375,	2.38125, 0,			1.4375, 2.38125, 0,			1.5, 2.25, 0,
-
-	1.5, 2.25, 0,		1.75, 1.725, 0,				2, 1.2,	0,					2, .75, 0,
-	1.5, 2.25, .84,		1.75, 1.725, .98,			2, 1.2,	1.12,				2, .75, 1.12,
-	.84, 2.25, 1.5,		.98, 1.725, 1.75,			1.12, 1.2, 2,				1.12, .75, 2,
-	0, 2.25, 1.5,		0, 1.725, 1.75,				0, 1.2,	2,					0, .75, 2,
-
-	0, 2.25, 1.5,		0, 1.725, 1.75,				0, 1.2,	2,					0, .75, 2,
-	-.84, 2.25, 1.5,	-.98, 1.725, 1.75,			-1.12, 1.2, 2,				-1.12, .75, 2,
-	-1.5, 2.25, .84,	-1.75, 1.725, .98,			-2, 1.2, 1.12,				-2, .75, 1.12,
-	-1.5, 2.25, 0,		-1.75, 1.725, 0,			-2, 1.2, 0,					-2, .75, 0,
-
-	-1.5, 2.25, 0,		-1.75, 1.725, 0,			-2, 1.2, 0,					-2, .75, 0,
-	-1.5, 2.25, -.84,	-1.75, 1.725, -.98,			-2, 1.2, -1.12,				-2, .75, -1.12,
-	-.84, 2.25, -1.5,	-.98, 1.725, -1.75,			-1.12, 1.2, -2,				-1.12, .75, -2,
-	0, 2.25, -1.5,		0, 1.725,-1.75,				0, 1.2, -2,					0, .75, -2,
-
-	0, 2.25, -1.5,		0, 1.725, -1.75,			0, 1.2,	-2,					0, .75, -2,
-	.84, 2.25, -1.5,	.98, 1.725, -1.75,			1.12, 1.2, -2,				1.12, .75, -2,
-	1.5, 2.25, -.84,	1.75, 1.725, -.98,			2, 1.2, -1.12,				2, .75, -1.12,
-	1.5, 2.25, 0,		1.75, 1.725, 0,				2, 1.2, 0,					2, .75, 0,
-
-	2, .75, 0,			2, .3, 0,					1.5, .075, 0,				1.5, 0, 0,
-	2, .75, 1.12,		2, 	.3, 1.12,				1.5, .075, .84,				1.5, 0, .84,
-	1.12, .75, 2,		1.12, .3, 2,				.84, .075, 1.5,				.84, 0, 1.5,
-	0, .75, 2,			0, .3, 2,					0, .075, 1.5,				0, 0, 1.5,
-
-	0, .75, 2,			0, .3, 2,					0, .075, 1.5,				0, 0, 1.5,
-	-1.12, .75, 2,		-1.12, .3, 2,				-.84, .075, 1.5,			-.84, 0, 1.5,
-	-2, .75, 1.12,		-2, .3, 1.12,				-1.5, .075,	.84,			-1.5, 0, .84,
-	-2, .75, 0,			-2, .3, 0,					-1.5, .075,	0,				-1.5, 0, 0,
-
-	-2, .75, 0,			-2,	.3, 0,					-1.5, .075,	0,				-1.5, 0, 0,
-	-2, .75, -1.12,		-2,	.3, -1.12,				-1.5, .075,	-.84,			-1.5, 0, -.84,
-	-1.12, .75, -2,		-1.12, .3, -2,				-.84, .075,	-1.5,			-.84, 0, -1.5,
-	0, .75, -2,			0, .3, -2,					0, .075, -1.5,				0, 0, -1.5,
-
-	0, .75, -2,			0, .3, -2,					0, .075, -1.5,				0, 0, -1.5,
-	1.12, .75, -2,		1.12, .3, -2,				.84, .075, -1.5,			.84, 0, -1.5,
-	2, .75, -1.12,		2, .3, -1.12,				1.5, .075,	-.84,			1.5, 0, -.84,
-	2, .75, 0,			2, .3, 0,					1.5, .075,	0,				1.5, 0, 0,
-
-	-1.6, 1.875, 0,		-2.3, 1.875, 0,				-2.7, 1.875, 0,				-2.7, 1.65, 0,
-	-1.6, 1.875, .3,	-2.3, 1.875, .3,			-2.7, 1.875, .3,			-2.7, 1.65, .3,
-	-1.5, 2.1, .3,		-2.5, 2.1, .3,				-3, 2.1, .3,				-3, 1.65, .3,
-	-1.5, 2.1, 0,		-2.5, 2.1, 0,				-3, 2.1, 0,					-3, 1.65, 0,
-
-	-1.5, 2.1, 0,		-2.5, 2.1, 0,				-3, 2.1, 0,					-3, 1.65, 0,
-	-1.5, 2.1, -.3,		-2.5, 2.1, -.3,				-3, 2.1, -.3,				-3, 1.65, -.3,
-	-1.6, 1.875, -.3,	-2.3, 1.875, -.3,			-2.7, 1.875, -.3,			-2.7, 1.65, -.3,
-	-1.6, 1.875, 0,		-2.3, 1.875, 0,				-2.7, 1.875, 0,				-2.7, 1.65, 0,
-
-	-2.7, 1.65, 0,		-2.7, 1.425, 0,				-2.5, .975, 0,				-2, .75, 0,
-	-2.7, 1.65, .3,		-2.7, 1.425, .3,			-2.5, .975,	.3,				-2, .75, .3,
-	-3, 1.65, .3,		-3, 1.2, .3,				-2.65, .7875, .3,			-1.9, .45, .3,
-	-3, 1.65, 0,		-3,	1.2, 0,					-2.65, .7875, 0,			-1.9, .45, 0,
-
-	-3, 1.65, 0,		-3,	1.2, 0,					-2.65, .7875, 0,			-1.9, .45, 0,
-	-3, 1.65, -.3,		-3,	1.2, -.3,				-2.65, .7875, -.3,			-1.9, .45, -.3,
-	-2.7, 1.65, -.3,	-2.7, 1.425, -.3,			-2.5, .975, -.3,			-2, .75, -.3,
-	-2.7, 1.65, 0,		-2.7, 1.425, 0,				-2.5, .975,	0,				-2, .75, 0,
-
-	1.7, 1.275, 0,		2.6, 1.275, 0,				2.3, 1.95, 0,				2.7, 2.25, 0,
-	1.7, 1.275, .66,	2.6, 1.275, .66,			2.3, 1.95,	.25,			2.7, 2.25, .25,
-	1.7, .45, .66,		3.1, .675, .66,				2.4, 1.875,	.25,			3.3, 2.25, .25,
-	1.7, .45, 0,		3.1, .675, 0,				2.4, 1.875,	0,				3.3, 2.25, 0,
-
-	1.7, .45, 0,		3.1, .675, 0,				2.4, 1.875,	0,				3.3, 2.25, 0,
-	1.7, .45, -.66,		3.1, .675, -.66,			2.4, 1.875,	-.25,			3.3, 2.25, -.25,
-	1.7, 1.275, -.66,	2.6, 1.275, -.66,			2.3, 1.95, -.25,			2.7, 2.25, -.25,
-	1.7, 1.275, 0,		2.6, 1.275, 0,				2.3, 1.95, 0,				2.7, 2.25, 0,
-
-	2.7, 2.25, 0,		2.8, 2.325, 0,				2.9, 2.325, 0,				 2.8, 2.25, 0,
-	2.7, 2.25, .25,		2.8, 2.325, .25,			2.9, 2.325,	.15,			2.8, 2.25, .15,
-	3.3, 2.25, .25,		3.525, 2.34375, .25,		3.45, 2.3625, .15,			3.2, 2.25, .15,
-	3.3, 2.25, 0,		3.525, 2.34375, 0,			3.45, 2.3625, 0,			3.2, 2.25, 0,
-
-	3.3, 2.25, 0,		3.525, 2.34375, 0,			3.45, 2.3625, 0,			3.2, 2.25, 0,
-	3.3, 2.25, -.25,	3.525, 2.34375, -.25,		3.45, 2.3625, -.15,			3.2, 2.25, -.15,
-	2.7, 2.25, -.25,	2.8, 2.325, -.25,			2.9, 2.325, -.15,			2.8, 2.25, -.15,
-	2.7, 2.25, 0,		2.8, 2.325, 0,				2.9, 2.325,	0,				2.8, 2.25, 0,
-
-	0, 3, 0,			.8, 3, 0,					0, 2.7, 0,					.2, 2.55, 0,
-	0, 3, .002,			.8,	3, .45,					0, 2.7,	0,					.2, 2.55, .112,
-	.002, 3, 0,			.45, 3, .8,					0, 2.7,	0,					.112, 2.55, .2,
-	0, 3, 0,			0, 3, .8,					0, 2.7,	0,					0, 2.55, .2,
-
-	0, 3, 0,			0, 3, .8,					0, 2.7,	0,					0, 2.55, .2,
-	-.002, 3, 0,		-.45, 3, .8,				0, 2.7,	0,					-.112, 2.55, .2,
-	0, 3, .002,			-.8, 3, .45,				0, 2.7,	0,					-.2, 2.55, .112,
-	0, 3, 0,			-.8, 3, 0,					0, 2.7,	0,					-.2, 2.55, 0,
-
-	0, 3, 0,			-.8, 3, 0,					0, 2.7,	0,					-.2, 2.55, 0,
-	0, 3, -.002,		-.8, 3, -.45,				0, 2.7,	0,					-.2, 2.55, -.112,
-	-.002, 3, 0,		-.45, 3, -.8,				0, 2.7,	0,					-.112, 2.55, -.2,
-	0, 3, 0,			0, 3, -.8,					0, 2.7,	0,					0, 2.55, -.2,
-
-	0, 3, 0,			0, 3, -.8,					0, 2.7,	0,					0, 2.55, -.2,
-	.002, 3, 0,			.45, 3, -.8,				0, 2.7,	0,					.112, 2.55, -.2,
-	0, 3, -.002,		.8,	3, -.45,				0, 2.7, 0,					.2, 2.55, -.112,
-	0, 3, 0,			.8, 3, 0,					0, 2.7,	0,					.2, 2.55, 0,
-
-	.2, 2.55, 0,		.4, 2.4, 0,					1.3, 2.4, 0,				1.3, 2.25, 0,
-	.2, 2.55, .112,		.4, 2.4, .224,				1.3, 2.4, .728,				1.3, 2.25, .728,
-	.112, 2.55, .2,		.224, 2.4, .4,				.728, 2.4, 1.3,				.728, 2.25, 1.3,
-	0, 2.55, .2,		0, 2.4, .4,					0, 2.4, 1.3,				0, 2.25, 1.3,
-
-	0, 2.55, .2,		0, 2.4, .4,					0, 2.4,	1.3,				0, 2.25, 1.3,
-	-.112, 2.55, .2,	-.224, 2.4, .4,				-.728, 2.4, 1.3,			-.728, 2.25, 1.3,
-	-.2, 2.55, .112,	-.4, 2.4, .224,				-1.3, 2.4, .728,			-1.3, 2.25, .728,
-	-.2, 2.55, 0,		-.4, 2.4, 0,				-1.3, 2.4, 0,				-1.3, 2.25, 0,
-
-	-.2, 2.55, 0,		-.4, 2.4, 0,				-1.3, 2.4, 0,				-1.3, 2.25, 0,
-	-.2, 2.55, -.112,	-.4, 2.4, -.224,			-1.3, 2.4, -.728,			-1.3, 2.25, -.728,
-	-.112, 2.55, -.2,	-.224, 2.4, -.4,			-.728, 2.4,	-1.3,			-.728, 2.25, -1.3,
-	0, 2.55, -.2,		0, 2.4, -.4,				0, 2.4, -1.3,				0, 2.25, -1.3,
-
-	0, 2.55, -.2,		0, 2.4, -.4,				0, 2.4, -1.3,				0, 2.25, -1.3,
-	.112, 2.55, -.2,	.224, 2.4, -.4,				.728, 2.4, -1.3,			.728, 2.25, -1.3,
-	.2, 2.55, -.112,	.4, 2.4, -.224,				1.3, 2.4, -.728,			1.3, 2.25, -.728,
-	.2, 2.55, 0,		.4, 2.4, 0,					1.3, 2.4, 0,				1.3, 2.25, 0
-};
 
 B_Spline* teapot;
 
@@ -278,56 +303,172 @@ void generateTeapot()
 	shader.uTransform = uTransform;
 	shader.uColor = uColor;
 
-	teapot = new B_Spline(RenderShape(vao0, 36, GL_TRIANGLES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), false), RenderShape(vao1, 2, GL_LINES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), false), 28);
+	RenderShape markerTemplate = RenderShape(vao0, 36, GL_TRIANGLES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), false);
+	RenderShape slopeLineTemplate = RenderShape(vao1, 2, GL_LINES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), false);
+
+	// Every copy of the templates the patches add gets drawn by these
+	Shader instancedShader;
+	instancedShader.shaderPointer = instancedShaderProgram;
+	instancedShader.uTransform = uInstancedTransform;
+
+	RenderManager::AddBatch(new InstanceBatch(instancedShader, vbo, ebo0, markerTemplate));
+	RenderManager::AddBatch(new InstanceBatch(instancedShader, vbo, ebo1, slopeLineTemplate));
+
+	Shader bezierShader;
+	bezierShader.shaderPointer = bezierShaderProgram;
+	bezierShader.uTransform = uBezierTransform;
+	bezierShader.uColor = uBezierColor;
+
+	teapot = new B_Spline(markerTemplate, slopeLineTemplate, Teapot::NUM_PATCHES, bezierShader);
+
+	for (int i = 0; i < Teapot::NUM_PATCHES; ++i)
+	{
+		Teapot::LoadPatch(teapot, i);
+	}
+
+	teapot->transform().position(glm::vec3(0.0f, -1.5f, 0.0f));
+}
+
+NurbsSurface* torus;
+NurbsCurve* ring;
+
+const GLfloat torusMajorRadius = 0.6f;
+const GLfloat torusMinorRadius = 0.15f;
+const GLfloat ringRadius = 2.5f;
+
+// A unit circle as four quadratic arcs, the control points on the corners of the square around it are weighted by sqrt(2) / 2
+GLfloat circleControlPoints[] = {
+	1, 0,	1, 1,	0, 1,	-1, 1,	-1, 0,	-1, -1,	0, -1,	1, -1,	1, 0
+};
+GLfloat circleKnots[] = {
+	0, 0, 0, .25, .25, .5, .5, .75, .75, 1, 1, 1
+};
+
+GLfloat circleWeight(int i)
+{
+	return (i & 1) ? 0.70710678f : 1.0f;
+}
+
+void generateNurbs()
+{
+	Shader shader;
+	shader.shaderPointer = shaderProgram;
+	shader.uTransform = uTransform;
+	shader.uColor = uColor;
+
+	std::vector<GLfloat> knots = std::vector<GLfloat>(circleKnots, circleKnots + 12);
 
-	for (int i = 0; i < 28; ++i)
+	// The circle through the tube, swept around the circle through the middle of the tube
+	torus = new NurbsSurface(shader, 2, 2, 9, 9);
+	for (int v = 0; v < 9; ++v)
 	{
-		int k = i * 48;
-
-		teapot->SetControlPoints(i,
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]),
-			glm::vec3(teapotControlPoints[k++], teapotControlPoints[k++], teapotControlPoints[k++]));
+		GLfloat radius = torusMajorRadius + torusMinorRadius * circleControlPoints[v * 2];
+		GLfloat y = torusMinorRadius * circleControlPoints[v * 2 + 1];
+		for (int u = 0; u < 9; ++u)
+		{
+			torus->SetControlPoint(u, v, glm::vec3(radius * circleControlPoints[u * 2], y, radius * circleControlPoints[u * 2 + 1]), circleWeight(u) * circleWeight(v));
+		}
 	}
+	torus->SetKnotsU(knots);
+	torus->SetKnotsV(knots);
+	torus->transform().position(glm::vec3(0.0f, 2.2f, 0.0f));
 
-	teapot->transform().position = glm::vec3(0.0f, -1.5f, 0.0f);
+	ring = new NurbsCurve(shader, 2, 9);
+	for (int i = 0; i < 9; ++i)
+	{
+		ring->SetControlPoint(i, glm::vec3(circleControlPoints[i * 2], 0.0f, circleControlPoints[i * 2 + 1]) * ringRadius, circleWeight(i));
+	}
+	ring->SetKnots(knots);
+	ring->transform().position(glm::vec3(0.0f, -1.5f, 0.0f));
 }
 
+#ifndef NURBS_HEADLESS
 void initShaders()
 {
-	char* shaders[] = { "fshader.glsl", "vshader.glsl" };
+	char* instancedShaders[] = { "fShader.glsl", "vShaderInstanced.glsl" };
 	GLenum types[] = { GL_FRAGMENT_SHADER, GL_VERTEX_SHADER };
 	int numShaders = 2;
+
+	instancedShaderProgram = initShaders(instancedShaders, types, numShaders);
+
+	uInstancedTransform = glGetUniformLocation(instancedShaderProgram, "transform");
+
+	char* bezierShaders[] = { "fShader.glsl", "vShaderBezier.glsl" };
+
+	bezierShaderProgram = initShaders(bezierShaders, types, numShaders);
+
+	// Linked again to capture the evaluated positions, -verify-gpu compares them with the cpu tessellation
+	const char* feedbackVaryings[] = { "surfacePosition" };
+	glTransformFeedbackVaryings(bezierShaderProgram, 1, feedbackVaryings, GL_INTERLEAVED_ATTRIBS);
+	glLinkProgram(bezierShaderProgram);
+
+	uBezierTransform = glGetUniformLocation(bezierShaderProgram, "transform");
+	uBezierColor = glGetUniformLocation(bezierShaderProgram, "color");
+
+	// Linked last so it is the program in use
+	char* shaders[] = { "fShader.glsl", "vShader.glsl" };
 	
 	shaderProgram = initShaders(shaders, types, numShaders);
 	
 	uTransform = glGetUniformLocation(shaderProgram, "transform");
 	uColor = glGetUniformLocation(shaderProgram, "color");
 }
+#endif
+
+void initMeshes()
+{
+	RenderBackend& backend = RenderBackend::Get();
+
+	// Store the data for the triangles in a buffer that the gpu can use to draw
+	vbo = backend.CreateBuffer(sizeof(vertices), vertices, GL_STATIC_DRAW);
+	ebo0 = backend.CreateBuffer(sizeof(elements), elements, GL_STATIC_DRAW);
+	ebo1 = backend.CreateBuffer(sizeof(outlineElements), outlineElements, GL_STATIC_DRAW);
+
+	// Bind buffer data to shader values
+	posAttrib = backend.AttribLocation(shaderProgram, "position");
+
+	vao0 = backend.CreateVertexArray(ebo0);
+	backend.VertexAttribute(vao0, vbo, posAttrib, 3, 0, 0);
+
+	vao1 = backend.CreateVertexArray(ebo1);
+	backend.VertexAttribute(vao1, vbo, posAttrib, 3, 0, 0);
+}
+
+void initScene()
+{
+	// Patches are tessellated on every core, the uploads stay on this thread
+	TaskPool::Init();
+
+	time_t timer;
+	time(&timer);
+	srand((unsigned int)timer);
 
+	generateTeapot();
+	generateNurbs();
+
+	CameraManager::Init(800.0f / 600.0f, 60.0f, 0.1f, 100.0f);
+	PatchLod::screenSize(glm::vec2(800.0f, 600.0f));
+}
+
+// Puts backend under the layer counting its calls when -gl-stats asked for them
+void setBackend(RenderBackend* backend)
+{
+	if (glStatsInterval > 0)
+	{
+		glStats = new CountingRenderBackend(backend, glStatsInterval);
+		backend = glStats;
+	}
+	RenderBackend::Set(backend);
+}
+
+#ifndef NURBS_HEADLESS
 void init()
 {
 	if (!glfwInit()) exit(EXIT_FAILURE);
 
 	//Create window
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 
 	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 
@@ -339,57 +480,30 @@ void init()
 	glewExperimental = true;
 	glewInit();
 
-	initShaders();
-
-	// Store the data for the triangles in a buffer that the gpu can use to draw
-	glGenVertexArrays(1, &vao0);
-	glBindVertexArray(vao0);
-
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &ebo0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo0);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements), elements, GL_STATIC_DRAW);
-
-	// Bind buffer data to shader values
-	posAttrib = glGetAttribLocation(shaderProgram, "position");
-	glEnableVertexAttribArray(posAttrib);
-	glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-	glGenVertexArrays(1, &vao1);
-	glBindVertexArray(vao1);
-
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &ebo1);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo1);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(outlineElements), outlineElements, GL_STATIC_DRAW);
+	glBackend = new GLRenderBackend(checkGlState);
+	setBackend(glBackend);
 
-	// Bind buffer data to shader values
-	posAttrib = glGetAttribLocation(shaderProgram, "position");
-	glEnableVertexAttribArray(posAttrib);
-	glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	initShaders();
+	initMeshes();
 
 	glfwSetTime(0.0);
 
-	time_t timer;
-	time(&timer);
-	srand((unsigned int)timer);
-
-	generateTeapot();
-
+	initScene();
 	InputManager::Init(window);
-	CameraManager::Init(800.0f / 600.0f, 60.0f, 0.1f, 100.0f);
+	std::cout << "Vertex uploads: " << (StreamBuffer::persistent() ? "persistently mapped ring" : "glBufferSubData") << std::endl;
 
 	glEnable(GL_DEPTH_TEST);
 }
 
 void step()
 {
+	Profiler::BeginFrame();
+	PROFILE_ZONE("Frame");
+
+	// Once every frame in the ring is new
+	if (tracePath && Profiler::frame() > 1 && (Profiler::frame() - 1) % Profiler::NUM_FRAMES == 0)
+		Profiler::PrintSummary(std::cout);
+
 	// Clear to black
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -404,35 +518,463 @@ void step()
 
 	RenderManager::Update(dt);
 
-	teapot->Update(dt);
+	// Left and right loosen or tighten the pixel error the patches are tessellated to
+	GLfloat pixelError = PatchLod::pixelError();
+	if (InputManager::leftKey(true) && !InputManager::leftKey()) pixelError *= 2.0f;
+	if (InputManager::rightKey(true) && !InputManager::rightKey()) pixelError /= 2.0f;
+	bool pixelErrorChanged = pixelError != PatchLod::pixelError();
+	PatchLod::pixelError(glm::clamp(pixelError, 0.0625f, 16.0f));
+
+	// W switches between drawing every patch on its own and drawing the welded model
+	bool weldToggled = InputManager::wKey(true) && !InputManager::wKey();
+	if (weldToggled) teapot->welded(!teapot->welded());
 
-	RenderManager::Draw(CameraManager::ViewProjMat());
+	// Down takes the last patch off the teapot and up puts it back, without touching the vertices of the others
+	bool patchesChanged = false;
+	if (InputManager::downKey(true) && !InputManager::downKey() && teapot->numPatches() > 0)
+	{
+		teapot->RemovePatch(teapot->numPatches() - 1);
+		patchesChanged = true;
+	}
+	if (InputManager::upKey(true) && !InputManager::upKey() && teapot->numPatches() < Teapot::NUM_PATCHES)
+	{
+		Teapot::LoadPatch(teapot, teapot->AddPatch());
+		patchesChanged = true;
+	}
+
+	// G switches between tessellating on the cpu and evaluating the surface in the vertex shader
+	bool gpuToggled = InputManager::gKey(true) && !InputManager::gKey();
+	if (gpuToggled) teapot->gpuEvaluated(!teapot->gpuEvaluated());
+
+	// P overlaps tessellating the next frame with drawing this one
+	bool pipelineToggled = InputManager::pKey(true) && !InputManager::pKey();
+	if (pipelineToggled) teapot->pipelined(!teapot->pipelined());
+
+	teapot->Update(dt);
+	torus->Update(dt);
+	ring->Update();
+
+	if (pixelErrorChanged)
+		std::cout << "Pixel error " << PatchLod::pixelError() << ": " << teapot->numTriangles() << " triangles, "
+			<< StreamBuffer::bytesUploaded() << " bytes uploaded" << std::endl;
+	if (weldToggled && teapot->welded())
+		std::cout << "Welded: " << teapot->numWeldedVerts() << " vertices instead of " << teapot->numUnweldedVerts() << std::endl;
+	else if (weldToggled)
+		std::cout << "Unwelded" << std::endl;
+	if (gpuToggled)
+		std::cout << (teapot->gpuEvaluated() ? "Evaluating in the vertex shader" : "Tessellating on the cpu") << std::endl;
+	if (pipelineToggled)
+		std::cout << (teapot->pipelined() ? "Tessellating while the last frame is drawn" : "Tessellating before drawing") << std::endl;
+	if (patchesChanged)
+		std::cout << teapot->numPatches() << " patches in " << teapot->arena().numPages() << " arena pages, "
+			<< teapot->arena().usedVerts() << " of " << teapot->arena().capacityVerts() << " vertices used" << std::endl;
+
+	glm::mat4 viewProj = CameraManager::ViewProjMat();
+	RenderManager::Draw(viewProj);
+	StreamBuffer::EndFrame();
+	if (glStats) glStats->EndFrame();
+	AllocationTracker::EndFrame();
 
 	// Swap buffers
+	PROFILE_ZONE("SwapBuffers");
 	glfwSwapBuffers(window);
 }
+#endif
 
 void cleanUp()
 {
-	glDeleteProgram(shaderProgram);
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+#ifndef NURBS_HEADLESS
+	if (!headless)
+	{
+		glDeleteProgram(shaderProgram);
+		glDeleteProgram(instancedShaderProgram);
+		glDeleteProgram(bezierShaderProgram);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+	}
+#endif
 
-	glDeleteBuffers(1, &vbo);
-	glDeleteBuffers(1, &ebo0);
-	glDeleteBuffers(1, &ebo1);
-	glDeleteBuffers(1, &vao0);
-	glDeleteBuffers(1, &vao1);
+	RenderBackend::Get().DeleteBuffer(vbo);
+	RenderBackend::Get().DeleteBuffer(ebo0);
+	RenderBackend::Get().DeleteBuffer(ebo1);
+	RenderBackend::Get().DeleteVertexArray(vao0);
+	RenderBackend::Get().DeleteVertexArray(vao1);
 
 	RenderManager::DumpData();
 
+	delete torus;
+	delete ring;
 	delete teapot;
+
+	GridIndexRegistry::Release();
+	TaskPool::Shutdown();
+#ifndef NURBS_HEADLESS
+	if (glBackend && checkGlState)
+		std::cout << "GL state: " << glBackend->numSkipped() << " calls left out, " << glBackend->numDesyncs() << " desyncs" << std::endl;
+	glBackend = NULL;
+#endif
+
+	RenderBackend::Release();
+	glStats = NULL;
+
+	if (tracePath)
+	{
+		Profiler::PrintSummary(std::cout);
+		if (Profiler::WriteTrace(tracePath)) std::cout << "Wrote " << tracePath << std::endl;
+	}
+}
+
+// Updates and draws the teapot for a number of frames on the null backend and prints what it was asked to do
+void runHeadlessFrames(NullRenderBackend* backend, const char* mode, int frames)
+{
+	glm::mat4 viewProj = CameraManager::ViewProjMat();
+	backend->ResetCounters();
+
+	typedef std::chrono::high_resolution_clock Clock;
+	Clock::time_point start = Clock::now();
+
+	for (int i = 0; i < frames; ++i)
+	{
+		Profiler::BeginFrame();
+		PROFILE_ZONE("Frame");
+
+		CameraManager::Update(1.0f / 60.0f);
+		RenderManager::Update(1.0f / 60.0f);
+		teapot->Update(1.0f / 60.0f);
+		torus->Update(1.0f / 60.0f);
+		ring->Update();
+		RenderManager::Draw(viewProj);
+		StreamBuffer::EndFrame();
+		if (glStats) glStats->EndFrame();
+		AllocationTracker::EndFrame();
+	}
+
+	double ms = 1000.0 * std::chrono::duration<double>(Clock::now() - start).count();
+	std::cout << mode << ": " << backend->numDrawCalls() / frames << " draw calls, " << backend->numDraws() / frames << " draws, "
+		<< backend->numIndices() / frames << " indices, " << backend->bytesUploaded() / frames << " bytes uploaded, "
+		<< RenderManager::numStateChanges() << " state changes (" << RenderManager::numStateChangesSaved() << " saved), "
+		<< AllocationTracker::allocationsLastFrame() << " allocations in the last frame, " << ms / frames << " ms per frame" << std::endl;
+}
+
+void runHeadless(int frames)
+{
+	headless = true;
+	NullRenderBackend* backend = new NullRenderBackend();
+	setBackend(backend);
+
+	initMeshes();
+	initScene();
+	std::cout << "Vertex uploads: " << (StreamBuffer::persistent() ? "persistently mapped ring" : "glBufferSubData") << std::endl;
+
+	runHeadlessFrames(backend, "Separate patches", frames);
+
+	teapot->welded(true);
+	runHeadlessFrames(backend, "Welded", frames);
+	teapot->welded(false);
+
+	teapot->pipelined(true);
+	runHeadlessFrames(backend, "Pipelined", frames);
+	teapot->pipelined(false);
+
+	teapot->RemovePatch(teapot->numPatches() - 1);
+	runHeadlessFrames(backend, "One patch removed", frames);
+	Teapot::LoadPatch(teapot, teapot->AddPatch());
+	runHeadlessFrames(backend, "Patch added back", frames);
+
+	std::cout << backend->numBuffers() << " buffers holding " << backend->bufferBytes() << " bytes, "
+		<< backend->numVertexArrays() << " vertex arrays" << std::endl;
+
+	cleanUp();
+}
+
+// Runs frames of the teapot in every drawing mode on the null backend with all of its control points moving, and counts the
+// heap allocations made after the first few frames of each mode. Once the buffers have grown to fit, there should be none.
+bool verifyAllocations(int frames)
+{
+	const int WARM_UP_FRAMES = 8;
+
+	headless = true;
+	setBackend(new NullRenderBackend());
+
+	initMeshes();
+	initScene();
+
+	glm::mat4 viewProj = CameraManager::ViewProjMat();
+	int numPatches = teapot->numPatches();
+	std::vector<glm::vec3> original = std::vector<glm::vec3>();
+	for (int i = 0; i < numPatches; ++i)
+	{
+		original.insert(original.end(), teapot->patch(i).controlPoints(), teapot->patch(i).controlPoints() + 16);
+	}
+
+	const char* modeNames[] = { "Separate patches", "Welded", "Pipelined" };
+	long long totalAllocations = 0;
+	for (int mode = 0; mode < 3; ++mode)
+	{
+		teapot->welded(mode == 1);
+		teapot->pipelined(mode == 2);
+
+		long long allocations = 0;
+		long long bytes = 0;
+		for (int i = 0; i < WARM_UP_FRAMES + frames; ++i)
+		{
+			// Alternates between two sizes of the teapot, so every patch is re-tessellated every frame
+			GLfloat scale = (i & 1) ? 1.001f : 1.0f;
+			for (int p = 0; p < numPatches; ++p)
+			{
+				for (int k = 0; k < 16; ++k)
+				{
+					teapot->patch(p).SetControlPoint(k, original[p * 16 + k] * scale);
+				}
+			}
+
+			Profiler::BeginFrame();
+			{
+				PROFILE_ZONE("Frame");
+				CameraManager::Update(1.0f / 60.0f);
+				RenderManager::Update(1.0f / 60.0f);
+				teapot->Update(1.0f / 60.0f);
+				torus->Update(1.0f / 60.0f);
+				ring->Update();
+				RenderManager::Draw(viewProj);
+				StreamBuffer::EndFrame();
+				if (glStats) glStats->EndFrame();
+			}
+			AllocationTracker::EndFrame();
+
+			if (i >= WARM_UP_FRAMES)
+			{
+				allocations += AllocationTracker::allocationsLastFrame();
+				bytes += AllocationTracker::bytesLastFrame();
+			}
+		}
+
+		std::cout << modeNames[mode] << ": " << allocations << " allocations of " << bytes << " bytes in " << frames << " frames" << std::endl;
+		totalAllocations += allocations;
+	}
+
+	teapot->welded(false);
+	teapot->pipelined(false);
+	cleanUp();
+	return totalAllocations == 0;
 }
 
-int main()
+// Tessellates every teapot patch again as a cubic NurbsSurface with a single knot span and unit weights, which makes its
+// basis the Bernstein basis, and compares it with the Bezier evaluation. Then checks every vertex of the torus and the ring
+// lies on the circles they were built from, which only holds when the weights are applied right.
+bool verifyNurbs()
 {
+	const int NUM_VERTS = 32;
+	const GLfloat MAX_ERROR = 1.0e-4f;
+
+	headless = true;
+	setBackend(new NullRenderBackend());
+
+	initMeshes();
+	initScene();
+
+	Shader shader;
+	shader.shaderPointer = shaderProgram;
+	shader.uTransform = uTransform;
+	shader.uColor = uColor;
+
+	GLfloat bezierKnots[] = { 0, 0, 0, 0, 1, 1, 1, 1 };
+	std::vector<GLfloat> knots = std::vector<GLfloat>(bezierKnots, bezierKnots + 8);
+	NurbsSurface* surface = new NurbsSurface(shader, 3, 3, 4, 4, NUM_VERTS);
+	surface->SetKnotsU(knots);
+	surface->SetKnotsV(knots);
+
+	std::vector<GLfloat> nurbsVerts = std::vector<GLfloat>(NUM_VERTS * NUM_VERTS * 3);
+	std::vector<GLfloat> bezierVerts = std::vector<GLfloat>(NUM_VERTS * NUM_VERTS * 3);
+	const GLfloat* basis = BasisCache::Bernstein(3, NUM_VERTS);
+	int stride = BezierEvaluator::Stride(NUM_VERTS);
+
+	GLfloat patchError = 0.0f;
+	for (int p = 0; p < teapot->numPatches(); ++p)
+	{
+		// Patch control point k weights the k % 4th Bernstein function across a row and the k / 4th down the rows
+		const glm::vec3* controlPoints = teapot->patch(p).controlPoints();
+		for (int k = 0; k < 16; ++k)
+		{
+			surface->SetControlPoint(k % 4, k / 4, controlPoints[k]);
+		}
+		surface->Tessellate(&nurbsVerts[0]);
+		BezierEvaluator::EvaluatePatch(controlPoints, basis, stride, NUM_VERTS, &bezierVerts[0]);
+
+		for (int i = 0; i < NUM_VERTS * NUM_VERTS * 3; ++i)
+		{
+			patchError = glm::max(patchError, glm::abs(nurbsVerts[i] - bezierVerts[i]));
+		}
+	}
+	delete surface;
+	std::cout << "Teapot as NURBS: compared " << teapot->numPatches() * NUM_VERTS * NUM_VERTS << " vertices, largest difference "
+		<< patchError << std::endl;
+
+	// In the torus' own space, the distance to the circle through the middle of the tube is the tube's radius
+	std::vector<GLfloat> torusVerts = std::vector<GLfloat>(torus->numVerts() * torus->numVerts() * 3);
+	torus->Tessellate(&torusVerts[0]);
+	GLfloat torusError = 0.0f;
+	for (int i = 0; i < torus->numVerts() * torus->numVerts(); ++i)
+	{
+		glm::vec3 vert = glm::vec3(torusVerts[i * 3], torusVerts[i * 3 + 1], torusVerts[i * 3 + 2]);
+		GLfloat fromMiddle = glm::length(glm::vec2(vert.x, vert.z)) - torusMajorRadius;
+		torusError = glm::max(torusError, glm::abs(glm::length(glm::vec2(fromMiddle, vert.y)) - torusMinorRadius));
+	}
+	std::cout << "Torus: " << torus->numVerts() * torus->numVerts() << " vertices, largest distance from the surface " << torusError << std::endl;
+
+	std::vector<GLfloat> ringVerts = std::vector<GLfloat>(ring->numVerts() * 3);
+	ring->Tessellate(&ringVerts[0]);
+	GLfloat ringError = 0.0f;
+	for (int i = 0; i < ring->numVerts(); ++i)
+	{
+		glm::vec3 vert = glm::vec3(ringVerts[i * 3], ringVerts[i * 3 + 1], ringVerts[i * 3 + 2]);
+		ringError = glm::max(ringError, glm::abs(glm::length(vert) - ringRadius));
+	}
+	std::cout << "Ring: " << ring->numVerts() << " vertices, largest distance from the circle " << ringError << std::endl;
+
+	// An empty first or last span would put the ends of the range in a span whose basis divides zero by zero, and a zero
+	// weight would make the homogeneous divide do the same
+	GLfloat emptyLastSpan[] = { 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+	GLfloat emptyFirstSpan[] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f };
+	bool knotsRejected = !NurbsBasis::ValidKnots(1, 3, std::vector<GLfloat>(emptyLastSpan, emptyLastSpan + 5)) &&
+		!NurbsBasis::ValidKnots(1, 3, std::vector<GLfloat>(emptyFirstSpan, emptyFirstSpan + 5));
+	ring->SetControlPoint(0, glm::vec3(ringRadius, 0.0f, 0.0f), 0.0f);
+	glm::vec3 weightless = ring->Evaluate(0.0f);
+	bool weightsFinite = weightless == weightless;
+	std::cout << "Empty end spans " << (knotsRejected ? "rejected" : "accepted") << ", a zero weight evaluates to "
+		<< (weightsFinite ? "a point" : "NaN") << std::endl;
+
+	cleanUp();
+	return patchError < MAX_ERROR && torusError < MAX_ERROR && ringError < MAX_ERROR && knotsRejected && weightsFinite;
+}
+
+// Builds the teapot's topology from its control points, then again with the whole teapot moved across two cells of the
+// hash in small steps and every control point nudged by a different amount up to a quarter of the tolerance on each axis.
+// Points that coincide end up either side of a cell boundary at some step, and every build has to find the same edges
+// and corners as the first.
+bool verifyTopology()
+{
+	const GLfloat TOLERANCE = 0.0001f;
+	const int NUM_STEPS = 64;
+
+	int numPatches = Teapot::NUM_PATCHES;
+	std::vector<glm::vec3> controlPoints = std::vector<glm::vec3>(numPatches * 16);
+	for (int i = 0; i < numPatches * 16; ++i)
+	{
+		controlPoints[i] = glm::vec3(Teapot::controlPoints[i * 3], Teapot::controlPoints[i * 3 + 1], Teapot::controlPoints[i * 3 + 2]);
+	}
+
+	PatchTopology reference;
+	reference.Build(controlPoints, TOLERANCE);
+
+	PatchTopology topology;
+	std::vector<glm::vec3> moved = std::vector<glm::vec3>(controlPoints.size());
+	int numFailed = 0;
+	unsigned int random = 12345;
+	for (int step = 0; step < NUM_STEPS; ++step)
+	{
+		glm::vec3 offset = glm::vec3(step * TOLERANCE * 4.0f / NUM_STEPS);
+		for (unsigned int i = 0; i < moved.size(); ++i)
+		{
+			glm::vec3 nudge;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				random = random * 1664525u + 1013904223u;
+				nudge[axis] = ((random >> 8) / (GLfloat)(1 << 24) - 0.5f) * 0.5f * TOLERANCE;
+			}
+			moved[i] = controlPoints[i] + offset + nudge;
+		}
+		topology.Build(moved, TOLERANCE);
+
+		bool same = topology.numSharedEdges() == reference.numSharedEdges() &&
+			topology.numDegenerateEdges() == reference.numDegenerateEdges() &&
+			topology.numCornerVertices() == reference.numCornerVertices();
+		for (int p = 0; p < numPatches && same; ++p)
+		{
+			for (int e = 0; e < PatchTopology::NUM_EDGES; ++e)
+			{
+				same = same && topology.neighbour(p, e) == reference.neighbour(p, e) && topology.reversed(p, e) == reference.reversed(p, e) &&
+					topology.degenerate(p, e) == reference.degenerate(p, e);
+			}
+			for (int c = 0; c < PatchTopology::NUM_CORNERS; ++c)
+			{
+				same = same && topology.cornerVertex(p, c) == reference.cornerVertex(p, c);
+			}
+		}
+		if (!same)
+		{
+			std::cout << "Step " << step << ": " << topology.numSharedEdges() << " shared edges, " << topology.numDegenerateEdges()
+				<< " degenerate, " << topology.numCornerVertices() << " corner vertices" << std::endl;
+			++numFailed;
+		}
+	}
+
+	std::cout << "Teapot topology: " << reference.numSharedEdges() << " shared edges, " << reference.numDegenerateEdges() << " degenerate, "
+		<< reference.numBoundaryEdges() << " boundary, " << reference.numCornerVertices() << " corner vertices" << std::endl;
+	std::cout << NUM_STEPS - numFailed << " of " << NUM_STEPS << " moved copies matched it" << std::endl;
+	return numFailed == 0;
+}
+
+int main(int argc, char** argv)
+{
+	// Can follow any of the other options
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-profile") == 0)
+		{
+			tracePath = i + 1 < argc && argv[i + 1][0] != '-' ? argv[i + 1] : "trace.json";
+			Profiler::Enable();
+		}
+		if (strcmp(argv[i], "-gl-stats") == 0)
+			glStatsInterval = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[i + 1]) : 60;
+#ifndef NURBS_HEADLESS
+		if (strcmp(argv[i], "-check-gl-state") == 0)
+			checkGlState = true;
+#endif
+	}
+
+	// Runs the update and draw code for every mode without a window, on a backend that only counts what it is given
+	if (argc > 1 && strcmp(argv[1], "-headless") == 0)
+	{
+		runHeadless(argc > 2 && argv[2][0] != '-' ? atoi(argv[2]) : 100);
+		return 0;
+	}
+
+	// Fails when a frame allocates once the teapot has warmed up
+	if (argc > 1 && strcmp(argv[1], "-verify-allocations") == 0)
+	{
+		return verifyAllocations(argc > 2 && argv[2][0] != '-' ? atoi(argv[2]) : 100) ? 0 : 1;
+	}
+
+	// Fails when the NURBS code disagrees with the Bezier evaluation or with the circles the scene builds from it
+	if (argc > 1 && strcmp(argv[1], "-verify-nurbs") == 0)
+	{
+		return verifyNurbs() ? 0 : 1;
+	}
+
+	// Fails when moving the teapot's control points by less than the weld tolerance changes the topology found for it
+	if (argc > 1 && strcmp(argv[1], "-verify-topology") == 0)
+	{
+		return verifyTopology() ? 0 : 1;
+	}
+
+#ifdef NURBS_HEADLESS
+	std::cout << "Built without a window, run it with -headless, -verify-allocations, -verify-nurbs or -verify-topology" << std::endl;
+	return 1;
+#else
 	init();
 
+	// Checks the vertex shader evaluation against the cpu tessellation and exits, non-zero when they disagree
+	if (argc > 1 && strcmp(argv[1], "-verify-gpu") == 0)
+	{
+		int numVertsCompared = 0;
+		GLfloat maxError = teapot->VerifyGpuEvaluation(numVertsCompared);
+		std::cout << "Compared " << numVertsCompared << " vertices, largest difference " << maxError << std::endl;
+
+		cleanUp();
+		return maxError < 1.0e-4f ? 0 : 1;
+	}
+
 	while (!glfwWindowShouldClose(window))
 	{
 		step();
@@ -442,4 +984,5 @@ int main()
 	cleanUp();
 
 	return 0;
+#endif
 }
@@ -0,0 +1,98 @@
+#version 150
+
+// (u, v) of the grid vertex, the same buffer for every patch tessellated at this level
+in vec2 parameter;
+in int patchIndex;
+uniform mat4 transform;
+uniform vec4 color;
+
+// PATCH_TEXELS texels per patch: its 16 control points, then how many vertices each edge is sampled with when a coarser
+// neighbour shares it, 0 when it doesn't
+uniform samplerBuffer controlPoints;
+
+out vec4 Color;
+
+// Position on the patch before the transform, captured by transform feedback to check against the cpu
+out vec3 surfacePosition;
+
+const int PATCH_TEXELS = 17;
+
+vec4 Bernstein(float t)
+{
+	float s = 1.0 - t;
+	return vec4(s * s * s, 3.0 * t * s * s, 3.0 * t * t * s, t * t * t);
+}
+
+vec3 ControlPoint(int k)
+{
+	return texelFetch(controlPoints, patchIndex * PATCH_TEXELS + k).xyz;
+}
+
+vec3 Curve(vec3 p0, vec3 p1, vec3 p2, vec3 p3, float t)
+{
+	vec4 b = Bernstein(t);
+	return (b.x * p0 + b.y * p1) + (b.z * p2 + b.w * p3);
+}
+
+vec3 Surface(float u, float v)
+{
+	vec4 factors = Bernstein(v);
+	vec3 point = vec3(0.0);
+	for (int row = 0; row < 4; ++row)
+	{
+		point += factors[row] * Curve(ControlPoint(row * 4), ControlPoint(row * 4 + 1), ControlPoint(row * 4 + 2), ControlPoint(row * 4 + 3), u);
+	}
+	return point;
+}
+
+// Control points along the edges v = 0, v = 1, u = 0 and u = 1
+int EdgeControlPoint(int edge, int k)
+{
+	if (edge == 0) return k;
+	if (edge == 1) return 12 + k;
+	if (edge == 2) return k * 4;
+	return k * 4 + 3;
+}
+
+// Same as Patch::StitchEdge, the point t along an edge moved onto the straight segments between the samples the
+// neighbour takes
+vec3 StitchedEdge(int edge, float t, float edgeVerts)
+{
+	vec3 p0 = ControlPoint(EdgeControlPoint(edge, 0));
+	vec3 p1 = ControlPoint(EdgeControlPoint(edge, 1));
+	vec3 p2 = ControlPoint(EdgeControlPoint(edge, 2));
+	vec3 p3 = ControlPoint(EdgeControlPoint(edge, 3));
+
+	// Sampled from the same end as the neighbour does
+	bool reversed = p3.x < p0.x || (p3.x == p0.x && (p3.y < p0.y || (p3.y == p0.y && p3.z < p0.z)));
+	if (reversed)
+	{
+		vec3 swap = p0; p0 = p3; p3 = swap;
+		swap = p1; p1 = p2; p2 = swap;
+	}
+
+	float segments = edgeVerts - 1.0;
+	float s = t * segments;
+	float m = min(floor(s + 0.001), segments - 1.0);
+	float f = max(s - m, 0.0);
+
+	float first = reversed ? segments - m : m;
+	float last = reversed ? segments - m - 1.0 : m + 1.0;
+	return mix(Curve(p0, p1, p2, p3, first / segments), Curve(p0, p1, p2, p3, last / segments), f);
+}
+
+void main()
+{
+	vec3 point = Surface(parameter.x, parameter.y);
+
+	// The cpu stitches the edges in order, so the last one wins at the corners
+	vec4 edgeVerts = texelFetch(controlPoints, patchIndex * PATCH_TEXELS + 16);
+	if (edgeVerts.w > 0.0 && parameter.x == 1.0) point = StitchedEdge(3, parameter.y, edgeVerts.w);
+	else if (edgeVerts.z > 0.0 && parameter.x == 0.0) point = StitchedEdge(2, parameter.y, edgeVerts.z);
+	else if (edgeVerts.y > 0.0 && parameter.y == 1.0) point = StitchedEdge(1, parameter.x, edgeVerts.y);
+	else if (edgeVerts.x > 0.0 && parameter.y == 0.0) point = StitchedEdge(0, parameter.x, edgeVerts.x);
+
+	surfacePosition = point;
+	Color = color;
+	gl_Position = transform * vec4(point, 1.0);
+}
\ No newline at end of file
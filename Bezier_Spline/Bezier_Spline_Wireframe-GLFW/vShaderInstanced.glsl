@@ -0,0 +1,14 @@
+#version 150
+
+in vec3 position;
+in mat4 instanceModel;
+in vec4 instanceColor;
+uniform mat4 transform;
+
+out vec4 Color;
+
+void main()
+{
+	Color = instanceColor;
+	gl_Position = transform * instanceModel * vec4(position, 1.0);
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
-#include <GLEW\GL\glew.h>
-#include <GLM\gtc\matrix_transform.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <vector>
 
 class InteractiveShape;
 class RenderShape;
@@ -29,4 +30,8 @@ private:
 	GLuint _ebo;
 	int _numVerts;
 	int _maxNumVerts;
+
+	// Kept between calls to UpdateCurve so it doesn't reallocate
+	std::vector<GLfloat> _data;
+	std::vector<GLint> _elements;
 };
\ No newline at end of file
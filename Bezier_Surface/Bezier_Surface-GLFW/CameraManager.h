@@ -1,7 +1,7 @@
 #pragma once
 
-#include <GLM\gtc\type_ptr.hpp>
-#include <GLM\gtc\matrix_transform.hpp>
+#include <GLM/gtc/type_ptr.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
 
 class CameraManager
 {
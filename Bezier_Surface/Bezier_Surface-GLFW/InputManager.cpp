@@ -1,4 +1,5 @@
 #include "InputManager.h"
+#include "Profiler.h"
 
 double InputManager::_mousePos[2];
 
@@ -44,6 +45,8 @@ void InputManager::Init(GLFWwindow* window)
 
 void InputManager::Update()
 {
+	PROFILE_ZONE("InputManager::Update");
+
 	_prevLeftMouseButton = _leftMouseButton;
 	_leftMouseButton = glfwGetMouseButton(_window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
 	glfwGetCursorPos(_window, &_mousePos[0], &_mousePos[1]);
@@ -1,7 +1,7 @@
 #pragma once
-#include <GLEW\GL\glew.h>
-#include <GLFW\glfw3.h>
-#include <GLM\glm.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <GLM/glm.hpp>
 
 class InputManager
 {
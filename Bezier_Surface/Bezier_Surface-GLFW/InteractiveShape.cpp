@@ -2,8 +2,8 @@
 #include "InputManager.h"
 
 InteractiveShape::InteractiveShape(Collider collider, GLint vao, GLsizei count, GLenum mode, Shader shader, glm::vec4 color)
+	: RenderShape(vao, count, mode, shader, color)
 {
-	this->RenderShape::RenderShape(vao, count, mode, shader, color);
 	_collider = collider;
 	_mouseOver = false;
 	_selected = false;
@@ -34,20 +34,16 @@ void InteractiveShape::Update(float dt)
 		dz -= (InputManager::sKey()) * moveRate * dt;
 		dz += (InputManager::wKey()) * moveRate * dt;
 
-		_transform.position += glm::vec3(dx, dy, dz);
+		if (dx != 0.0f || dy != 0.0f || dz != 0.0f) _transform.position(_transform.position() + glm::vec3(dx, dy, dz));
 
 		_moved = (dx != 0.0f && dy != 0.0f && dz != 0.0f);
 
 		_currentColor =  _color + glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
 	}
 
-	// Constrain position to the world
-	_transform.position.x = _transform.position.x > 1.0f ? 1.0f : _transform.position.x;
-	_transform.position.x = _transform.position.x < -1.0f ? -1.0f : _transform.position.x;
-	_transform.position.y = _transform.position.y > 1.0f ? 1.0f : _transform.position.y;
-	_transform.position.y = _transform.position.y < -1.0f ? -1.0f : _transform.position.y;
-	_transform.position.z = _transform.position.z > 1.0f ? 1.0f : _transform.position.z;
-	_transform.position.z = _transform.position.z < -1.0f ? -1.0f : _transform.position.z;
+	// Constrain position to the world, only setting it when it was outside so a shape standing still stays clean
+	glm::vec3 constrained = glm::clamp(_transform.position(), glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(1.0f, 1.0f, 1.0f));
+	if (constrained != _transform.position()) _transform.position(constrained);
 }
 
 void InteractiveShape::Draw(const glm::mat4& viewProjMat)
@@ -58,8 +54,8 @@ void InteractiveShape::Draw(const glm::mat4& viewProjMat)
 const Collider& InteractiveShape::collider()
 {
 	Collider ret = _collider;
-	ret.x += _transform.position.x;
-	ret.y += _transform.position.y;
+	ret.x += _transform.position().x;
+	ret.y += _transform.position().y;
 	return ret;
 }
 
@@ -1,10 +1,13 @@
 #pragma once
-#include <GLEW\GL\glew.h>
-#include <GLM\gtc\matrix_transform.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
 #include <vector>
 
+#include "PatchLod.h"
+
 class InteractiveShape;
 class RenderShape;
+class StreamBuffer;
 
 class Patch
 {
@@ -14,27 +17,27 @@ public:
 
 	void Update();
 
+	int level();
+	int numTriangles();
 private:
 	void UpdateShapes();
 	void UpdateSurface();
 	void GeneratePlane();
-	void AddVert(GLfloat x, GLfloat y, GLfloat z, GLfloat u, GLfloat v, int vertNum);
-	void AddFace(GLint a, GLint b, GLint c, int faceNum);
+	void AddFace(GLint a, GLint b, GLint c, std::vector<GLuint>& elements);
 private:
 	glm::vec3 _controlPoints[16];
 	InteractiveShape* _controlPointMarkers[16];
 	RenderShape* _slopeLines[8];
 	RenderShape* _curve;
-	GLuint _vao;
-	GLuint _vbo;
-	GLuint _ebo;
+	// One index buffer per level of detail, all of them index into the same stream buffer
+	GLuint _vao[PatchLod::NUM_LEVELS];
+	GLuint _ebo[PatchLod::NUM_LEVELS];
+	StreamBuffer* _stream;
 
-	static const int NUM_VERTS = 10;
-	static const int NUM_VERTS_STORED = NUM_VERTS * NUM_VERTS * 3;
-	static const int NUM_ELEMENTS = (NUM_VERTS - 1) * (NUM_VERTS - 1) * 6;
+	// Shared with every other patch, owned by BasisCache
+	const GLfloat* _basis[PatchLod::NUM_LEVELS];
 
-	GLfloat _verts[NUM_VERTS_STORED];
-	GLuint _elements[NUM_ELEMENTS];
+	int _level;
 
 	bool _controlPointsActive;
 };
\ No newline at end of file
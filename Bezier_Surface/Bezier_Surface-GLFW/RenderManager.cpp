@@ -1,9 +1,11 @@
 #include "RenderManager.h"
 #include "RenderShape.h"
+#include "TransformManager.h"
 #include "InteractiveShape.h"
 #include "Init_Shader.h"
 #include "InputManager.h"
-#include <GLM\gtc\random.hpp>
+#include "Profiler.h"
+#include <GLM/gtc/random.hpp>
 
 std::vector<RenderShape*> RenderManager::_shapes = std::vector<RenderShape*>();
 std::vector<InteractiveShape*> RenderManager::_interactiveShapes = std::vector<InteractiveShape*>();
@@ -38,6 +40,11 @@ void RenderManager::AddShape(InteractiveShape* shape)
 
 void RenderManager::Update(float dt)
 {
+	PROFILE_ZONE("RenderManager::Update");
+
+	// Only the transforms with a velocity are integrated, all of them in one pass
+	TransformManager::Integrate(dt);
+
 	// Select a shape
 	unsigned int size = _interactiveShapes.size();
 	if (size)
@@ -49,7 +56,6 @@ void RenderManager::Update(float dt)
 		_selectedShape %= _interactiveShapes.size();
 		_interactiveShapes[_selectedShape]->selected(true);
 	}
-	std::vector<InteractiveShape*>& moused = std::vector<InteractiveShape*>();
 	unsigned int numShapes = _shapes.size();
 	for (unsigned int i = 0; i < numShapes; ++i)
 	{
@@ -64,6 +70,11 @@ void RenderManager::Update(float dt)
 
 void RenderManager::Draw(glm::mat4& viewProjMat)
 {
+	PROFILE_ZONE("RenderManager::Draw");
+
+	// Every shape only reads its model matrix, whatever moved since the last frame is rebuilt here in parent order
+	TransformManager::Update();
+
 	unsigned int numShapes = _shapes.size();
 	for (unsigned int i = 0; i < numShapes; ++i)
 	{
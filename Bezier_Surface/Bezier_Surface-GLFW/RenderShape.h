@@ -1,41 +1,10 @@
 #pragma once
 
-#include <GLEW\GL\glew.h>
-#include <GLM\gtc\matrix_transform.hpp>
-#include <GLM\gtc\quaternion.hpp>
-#include <GLM\gtc\type_ptr.hpp>
-
-struct Transform
-{
-	glm::vec3 position;
-	glm::vec3 rotationOrigin;
-	glm::quat rotation;
-	glm::vec3 scale;
-	glm::vec3 scaleOrigin;
-
-	glm::vec3 linearVelocity;
-	glm::quat angularVelocity;
-
-	glm::mat4 modelMat;
-
-	Transform* parent;
-
-	Transform()
-	{
-		position = glm::vec3();
-		rotationOrigin = glm::vec3();
-		rotation = glm::quat();
-		scale = glm::vec3(1.0f, 1.0f, 1.0f);
-		scaleOrigin = glm::vec3();
-
-		linearVelocity = glm::vec3();
-		angularVelocity = glm::quat();
-
-		modelMat = glm::mat4();
-
-		parent = (Transform*)nullptr;
-	}
-};
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include <GLM/gtc/type_ptr.hpp>
+#include "Transform.h"
 
 struct Shader
 {
@@ -64,8 +33,12 @@ public:
 	glm::vec4& currentColor();
 	Transform& transform();
 	GLint vao();
+	void vao(GLint newVao);
 	GLsizei count();
 	void count(GLsizei newSize);
+	// Added to every index, for vertex buffers that hold more than one version of the data
+	GLint baseVertex();
+	void baseVertex(GLint newBaseVertex);
 	GLenum mode();
 	Shader shader();
 	bool& active();
@@ -74,6 +47,7 @@ private:
 
 	GLint _vao;
 	GLsizei _count;
+	GLint _baseVertex;
 	GLenum _mode;
 	Shader _shader;
 
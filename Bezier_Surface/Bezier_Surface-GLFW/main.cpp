@@ -42,6 +42,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *	- Holds the instance data for a shape that can be rendered to the screen. This includes a transform, a vao, a shader, the drawing
 *	mode (eg triangles, lines), it's active state, and its color
 *
+*	TransformManager
+*	- Holds the position, rotation and scale of every Transform in arrays ordered parents first, and the velocities of just the
+*	ones that move. Once a frame the moving ones are integrated in one pass, and before anything is drawn it rebuilds the model
+*	matrices of the transforms that changed and of their children, so shapes only read a finished matrix.
+*
 *	InteractiveShape
 *	- Inherits from RenderShape, possessing all the same properties. Additionally, it has a collider and can use it to check collisions against
 *	world boundries, other colliders, and the cursor.
@@ -52,15 +57,64 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *	Patch
 *	- Holds data for the Bezier surface and the helper shapes that go along with it. Generates and dynamically adjusts the vertices of the surface
 *	based on the positions of the control points and the mathematical function above.
+*
+*	BezierEvaluator
+*	- Contains static functions that evaluate cubic curves and patches several parameters at a time. The SSE2 or AVX2 version is picked
+*	at startup depending on what the cpu supports, with a plain C++ version as the fallback.
+*
+*	BasisCache
+*	- Builds each sampled Bernstein basis table once and hands the same read-only copy to every curve and patch that asks for it.
+*
+*	PatchLod
+*	- Picks how many vertices the patch is tessellated with every frame, from the projected size of its control net and an error
+*	budget in pixels. Up and down change the budget.
+*
+*	StreamBuffer
+*	- Vertex buffer for tessellated data that changes while the gpu may still be drawing the old version. Writes go into a fenced ring
+*	of persistently mapped regions when ARB_buffer_storage is available, and through glBufferSubData of the changed bytes otherwise.
+*
+*	RenderBackend
+*	- Everything the shapes and buffers ask of the graphics api goes through it. GLRenderBackend passes the calls on to GL,
+*	NullRenderBackend only counts the buffers and draws it is given. Running the program with -headless [frames] updates and
+*	draws the patch at every pixel error without a window or a GL context.
+*
+*	GLRenderBackend
+*	- Remembers the program, vao, buffer bindings, depth test and uniform values it last set and leaves out every call that would
+*	set them to what they already are. Run the program with -check-gl-state to have it read each remembered value back with
+*	glGet* before relying on it, log any that GL disagrees with, and print how many calls were left out on exit.
+*
+*	Profiler
+*	- Times named zones of each frame, like the input, the updates and the draws. Run the program with -profile [trace.json]
+*	to print the p50, p95 and p99 time of each zone every 256 frames and write every zone as a trace for chrome://tracing or
+*	Perfetto on exit. Without it the zones are skipped, and defining NO_PROFILER compiles them out.
+*
+*	CountingRenderBackend
+*	- Sits between the code and another backend and counts the draw calls, vao and program binds, depth test changes, uniforms
+*	and uploads of every frame, and which binds and changes set what was already set. Run the program with -gl-stats [frames]
+*	to log the average per frame every that many frames, 60 by default. Under -headless it counts the calls made to the null
+*	backend.
+*
+*	AllocationTracker
+*	- Counts every heap allocation through a replacement operator new, per frame and per Profiler zone. The update and draw
+*	code keeps its scratch memory between frames so a frame that has warmed up allocates nothing. Running the program with
+*	-verify-allocations [frames] runs the patch at every pixel error on the null backend and fails if any frame after the first
+*	few allocates.
+*
+*	Core
+*	- Init_Shader, the render backends, StreamBuffer, BezierEvaluator, BasisCache, Profiler, AllocationTracker, PatchLod,
+*	Transform and TransformManager live in Core at the root of the repository, shared by the examples. The CMakeLists.txt
+*	there builds them as the NurbsCore library, which never links GL, and builds each example on top of it.
 */
-#include <GLEW\GL\glew.h>
-#include <GLFW\glfw3.h>
-#include <GLM\gtc\type_ptr.hpp>
-#include <GLM\gtc\matrix_transform.hpp>
-#include <GLM\gtc\quaternion.hpp>
-#include <GLM\gtc\random.hpp>
+#include <GLEW/GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <GLM/gtc/type_ptr.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include <GLM/gtc/random.hpp>
 #include <iostream>
 #include <ctime>
+#include <chrono>
+#include <cstring>
 
 #include "RenderShape.h"
 #include "InteractiveShape.h"
@@ -69,9 +123,31 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "InputManager.h"
 #include "Patch.h"
 #include "CameraManager.h"
+#include "PatchLod.h"
+#include "StreamBuffer.h"
+#include "RenderBackend.h"
+#include "GLRenderBackend.h"
+#include "NullRenderBackend.h"
+#include "CountingRenderBackend.h"
+#include "Profiler.h"
+#include "AllocationTracker.h"
 
 GLFWwindow* window;
 
+// Set by -headless, there are no shaders and no window to clean up
+bool headless = false;
+
+// Set by -profile, where the trace goes when the program exits
+const char* tracePath = NULL;
+
+// Set by -gl-stats, the layer counting the GL calls of every frame and how many frames go into each log
+CountingRenderBackend* glStats = NULL;
+int glStatsInterval = 0;
+
+// Set by -check-gl-state, the GL backend reads back what it remembers before relying on it
+bool checkGlState = false;
+GLRenderBackend* glBackend = NULL;
+
 GLuint vertexShader;
 GLuint fragmentShader;
 GLuint shaderProgram;
@@ -130,28 +206,75 @@ Patch* bezierSurface;
 
 void initShaders()
 {
-	char* shaders[] = { "fshader.glsl", "vshader.glsl" };
+	char* shaders[] = { "fShader.glsl", "vShader.glsl" };
 	GLenum types[] = { GL_FRAGMENT_SHADER, GL_VERTEX_SHADER };
 	int numShaders = 2;
 	
 	shaderProgram = initShaders(shaders, types, numShaders);
-	
-	// Bind buffer data to shader values
-	posAttrib = glGetAttribLocation(shaderProgram, "position");
-	glEnableVertexAttribArray(posAttrib);
-	glVertexAttribPointer(posAttrib, 3, GL_FLOAT, GL_FALSE, 0, 0);
 
 	uTransform = glGetUniformLocation(shaderProgram, "transform");
 	uColor = glGetUniformLocation(shaderProgram, "color");
 }
 
+void initMeshes()
+{
+	RenderBackend& backend = RenderBackend::Get();
+
+	// Store the data for the triangles in a buffer that the gpu can use to draw
+	vbo = backend.CreateBuffer(sizeof(vertices), vertices, GL_STATIC_DRAW);
+	ebo0 = backend.CreateBuffer(sizeof(elements), elements, GL_STATIC_DRAW);
+	ebo1 = backend.CreateBuffer(sizeof(outlineElements), outlineElements, GL_STATIC_DRAW);
+
+	// Bind buffer data to shader values
+	posAttrib = backend.AttribLocation(shaderProgram, "position");
+
+	vao0 = backend.CreateVertexArray(ebo0);
+	backend.VertexAttribute(vao0, vbo, posAttrib, 3, 0, 0);
+
+	vao1 = backend.CreateVertexArray(ebo1);
+	backend.VertexAttribute(vao1, vbo, posAttrib, 3, 0, 0);
+}
+
+void initScene()
+{
+	Shader shader;
+	shader.shaderPointer = shaderProgram;
+	shader.uTransform = uTransform;
+	shader.uColor = uColor;
+
+	time_t timer;
+	time(&timer);
+	srand((unsigned int)timer);
+
+	Collider collider;
+	collider.height = 0.05f;
+	collider.width = 0.05f;
+	InteractiveShape markerTemplate = InteractiveShape(collider, vao0, 36, GL_TRIANGLES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
+	RenderShape slopeLineTemplate = RenderShape(vao1, 2, GL_LINES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
+	bezierSurface = new Patch(markerTemplate, slopeLineTemplate);
+
+	CameraManager::Init(800.0f / 600.0f, 60.0f, 0.1f, 100.0f);
+	PatchLod::screenSize(glm::vec2(800.0f, 600.0f));
+}
+
+// Puts backend under the layer counting its calls when -gl-stats asked for them
+void setBackend(RenderBackend* backend)
+{
+	if (glStatsInterval > 0)
+	{
+		glStats = new CountingRenderBackend(backend, glStatsInterval);
+		backend = glStats;
+	}
+	RenderBackend::Set(backend);
+}
+
 void init()
 {
 	if (!glfwInit()) exit(EXIT_FAILURE);
 
 	//Create window
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 
 	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 
@@ -163,58 +286,30 @@ void init()
 	glewExperimental = true;
 	glewInit();
 
-	// Store the data for the triangles in a buffer that the gpu can use to draw
-	glGenVertexArrays(1, &vao0);
-	glBindVertexArray(vao0);
-
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &ebo0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo0);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements), elements, GL_STATIC_DRAW);
+	glBackend = new GLRenderBackend(checkGlState);
+	setBackend(glBackend);
 
 	// Compile shaders
 	initShaders();
-
-	glGenVertexArrays(1, &vao1);
-	glBindVertexArray(vao1);
-
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &ebo1);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo1);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(outlineElements), outlineElements, GL_STATIC_DRAW);
-
-	initShaders();
+	initMeshes();
 
 	glfwSetTime(0.0);
 
-	Shader shader;
-	shader.shaderPointer = shaderProgram;
-	shader.uTransform = uTransform;
-	shader.uColor = uColor;
-
-	time_t timer;
-	time(&timer);
-	srand((unsigned int)timer);
-
-	Collider collider;
-	collider.height = 0.05f;
-	collider.width = 0.05f;
-	bezierSurface = new Patch(InteractiveShape(collider, vao0, 36, GL_TRIANGLES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f)), RenderShape(vao1, 2, GL_LINES, shader, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f)));
-
+	initScene();
 	InputManager::Init(window);
-	CameraManager::Init(800.0f / 600.0f, 60.0f, 0.1f, 100.0f);
 
 	glEnable(GL_DEPTH_TEST);
 }
 
 void step()
 {
+	Profiler::BeginFrame();
+	PROFILE_ZONE("Frame");
+
+	// Once every frame in the ring is new
+	if (tracePath && Profiler::frame() > 1 && (Profiler::frame() - 1) % Profiler::NUM_FRAMES == 0)
+		Profiler::PrintSummary(std::cout);
+
 	// Clear to black
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -229,33 +324,186 @@ void step()
 
 	RenderManager::Update(dt);
 
+	// Up and down tighten or loosen the pixel error the patch is tessellated to
+	GLfloat pixelError = PatchLod::pixelError();
+	if (InputManager::downKey(true) && !InputManager::downKey()) pixelError *= 2.0f;
+	if (InputManager::upKey(true) && !InputManager::upKey()) pixelError /= 2.0f;
+	bool pixelErrorChanged = pixelError != PatchLod::pixelError();
+	PatchLod::pixelError(glm::clamp(pixelError, 0.0625f, 16.0f));
+
 	bezierSurface->Update();
 
-	RenderManager::Draw(CameraManager::ViewProjMat());
+	if (pixelErrorChanged)
+		std::cout << "Pixel error " << PatchLod::pixelError() << ": " << bezierSurface->numTriangles() << " triangles, "
+			<< StreamBuffer::bytesUploaded() << " bytes uploaded" << std::endl;
+
+	glm::mat4 viewProj = CameraManager::ViewProjMat();
+	RenderManager::Draw(viewProj);
+	StreamBuffer::EndFrame();
+	if (glStats) glStats->EndFrame();
+	AllocationTracker::EndFrame();
 
 	// Swap buffers
+	PROFILE_ZONE("SwapBuffers");
 	glfwSwapBuffers(window);
 }
 
 void cleanUp()
 {
-	glDeleteProgram(shaderProgram);
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+	if (!headless)
+	{
+		glDeleteProgram(shaderProgram);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+	}
 
-	glDeleteBuffers(1, &vbo);
-	glDeleteBuffers(1, &ebo0);
-	glDeleteBuffers(1, &ebo1);
-	glDeleteBuffers(1, &vao0);
-	glDeleteBuffers(1, &vao1);
+	RenderBackend::Get().DeleteBuffer(vbo);
+	RenderBackend::Get().DeleteBuffer(ebo0);
+	RenderBackend::Get().DeleteBuffer(ebo1);
+	RenderBackend::Get().DeleteVertexArray(vao0);
+	RenderBackend::Get().DeleteVertexArray(vao1);
 
 	RenderManager::DumpData();
 
 	delete bezierSurface;
+
+	if (glBackend && checkGlState)
+		std::cout << "GL state: " << glBackend->numSkipped() << " calls left out, " << glBackend->numDesyncs() << " desyncs" << std::endl;
+
+	RenderBackend::Release();
+	glStats = NULL;
+	glBackend = NULL;
+
+	if (tracePath)
+	{
+		Profiler::PrintSummary(std::cout);
+		if (Profiler::WriteTrace(tracePath)) std::cout << "Wrote " << tracePath << std::endl;
+	}
 }
 
-int main()
+// Updates and draws the patch for a number of frames at every pixel error on a backend that only counts what it is given
+void runHeadless(int frames)
 {
+	headless = true;
+	NullRenderBackend* backend = new NullRenderBackend();
+	setBackend(backend);
+
+	initMeshes();
+	initScene();
+
+	glm::mat4 viewProj = CameraManager::ViewProjMat();
+	for (GLfloat pixelError = 16.0f; pixelError >= 0.0625f; pixelError /= 4.0f)
+	{
+		PatchLod::pixelError(pixelError);
+		backend->ResetCounters();
+
+		typedef std::chrono::high_resolution_clock Clock;
+		Clock::time_point start = Clock::now();
+
+		for (int i = 0; i < frames; ++i)
+		{
+			Profiler::BeginFrame();
+			PROFILE_ZONE("Frame");
+
+			CameraManager::Update(1.0f / 60.0f);
+			RenderManager::Update(1.0f / 60.0f);
+			bezierSurface->Update();
+			RenderManager::Draw(viewProj);
+			StreamBuffer::EndFrame();
+			if (glStats) glStats->EndFrame();
+			AllocationTracker::EndFrame();
+		}
+
+		double ms = 1000.0 * std::chrono::duration<double>(Clock::now() - start).count();
+		std::cout << "Pixel error " << pixelError << ": " << bezierSurface->numTriangles() << " triangles, "
+			<< backend->numDraws() / frames << " draws, " << backend->bytesUploaded() / frames << " bytes uploaded, "
+			<< AllocationTracker::allocationsLastFrame() << " allocations in the last frame, " << ms / frames << " ms per frame" << std::endl;
+	}
+
+	std::cout << backend->numBuffers() << " buffers holding " << backend->bufferBytes() << " bytes, "
+		<< backend->numVertexArrays() << " vertex arrays" << std::endl;
+
+	cleanUp();
+}
+
+// Tessellates the patch every frame at every pixel error on the null backend, and counts the heap allocations made after
+// the first few frames of each. Once the buffers have grown to fit, there should be none.
+bool verifyAllocations(int frames)
+{
+	const int WARM_UP_FRAMES = 8;
+
+	headless = true;
+	setBackend(new NullRenderBackend());
+
+	initMeshes();
+	initScene();
+
+	glm::mat4 viewProj = CameraManager::ViewProjMat();
+	long long totalAllocations = 0;
+	for (GLfloat pixelError = 16.0f; pixelError >= 0.0625f; pixelError /= 4.0f)
+	{
+		PatchLod::pixelError(pixelError);
+
+		long long allocations = 0;
+		long long bytes = 0;
+		for (int i = 0; i < WARM_UP_FRAMES + frames; ++i)
+		{
+			Profiler::BeginFrame();
+			{
+				PROFILE_ZONE("Frame");
+				CameraManager::Update(1.0f / 60.0f);
+				RenderManager::Update(1.0f / 60.0f);
+				bezierSurface->Update();
+				RenderManager::Draw(viewProj);
+				StreamBuffer::EndFrame();
+				if (glStats) glStats->EndFrame();
+			}
+			AllocationTracker::EndFrame();
+
+			if (i >= WARM_UP_FRAMES)
+			{
+				allocations += AllocationTracker::allocationsLastFrame();
+				bytes += AllocationTracker::bytesLastFrame();
+			}
+		}
+
+		std::cout << "Pixel error " << pixelError << ": " << allocations << " allocations of " << bytes << " bytes in " << frames << " frames" << std::endl;
+		totalAllocations += allocations;
+	}
+
+	cleanUp();
+	return totalAllocations == 0;
+}
+
+int main(int argc, char** argv)
+{
+	// Can follow any of the other options
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-profile") == 0)
+		{
+			tracePath = i + 1 < argc && argv[i + 1][0] != '-' ? argv[i + 1] : "trace.json";
+			Profiler::Enable();
+		}
+		if (strcmp(argv[i], "-gl-stats") == 0)
+			glStatsInterval = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[i + 1]) : 60;
+		if (strcmp(argv[i], "-check-gl-state") == 0)
+			checkGlState = true;
+	}
+
+	// Runs the update and draw code without a window, on a backend that only counts what it is given
+	if (argc > 1 && strcmp(argv[1], "-headless") == 0)
+	{
+		runHeadless(argc > 2 && argv[2][0] != '-' ? atoi(argv[2]) : 100);
+		return 0;
+	}
+
+	// Fails when a frame allocates once the patch has warmed up
+	if (argc > 1 && strcmp(argv[1], "-verify-allocations") == 0)
+	{
+		return verifyAllocations(argc > 2 && argv[2][0] != '-' ? atoi(argv[2]) : 100) ? 0 : 1;
+	}
+
 	init();
 
 	while (!glfwWindowShouldClose(window))
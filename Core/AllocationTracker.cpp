@@ -0,0 +1,46 @@
+#include "AllocationTracker.h"
+
+#include <cstdlib>
+#include <new>
+
+std::atomic<long long> AllocationTracker::_numAllocations(0);
+std::atomic<long long> AllocationTracker::_bytesAllocated(0);
+
+long long AllocationTracker::_frameStartAllocations = 0;
+long long AllocationTracker::_frameStartBytes = 0;
+long long AllocationTracker::_allocationsLastFrame = 0;
+long long AllocationTracker::_bytesLastFrame = 0;
+
+long long AllocationTracker::numAllocations() { return _numAllocations.load(std::memory_order_relaxed); }
+long long AllocationTracker::bytesAllocated() { return _bytesAllocated.load(std::memory_order_relaxed); }
+
+void AllocationTracker::EndFrame()
+{
+	long long allocations = numAllocations();
+	long long bytes = bytesAllocated();
+	_allocationsLastFrame = allocations - _frameStartAllocations;
+	_bytesLastFrame = bytes - _frameStartBytes;
+	_frameStartAllocations = allocations;
+	_frameStartBytes = bytes;
+}
+
+long long AllocationTracker::allocationsLastFrame() { return _allocationsLastFrame; }
+long long AllocationTracker::bytesLastFrame() { return _bytesLastFrame; }
+
+void AllocationTracker::Allocated(size_t size)
+{
+	_numAllocations.fetch_add(1, std::memory_order_relaxed);
+	_bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+}
+
+// Replaced for the whole program, the memory still comes from malloc
+void* operator new(size_t size)
+{
+	AllocationTracker::Allocated(size);
+	void* memory = malloc(size > 0 ? size : 1);
+	if (!memory) throw std::bad_alloc();
+	return memory;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* memory) throw() { free(memory); }
+void operator delete[](void* memory) throw() { free(memory); }
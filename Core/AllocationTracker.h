@@ -0,0 +1,30 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Counts every heap allocation the program makes on any thread, through a replacement of the global operator new that
+// still allocates from malloc. The totals only ever grow, EndFrame keeps what the frame before it added so the frame loop
+// can be held to none once it has warmed up. Profiler zones also record the allocations made while they ran.
+class AllocationTracker
+{
+public:
+	// Since the program started
+	static long long numAllocations();
+	static long long bytesAllocated();
+
+	// Closes the counts of this frame
+	static void EndFrame();
+	static long long allocationsLastFrame();
+	static long long bytesLastFrame();
+
+	// Called by operator new for every allocation
+	static void Allocated(size_t size);
+private:
+	static std::atomic<long long> _numAllocations;
+	static std::atomic<long long> _bytesAllocated;
+
+	static long long _frameStartAllocations;
+	static long long _frameStartBytes;
+	static long long _allocationsLastFrame;
+	static long long _bytesLastFrame;
+};
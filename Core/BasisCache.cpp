@@ -0,0 +1,103 @@
+#include "BasisCache.h"
+#include "BezierEvaluator.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	struct Key
+	{
+		int degree;
+		int numSamples;
+		int derivative;
+
+		bool operator<(const Key& other) const
+		{
+			if (degree != other.degree) return degree < other.degree;
+			if (numSamples != other.numSamples) return numSamples < other.numSamples;
+			return derivative < other.derivative;
+		}
+	};
+
+	// Map nodes never move, so the vectors inside them keep their storage for the life of the program
+	std::map<Key, std::vector<GLfloat> > _tables;
+	std::mutex _tablesMutex;
+
+	double Binomial(int n, int k)
+	{
+		double result = 1.0;
+		for (int i = 1; i <= k; ++i)
+		{
+			result = result * (n - k + i) / i;
+		}
+		return result;
+	}
+
+	double Power(double base, int exponent)
+	{
+		double result = 1.0;
+		for (int i = 0; i < exponent; ++i) result *= base;
+		return result;
+	}
+
+	// B(k, n) at t, zero outside 0 <= k <= n
+	double BernsteinValue(int k, int n, double t)
+	{
+		if (k < 0 || k > n) return 0.0;
+		return Binomial(n, k) * Power(t, k) * Power(1.0 - t, n - k);
+	}
+}
+
+const GLfloat* BasisCache::Bernstein(int degree, int numSamples, int derivative)
+{
+	// An empty table has no first element to point at
+	if (numSamples <= 0 || degree < 0)
+		return NULL;
+
+	Key key = { degree, numSamples, derivative };
+
+	std::lock_guard<std::mutex> lock(_tablesMutex);
+	std::map<Key, std::vector<GLfloat> >::iterator itr = _tables.find(key);
+	if (itr != _tables.end()) return &itr->second[0];
+
+	std::vector<GLfloat>& table = _tables[key];
+	table.resize(BezierEvaluator::Stride(numSamples) * (degree + 1));
+	Build(degree, numSamples, derivative, &table[0]);
+	return &table[0];
+}
+
+int BasisCache::numTables()
+{
+	std::lock_guard<std::mutex> lock(_tablesMutex);
+	return _tables.size();
+}
+
+void BasisCache::Build(int degree, int numSamples, int derivative, GLfloat* table)
+{
+	int stride = BezierEvaluator::Stride(numSamples);
+
+	// The r-th derivative of B(k, n) is n! / (n - r)! * sum over j of (-1)^(j + r) * C(r, j) * B(k - j, n - r)
+	double scale = 0.0;
+	if (derivative <= degree)
+	{
+		scale = 1.0;
+		for (int i = 0; i < derivative; ++i) scale *= degree - i;
+	}
+
+	for (int i = 0; i < numSamples; ++i)
+	{
+		double t = numSamples > 1 ? (double)i / (double)(numSamples - 1) : 0.0;
+		for (int k = 0; k <= degree; ++k)
+		{
+			double value = 0.0;
+			for (int j = 0; j <= derivative && scale != 0.0; ++j)
+			{
+				double sign = (j + derivative) % 2 == 0 ? 1.0 : -1.0;
+				value += sign * Binomial(derivative, j) * BernsteinValue(k - j, degree - derivative, t);
+			}
+			table[k * stride + i] = (GLfloat)(scale * value);
+		}
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+
+// Process-wide cache of sampled Bernstein basis tables, keyed by degree, sample count and derivative order.
+// Tables use the BezierEvaluator layout, function k of sample i lives at table[k * BezierEvaluator::Stride(numSamples) + i],
+// and are sampled at the exact parameters i / (numSamples - 1). A table is built the first time it is asked for and is
+// never changed or freed afterwards, so the returned pointer can be kept and read from any thread.
+class BasisCache
+{
+public:
+	// NULL when there is nothing to sample, no samples or a negative degree
+	static const GLfloat* Bernstein(int degree, int numSamples, int derivative = 0);
+
+	// Number of tables built so far
+	static int numTables();
+private:
+	static void Build(int degree, int numSamples, int derivative, GLfloat* table);
+};
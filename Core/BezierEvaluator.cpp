@@ -0,0 +1,217 @@
+#include "BezierEvaluator.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define BEZIER_EVALUATOR_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#include <cpuid.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+BezierEvaluator::Path BezierEvaluator::_path = bestPath();
+
+namespace
+{
+	// Sums are grouped the same way as the simd paths so every path produces bit-identical vertices
+	void EvaluateCurveScalar(const glm::vec3* controlPoints, const GLfloat* basis, int stride, int first, int numVerts, GLfloat* out)
+	{
+		const GLfloat* b0 = basis;
+		const GLfloat* b1 = basis + stride;
+		const GLfloat* b2 = basis + stride * 2;
+		const GLfloat* b3 = basis + stride * 3;
+		for (int i = first; i < numVerts; ++i)
+		{
+			out[i * 3] = (b0[i] * controlPoints[0].x + b1[i] * controlPoints[1].x) + (b2[i] * controlPoints[2].x + b3[i] * controlPoints[3].x);
+			out[i * 3 + 1] = (b0[i] * controlPoints[0].y + b1[i] * controlPoints[1].y) + (b2[i] * controlPoints[2].y + b3[i] * controlPoints[3].y);
+			out[i * 3 + 2] = (b0[i] * controlPoints[0].z + b1[i] * controlPoints[1].z) + (b2[i] * controlPoints[2].z + b3[i] * controlPoints[3].z);
+		}
+	}
+
+#ifdef BEZIER_EVALUATOR_X86
+	// Writes four SoA points as xyz xyz xyz xyz
+	inline void StoreInterleaved(__m128 x, __m128 y, __m128 z, GLfloat* out)
+	{
+		__m128 xy01 = _mm_unpacklo_ps(x, y);	// x0 y0 x1 y1
+		__m128 xy23 = _mm_unpackhi_ps(x, y);	// x2 y2 x3 y3
+		__m128 out0 = _mm_shuffle_ps(xy01, _mm_unpacklo_ps(z, x), _MM_SHUFFLE(3, 0, 1, 0));	// x0 y0 z0 x1
+		__m128 out1 = _mm_shuffle_ps(_mm_shuffle_ps(xy01, z, _MM_SHUFFLE(1, 1, 3, 3)), xy23, _MM_SHUFFLE(1, 0, 2, 0));	// y1 z1 x2 y2
+		__m128 out2 = _mm_shuffle_ps(_mm_unpackhi_ps(z, z), xy23, _MM_SHUFFLE(3, 2, 3, 0));	// z2 z3 x3 y3
+		out2 = _mm_shuffle_ps(out2, out2, _MM_SHUFFLE(1, 3, 2, 0));	// z2 x3 y3 z3
+
+		_mm_storeu_ps(out, out0);
+		_mm_storeu_ps(out + 4, out1);
+		_mm_storeu_ps(out + 8, out2);
+	}
+
+	// Four parameters per iteration
+	int EvaluateCurveSSE2(const glm::vec3* controlPoints, const GLfloat* basis, int stride, int numVerts, GLfloat* out)
+	{
+		__m128 cx[4], cy[4], cz[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			cx[k] = _mm_set1_ps(controlPoints[k].x);
+			cy[k] = _mm_set1_ps(controlPoints[k].y);
+			cz[k] = _mm_set1_ps(controlPoints[k].z);
+		}
+
+		int i = 0;
+		for (; i + 4 <= numVerts; i += 4)
+		{
+			__m128 b0 = _mm_loadu_ps(basis + i);
+			__m128 b1 = _mm_loadu_ps(basis + stride + i);
+			__m128 b2 = _mm_loadu_ps(basis + stride * 2 + i);
+			__m128 b3 = _mm_loadu_ps(basis + stride * 3 + i);
+
+			__m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, cx[0]), _mm_mul_ps(b1, cx[1])), _mm_add_ps(_mm_mul_ps(b2, cx[2]), _mm_mul_ps(b3, cx[3])));
+			__m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, cy[0]), _mm_mul_ps(b1, cy[1])), _mm_add_ps(_mm_mul_ps(b2, cy[2]), _mm_mul_ps(b3, cy[3])));
+			__m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, cz[0]), _mm_mul_ps(b1, cz[1])), _mm_add_ps(_mm_mul_ps(b2, cz[2]), _mm_mul_ps(b3, cz[3])));
+
+			StoreInterleaved(x, y, z, out + i * 3);
+		}
+		return i;
+	}
+
+	// Eight parameters per iteration
+	TARGET_AVX2 int EvaluateCurveAVX2(const glm::vec3* controlPoints, const GLfloat* basis, int stride, int numVerts, GLfloat* out)
+	{
+		__m256 cx[4], cy[4], cz[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			cx[k] = _mm256_set1_ps(controlPoints[k].x);
+			cy[k] = _mm256_set1_ps(controlPoints[k].y);
+			cz[k] = _mm256_set1_ps(controlPoints[k].z);
+		}
+
+		int i = 0;
+		for (; i + 8 <= numVerts; i += 8)
+		{
+			__m256 b0 = _mm256_loadu_ps(basis + i);
+			__m256 b1 = _mm256_loadu_ps(basis + stride + i);
+			__m256 b2 = _mm256_loadu_ps(basis + stride * 2 + i);
+			__m256 b3 = _mm256_loadu_ps(basis + stride * 3 + i);
+
+			__m256 x = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b0, cx[0]), _mm256_mul_ps(b1, cx[1])), _mm256_add_ps(_mm256_mul_ps(b2, cx[2]), _mm256_mul_ps(b3, cx[3])));
+			__m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b0, cy[0]), _mm256_mul_ps(b1, cy[1])), _mm256_add_ps(_mm256_mul_ps(b2, cy[2]), _mm256_mul_ps(b3, cy[3])));
+			__m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b0, cz[0]), _mm256_mul_ps(b1, cz[1])), _mm256_add_ps(_mm256_mul_ps(b2, cz[2]), _mm256_mul_ps(b3, cz[3])));
+
+			StoreInterleaved(_mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), out + i * 3);
+			StoreInterleaved(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), out + i * 3 + 12);
+		}
+		_mm256_zeroupper();
+		return i;
+	}
+
+	void CpuId(int info[4], int leaf)
+	{
+#ifdef _MSC_VER
+		__cpuidex(info, leaf, 0);
+#else
+		unsigned int a = 0, b = 0, c = 0, d = 0;
+		__cpuid_count(leaf, 0, a, b, c, d);
+		info[0] = a; info[1] = b; info[2] = c; info[3] = d;
+#endif
+	}
+
+	unsigned long long XGetBV()
+	{
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		unsigned int eax, edx;
+		__asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return ((unsigned long long)edx << 32) | eax;
+#endif
+	}
+#endif
+}
+
+void BezierEvaluator::EvaluateCurve(const glm::vec3* controlPoints, const GLfloat* basis, int stride, int numVerts, GLfloat* out)
+{
+	int done = 0;
+#ifdef BEZIER_EVALUATOR_X86
+	if (_path == PATH_AVX2)
+		done = EvaluateCurveAVX2(controlPoints, basis, stride, numVerts, out);
+	else if (_path == PATH_SSE2)
+		done = EvaluateCurveSSE2(controlPoints, basis, stride, numVerts, out);
+#endif
+	EvaluateCurveScalar(controlPoints, basis, stride, done, numVerts, out);
+}
+
+void BezierEvaluator::EvaluatePatch(const glm::vec3* controlPoints, const GLfloat* basis, int stride, int numVerts, GLfloat* out)
+{
+	EvaluatePatchRows(controlPoints, basis, stride, numVerts, 0, numVerts, out);
+}
+
+void BezierEvaluator::EvaluatePatchRows(const glm::vec3* controlPoints, const GLfloat* basis, int stride, int numVerts, int firstRow, int numRows, GLfloat* out)
+{
+	const GLfloat* b0 = basis;
+	const GLfloat* b1 = basis + stride;
+	const GLfloat* b2 = basis + stride * 2;
+	const GLfloat* b3 = basis + stride * 3;
+
+	// Collapse each row of the patch to a point at u_i, then sweep the resulting curve along v
+	glm::vec3 newControlPoints[4];
+	for (int i = firstRow; i < firstRow + numRows; ++i)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			const glm::vec3* cp = controlPoints + row * 4;
+			newControlPoints[row] = b0[i] * cp[0] + b1[i] * cp[1] + b2[i] * cp[2] + b3[i] * cp[3];
+		}
+		EvaluateCurve(newControlPoints, basis, stride, numVerts, out + i * numVerts * 3);
+	}
+}
+
+BezierEvaluator::Path BezierEvaluator::bestPath()
+{
+#ifdef BEZIER_EVALUATOR_X86
+	int info[4];
+	CpuId(info, 0);
+	int maxLeaf = info[0];
+
+	CpuId(info, 1);
+	bool sse2 = (info[3] & (1 << 26)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+
+	bool avx2 = false;
+	if (maxLeaf >= 7 && osxsave && avx)
+	{
+		// The OS has to save the ymm registers on context switches as well
+		bool ymmEnabled = (XGetBV() & 0x6) == 0x6;
+		CpuId(info, 7);
+		avx2 = ymmEnabled && (info[1] & (1 << 5)) != 0;
+	}
+
+	if (avx2) return PATH_AVX2;
+	if (sse2) return PATH_SSE2;
+#endif
+	return PATH_SCALAR;
+}
+
+BezierEvaluator::Path BezierEvaluator::path() { return _path; }
+void BezierEvaluator::path(Path newPath)
+{
+	// Never go wider than the cpu allows
+	_path = newPath < bestPath() ? newPath : bestPath();
+}
+
+const char* BezierEvaluator::pathName(Path path)
+{
+	switch (path)
+	{
+	case PATH_AVX2: return "AVX2";
+	case PATH_SSE2: return "SSE2";
+	default: return "Scalar";
+	}
+}
+
+int BezierEvaluator::Stride(int numVerts)
+{
+	return (numVerts + 7) & ~7;
+}
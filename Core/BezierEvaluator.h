@@ -0,0 +1,38 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+#include <GLM/glm.hpp>
+
+// Batch evaluation of cubic Bezier curves and tensor-product patches.
+// Basis tables come from BasisCache and are SoA: the blending factor k of sample i lives at basis[k * stride + i].
+// Output vertices are written interleaved (x, y, z) so they can be uploaded to a vbo as is.
+class BezierEvaluator
+{
+public:
+	enum Path
+	{
+		PATH_SCALAR,
+		PATH_SSE2,
+		PATH_AVX2
+	};
+
+	// Evaluates the curve defined by 4 control points at every sample of the basis table
+	static void EvaluateCurve(const glm::vec3* controlPoints, const GLfloat* basis, int stride, int numVerts, GLfloat* out);
+
+	// Evaluates a 4x4 patch over a numVerts x numVerts grid, vertex (i, j) is written to out[(j + i * numVerts) * 3]
+	static void EvaluatePatch(const glm::vec3* controlPoints, const GLfloat* basis, int stride, int numVerts, GLfloat* out);
+
+	// Only rows firstRow to firstRow + numRows - 1 of the same grid, so blocks of rows can be evaluated on different threads
+	static void EvaluatePatchRows(const glm::vec3* controlPoints, const GLfloat* basis, int stride, int numVerts, int firstRow, int numRows, GLfloat* out);
+
+	// The widest path supported by the cpu, picked the first time it is asked for
+	static Path bestPath();
+
+	// The path used by EvaluateCurve and EvaluatePatch, can be lowered to compare implementations
+	static Path path();
+	static void path(Path newPath);
+	static const char* pathName(Path path);
+
+	static int Stride(int numVerts);
+private:
+	static Path _path;
+};
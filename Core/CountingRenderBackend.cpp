@@ -0,0 +1,302 @@
+#include "CountingRenderBackend.h"
+
+#include <iostream>
+
+CountingRenderBackend::CountingRenderBackend(RenderBackend* backend, int logInterval)
+{
+	_backend = backend;
+	_logInterval = logInterval;
+	_frame = 0;
+	_framesSinceLog = 0;
+	Clear(_currentFrame);
+	Clear(_lastFrame);
+	Clear(_sinceLog);
+
+	_vao = -1;
+	_program = -1;
+	_depthTest = -1;
+}
+CountingRenderBackend::~CountingRenderBackend()
+{
+	delete _backend;
+}
+
+GLuint CountingRenderBackend::CreateBuffer(GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+	++_currentFrame.objectCalls;
+	if (data)
+	{
+		++_currentFrame.uploads;
+		_currentFrame.bytesUploaded += size;
+	}
+	return _backend->CreateBuffer(size, data, usage);
+}
+
+GLuint CountingRenderBackend::CreateMappedBuffer(GLsizeiptr size, GLvoid** mapped)
+{
+	++_currentFrame.objectCalls;
+	return _backend->CreateMappedBuffer(size, mapped);
+}
+
+void CountingRenderBackend::BufferData(GLuint buffer, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+	// Orphaning without data is still a trip through the driver
+	++_currentFrame.uploads;
+	if (data) _currentFrame.bytesUploaded += size;
+	_backend->BufferData(buffer, size, data, usage);
+}
+
+void CountingRenderBackend::BufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+	++_currentFrame.uploads;
+	_currentFrame.bytesUploaded += size;
+	_backend->BufferSubData(buffer, offset, size, data);
+}
+
+void CountingRenderBackend::DeleteBuffer(GLuint buffer)
+{
+	++_currentFrame.objectCalls;
+	_backend->DeleteBuffer(buffer);
+}
+
+bool CountingRenderBackend::bufferStorage() { return _backend->bufferStorage(); }
+
+GLsync CountingRenderBackend::Fence()
+{
+	++_currentFrame.syncCalls;
+	return _backend->Fence();
+}
+
+void CountingRenderBackend::WaitFence(GLsync fence)
+{
+	++_currentFrame.syncCalls;
+	_backend->WaitFence(fence);
+}
+
+bool CountingRenderBackend::FenceSignaled(GLsync fence)
+{
+	++_currentFrame.syncCalls;
+	return _backend->FenceSignaled(fence);
+}
+
+void CountingRenderBackend::DeleteFence(GLsync fence)
+{
+	++_currentFrame.syncCalls;
+	_backend->DeleteFence(fence);
+}
+
+GLuint CountingRenderBackend::CreateVertexArray(GLuint elementBuffer)
+{
+	++_currentFrame.objectCalls;
+	GLuint vao = _backend->CreateVertexArray(elementBuffer);
+	BindVertexArray(vao);
+	return vao;
+}
+
+void CountingRenderBackend::VertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor)
+{
+	if (location >= 0) BindVertexArray(vao);
+	_backend->VertexAttribute(vao, buffer, location, size, stride, offset, divisor);
+}
+
+void CountingRenderBackend::IntegerVertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor)
+{
+	if (location >= 0) BindVertexArray(vao);
+	_backend->IntegerVertexAttribute(vao, buffer, location, size, stride, offset, divisor);
+}
+
+void CountingRenderBackend::DeleteVertexArray(GLuint vao)
+{
+	++_currentFrame.objectCalls;
+	if ((GLint)vao == _vao) _vao = -1;
+	_backend->DeleteVertexArray(vao);
+}
+
+GLint CountingRenderBackend::AttribLocation(GLint program, const char* name)
+{
+	++_currentFrame.queries;
+	return _backend->AttribLocation(program, name);
+}
+
+GLuint CountingRenderBackend::CreateBufferTexture(GLuint buffer, GLenum format)
+{
+	++_currentFrame.objectCalls;
+	return _backend->CreateBufferTexture(buffer, format);
+}
+
+void CountingRenderBackend::BindBufferTexture(GLuint texture)
+{
+	++_currentFrame.textureBinds;
+	_backend->BindBufferTexture(texture);
+}
+
+void CountingRenderBackend::DeleteTexture(GLuint texture)
+{
+	++_currentFrame.objectCalls;
+	_backend->DeleteTexture(texture);
+}
+
+GLint CountingRenderBackend::program()
+{
+	++_currentFrame.queries;
+	return _backend->program();
+}
+
+void CountingRenderBackend::UseProgram(GLint program)
+{
+	++_currentFrame.programBinds;
+	if (program == _program) ++_currentFrame.redundantProgramBinds;
+	_program = program;
+	_backend->UseProgram(program);
+}
+
+void CountingRenderBackend::DepthTest(bool enabled)
+{
+	++_currentFrame.depthTests;
+	if ((enabled ? 1 : 0) == _depthTest) ++_currentFrame.redundantDepthTests;
+	_depthTest = enabled ? 1 : 0;
+	_backend->DepthTest(enabled);
+}
+
+void CountingRenderBackend::Uniform(GLint location, const glm::mat4& value)
+{
+	++_currentFrame.uniforms;
+	_backend->Uniform(location, value);
+}
+
+void CountingRenderBackend::Uniform(GLint location, const glm::vec4& value)
+{
+	++_currentFrame.uniforms;
+	_backend->Uniform(location, value);
+}
+
+void CountingRenderBackend::DrawElements(GLuint vao, GLenum mode, GLsizei count, GLintptr indexOffset, GLint baseVertex)
+{
+	BindVertexArray(vao);
+	++_currentFrame.drawCalls;
+	++_currentFrame.draws;
+	_backend->DrawElements(vao, mode, count, indexOffset, baseVertex);
+}
+
+void CountingRenderBackend::DrawElementsInstanced(GLuint vao, GLenum mode, GLsizei count, GLsizei instanceCount)
+{
+	BindVertexArray(vao);
+	++_currentFrame.drawCalls;
+	++_currentFrame.draws;
+	_backend->DrawElementsInstanced(vao, mode, count, instanceCount);
+}
+
+void CountingRenderBackend::MultiDrawElements(GLuint vao, GLenum mode, const GLsizei* counts, const GLvoid* const* indexOffsets, GLsizei drawCount, const GLint* baseVertices)
+{
+	BindVertexArray(vao);
+	++_currentFrame.drawCalls;
+	_currentFrame.draws += drawCount;
+	_backend->MultiDrawElements(vao, mode, counts, indexOffsets, drawCount, baseVertices);
+}
+
+void CountingRenderBackend::CapturePoints(GLuint vao, GLsizei count, GLuint buffer, GLsizeiptr size, GLvoid* data)
+{
+	// A draw and a read back
+	BindVertexArray(vao);
+	++_currentFrame.drawCalls;
+	++_currentFrame.draws;
+	++_currentFrame.queries;
+	_backend->CapturePoints(vao, count, buffer, size, data);
+}
+
+void CountingRenderBackend::Invalidate()
+{
+	// Whatever was set around the backend, the next bind isn't redundant
+	_vao = -1;
+	_program = -1;
+	_depthTest = -1;
+	_backend->Invalidate();
+}
+
+RenderBackend& CountingRenderBackend::backend() { return *_backend; }
+
+void CountingRenderBackend::EndFrame()
+{
+	_lastFrame = _currentFrame;
+	Add(_sinceLog, _currentFrame);
+	Clear(_currentFrame);
+	++_frame;
+	++_framesSinceLog;
+
+	if (_logInterval > 0 && _framesSinceLog >= _logInterval)
+		Print(std::cout);
+}
+
+const CountingRenderBackend::Stats& CountingRenderBackend::currentFrame() { return _currentFrame; }
+const CountingRenderBackend::Stats& CountingRenderBackend::lastFrame() { return _lastFrame; }
+int CountingRenderBackend::frame() { return _frame; }
+
+int CountingRenderBackend::logInterval() { return _logInterval; }
+void CountingRenderBackend::logInterval(int newLogInterval) { _logInterval = newLogInterval; }
+
+void CountingRenderBackend::Print(std::ostream& out)
+{
+	if (_framesSinceLog == 0)
+		return;
+
+	int n = _framesSinceLog;
+	out << "GL calls per frame over " << n << " frames: "
+		<< _sinceLog.drawCalls / n << " draw calls (" << _sinceLog.draws / n << " draws), "
+		<< _sinceLog.vertexArrayBinds / n << " vao binds (" << _sinceLog.redundantVertexArrayBinds / n << " redundant), "
+		<< _sinceLog.programBinds / n << " program binds (" << _sinceLog.redundantProgramBinds / n << " redundant), "
+		<< _sinceLog.depthTests / n << " depth test calls (" << _sinceLog.redundantDepthTests / n << " redundant), "
+		<< _sinceLog.textureBinds / n << " texture binds, "
+		<< _sinceLog.uniforms / n << " uniforms, "
+		<< _sinceLog.uploads / n << " uploads of " << _sinceLog.bytesUploaded / n << " bytes, "
+		<< _sinceLog.objectCalls / n << " creates and deletes, "
+		<< _sinceLog.syncCalls / n << " fence calls, "
+		<< _sinceLog.queries / n << " queries" << std::endl;
+
+	Clear(_sinceLog);
+	_framesSinceLog = 0;
+}
+
+void CountingRenderBackend::BindVertexArray(GLuint vao)
+{
+	++_currentFrame.vertexArrayBinds;
+	if ((GLint)vao == _vao) ++_currentFrame.redundantVertexArrayBinds;
+	_vao = vao;
+}
+
+void CountingRenderBackend::Clear(Stats& stats)
+{
+	stats.drawCalls = 0;
+	stats.draws = 0;
+	stats.vertexArrayBinds = 0;
+	stats.redundantVertexArrayBinds = 0;
+	stats.programBinds = 0;
+	stats.redundantProgramBinds = 0;
+	stats.depthTests = 0;
+	stats.redundantDepthTests = 0;
+	stats.textureBinds = 0;
+	stats.uniforms = 0;
+	stats.uploads = 0;
+	stats.bytesUploaded = 0;
+	stats.objectCalls = 0;
+	stats.syncCalls = 0;
+	stats.queries = 0;
+}
+
+void CountingRenderBackend::Add(Stats& total, const Stats& stats)
+{
+	total.drawCalls += stats.drawCalls;
+	total.draws += stats.draws;
+	total.vertexArrayBinds += stats.vertexArrayBinds;
+	total.redundantVertexArrayBinds += stats.redundantVertexArrayBinds;
+	total.programBinds += stats.programBinds;
+	total.redundantProgramBinds += stats.redundantProgramBinds;
+	total.depthTests += stats.depthTests;
+	total.redundantDepthTests += stats.redundantDepthTests;
+	total.textureBinds += stats.textureBinds;
+	total.uniforms += stats.uniforms;
+	total.uploads += stats.uploads;
+	total.bytesUploaded += stats.bytesUploaded;
+	total.objectCalls += stats.objectCalls;
+	total.syncCalls += stats.syncCalls;
+	total.queries += stats.queries;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "RenderBackend.h"
+
+#include <ostream>
+
+// Passes every call on to another backend and counts them by the kind of GL traffic they make, so the draws, state
+// changes and uploads of a frame can be read off whichever backend is underneath. A bind or state change is redundant
+// when it sets what the last one through here already set. Writes into persistently mapped memory never pass through a
+// backend, StreamBuffer::bytesLastFrame has those.
+class CountingRenderBackend : public RenderBackend
+{
+public:
+	struct Stats
+	{
+		int drawCalls;
+		int draws;
+		int vertexArrayBinds;
+		int redundantVertexArrayBinds;
+		int programBinds;
+		int redundantProgramBinds;
+		int depthTests;
+		int redundantDepthTests;
+		int textureBinds;
+		int uniforms;
+		int uploads;
+		GLsizeiptr bytesUploaded;
+		int objectCalls;
+		int syncCalls;
+		int queries;
+	};
+
+	// Takes ownership of backend. With a logInterval every that many frames are logged to the console by EndFrame.
+	CountingRenderBackend(RenderBackend* backend, int logInterval = 0);
+	~CountingRenderBackend();
+
+	GLuint CreateBuffer(GLsizeiptr size, const GLvoid* data, GLenum usage);
+	GLuint CreateMappedBuffer(GLsizeiptr size, GLvoid** mapped);
+	void BufferData(GLuint buffer, GLsizeiptr size, const GLvoid* data, GLenum usage);
+	void BufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+	void DeleteBuffer(GLuint buffer);
+	bool bufferStorage();
+
+	GLsync Fence();
+	void WaitFence(GLsync fence);
+	bool FenceSignaled(GLsync fence);
+	void DeleteFence(GLsync fence);
+
+	GLuint CreateVertexArray(GLuint elementBuffer);
+	void VertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor = 0);
+	void IntegerVertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor = 0);
+	void DeleteVertexArray(GLuint vao);
+	GLint AttribLocation(GLint program, const char* name);
+
+	GLuint CreateBufferTexture(GLuint buffer, GLenum format);
+	void BindBufferTexture(GLuint texture);
+	void DeleteTexture(GLuint texture);
+
+	GLint program();
+	void UseProgram(GLint program);
+	void DepthTest(bool enabled);
+	void Uniform(GLint location, const glm::mat4& value);
+	void Uniform(GLint location, const glm::vec4& value);
+
+	void DrawElements(GLuint vao, GLenum mode, GLsizei count, GLintptr indexOffset, GLint baseVertex);
+	void DrawElementsInstanced(GLuint vao, GLenum mode, GLsizei count, GLsizei instanceCount);
+	void MultiDrawElements(GLuint vao, GLenum mode, const GLsizei* counts, const GLvoid* const* indexOffsets, GLsizei drawCount, const GLint* baseVertices);
+	void CapturePoints(GLuint vao, GLsizei count, GLuint buffer, GLsizeiptr size, GLvoid* data);
+
+	void Invalidate();
+
+	// The backend the calls go on to
+	RenderBackend& backend();
+
+	// Closes the counts of this frame, logging the frames since the last log once there are logInterval of them
+	void EndFrame();
+
+	// Counts of the frame in progress and the one EndFrame closed last
+	const Stats& currentFrame();
+	const Stats& lastFrame();
+	int frame();
+
+	int logInterval();
+	void logInterval(int newLogInterval);
+
+	// Averages per frame of the frames closed since the last Print
+	void Print(std::ostream& out);
+private:
+	void BindVertexArray(GLuint vao);
+	static void Clear(Stats& stats);
+	static void Add(Stats& total, const Stats& stats);
+private:
+	RenderBackend* _backend;
+
+	Stats _currentFrame;
+	Stats _lastFrame;
+	Stats _sinceLog;
+	int _frame;
+	int _framesSinceLog;
+	int _logInterval;
+
+	// What the last call through here set, -1 until one has
+	GLint _vao;
+	GLint _program;
+	int _depthTest;
+};
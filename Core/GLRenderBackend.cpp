@@ -0,0 +1,335 @@
+#include "GLRenderBackend.h"
+
+#include <GLM/gtc/type_ptr.hpp>
+#include <cstring>
+#include <iostream>
+
+GLRenderBackend::GLRenderBackend(bool checkState)
+{
+	_checkState = checkState;
+	_numSkipped = 0;
+	_numDesyncs = 0;
+
+	// Nothing is known until it has been set or read once
+	Invalidate();
+}
+GLRenderBackend::~GLRenderBackend()
+{
+
+}
+
+GLuint GLRenderBackend::CreateBuffer(GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, data, usage);
+	return buffer;
+}
+
+GLuint GLRenderBackend::CreateMappedBuffer(GLsizeiptr size, GLvoid** mapped)
+{
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+	// Mapped once for the life of the buffer, coherent so writes need no explicit flush
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+	*mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+	return buffer;
+}
+
+void GLRenderBackend::BufferData(GLuint buffer, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+	BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, data, usage);
+}
+
+void GLRenderBackend::BufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+	BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+}
+
+void GLRenderBackend::DeleteBuffer(GLuint buffer)
+{
+	// A buffer that is still mapped is unmapped by deleting it, and one that is bound is unbound, its name can come back
+	glDeleteBuffers(1, &buffer);
+	if (_copyWriteBuffer == (GLint)buffer) _copyWriteBuffer = 0;
+	if (_arrayBuffer == (GLint)buffer) _arrayBuffer = 0;
+}
+
+bool GLRenderBackend::bufferStorage() { return GLEW_ARB_buffer_storage != 0; }
+
+GLsync GLRenderBackend::Fence() { return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); }
+
+void GLRenderBackend::WaitFence(GLsync fence)
+{
+	while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+}
+
+bool GLRenderBackend::FenceSignaled(GLsync fence) { return glClientWaitSync(fence, 0, 0) != GL_TIMEOUT_EXPIRED; }
+
+void GLRenderBackend::DeleteFence(GLsync fence) { glDeleteSync(fence); }
+
+GLuint GLRenderBackend::CreateVertexArray(GLuint elementBuffer)
+{
+	GLuint vao = 0;
+	glGenVertexArrays(1, &vao);
+	BindVertexArray(vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+	return vao;
+}
+
+void GLRenderBackend::VertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor)
+{
+	// Attributes the shader doesn't use have no location
+	if (location < 0)
+		return;
+
+	BindVertexArray(vao);
+	BindBuffer(GL_ARRAY_BUFFER, buffer);
+	glEnableVertexAttribArray(location);
+	glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offset);
+	glVertexAttribDivisor(location, divisor);
+}
+
+void GLRenderBackend::IntegerVertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor)
+{
+	if (location < 0)
+		return;
+
+	BindVertexArray(vao);
+	BindBuffer(GL_ARRAY_BUFFER, buffer);
+	glEnableVertexAttribArray(location);
+	glVertexAttribIPointer(location, size, GL_INT, stride, (GLvoid*)offset);
+	glVertexAttribDivisor(location, divisor);
+}
+
+void GLRenderBackend::DeleteVertexArray(GLuint vao)
+{
+	glDeleteVertexArrays(1, &vao);
+	if (_vertexArray == (GLint)vao) _vertexArray = 0;
+}
+
+GLint GLRenderBackend::AttribLocation(GLint program, const char* name) { return glGetAttribLocation(program, name); }
+
+GLuint GLRenderBackend::CreateBufferTexture(GLuint buffer, GLenum format)
+{
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	BindBufferTexture(texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+	return texture;
+}
+
+void GLRenderBackend::BindBufferTexture(GLuint texture)
+{
+	if (_checkState) Check("buffer texture", GL_TEXTURE_BINDING_BUFFER, _bufferTexture);
+	if ((GLint)texture == _bufferTexture)
+	{
+		++_numSkipped;
+		return;
+	}
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	_bufferTexture = texture;
+}
+
+void GLRenderBackend::DeleteTexture(GLuint texture)
+{
+	glDeleteTextures(1, &texture);
+	if (_bufferTexture == (GLint)texture) _bufferTexture = 0;
+}
+
+GLint GLRenderBackend::program()
+{
+	// Only asked of GL the first time, or after an Invalidate
+	if (_checkState) Check("program", GL_CURRENT_PROGRAM, _program);
+	if (_program < 0) glGetIntegerv(GL_CURRENT_PROGRAM, &_program);
+	return _program;
+}
+
+void GLRenderBackend::UseProgram(GLint program)
+{
+	if (_checkState) Check("program", GL_CURRENT_PROGRAM, _program);
+	if (program == _program)
+	{
+		++_numSkipped;
+		return;
+	}
+	glUseProgram(program);
+	_program = program;
+}
+
+void GLRenderBackend::DepthTest(bool enabled)
+{
+	if (_checkState) Check("depth test", GL_DEPTH_TEST, _depthTest);
+	if ((enabled ? 1 : 0) == _depthTest)
+	{
+		++_numSkipped;
+		return;
+	}
+	if (enabled) glEnable(GL_DEPTH_TEST);
+	else glDisable(GL_DEPTH_TEST);
+	_depthTest = enabled ? 1 : 0;
+}
+
+void GLRenderBackend::Uniform(GLint location, const glm::mat4& value)
+{
+	if (!UniformChanged(location, glm::value_ptr(value), 16))
+	{
+		++_numSkipped;
+		return;
+	}
+	glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void GLRenderBackend::Uniform(GLint location, const glm::vec4& value)
+{
+	if (!UniformChanged(location, glm::value_ptr(value), 4))
+	{
+		++_numSkipped;
+		return;
+	}
+	glUniform4fv(location, 1, glm::value_ptr(value));
+}
+
+void GLRenderBackend::DrawElements(GLuint vao, GLenum mode, GLsizei count, GLintptr indexOffset, GLint baseVertex)
+{
+	BindVertexArray(vao);
+	glDrawElementsBaseVertex(mode, count, GL_UNSIGNED_INT, (GLvoid*)indexOffset, baseVertex);
+}
+
+void GLRenderBackend::DrawElementsInstanced(GLuint vao, GLenum mode, GLsizei count, GLsizei instanceCount)
+{
+	BindVertexArray(vao);
+	glDrawElementsInstanced(mode, count, GL_UNSIGNED_INT, 0, instanceCount);
+}
+
+void GLRenderBackend::MultiDrawElements(GLuint vao, GLenum mode, const GLsizei* counts, const GLvoid* const* indexOffsets, GLsizei drawCount, const GLint* baseVertices)
+{
+	BindVertexArray(vao);
+	glMultiDrawElementsBaseVertex(mode, counts, GL_UNSIGNED_INT, indexOffsets, drawCount, baseVertices);
+}
+
+void GLRenderBackend::CapturePoints(GLuint vao, GLsizei count, GLuint buffer, GLsizeiptr size, GLvoid* data)
+{
+	BindVertexArray(vao);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer);
+
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, count);
+	glEndTransformFeedback();
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, size, data);
+}
+
+void GLRenderBackend::Invalidate()
+{
+	_program = -1;
+	_vertexArray = -1;
+	_copyWriteBuffer = -1;
+	_arrayBuffer = -1;
+	_bufferTexture = -1;
+	_depthTest = -1;
+}
+
+int GLRenderBackend::numSkipped() { return _numSkipped; }
+int GLRenderBackend::numDesyncs() { return _numDesyncs; }
+
+void GLRenderBackend::BindVertexArray(GLuint vao)
+{
+	if (_checkState) Check("vao", GL_VERTEX_ARRAY_BINDING, _vertexArray);
+	if ((GLint)vao == _vertexArray)
+	{
+		++_numSkipped;
+		return;
+	}
+	glBindVertexArray(vao);
+	_vertexArray = vao;
+}
+
+void GLRenderBackend::BindBuffer(GLenum target, GLuint buffer)
+{
+	GLint& bound = Binding(target);
+	if (_checkState)
+	{
+		if (target == GL_ARRAY_BUFFER) Check("array buffer", GL_ARRAY_BUFFER_BINDING, bound);
+		else Check("copy write buffer", GL_COPY_WRITE_BUFFER_BINDING, bound);
+	}
+	if ((GLint)buffer == bound)
+	{
+		++_numSkipped;
+		return;
+	}
+	glBindBuffer(target, buffer);
+	bound = buffer;
+}
+
+GLint& GLRenderBackend::Binding(GLenum target) { return target == GL_ARRAY_BUFFER ? _arrayBuffer : _copyWriteBuffer; }
+
+bool GLRenderBackend::UniformChanged(GLint location, const GLfloat* value, int size)
+{
+	// GL ignores location -1, and a value can only be remembered against a known program
+	if (location < 0 || program() <= 0)
+		return true;
+
+	ProgramUniforms* uniforms = NULL;
+	unsigned int numPrograms = _uniforms.size();
+	for (unsigned int i = 0; i < numPrograms; ++i)
+	{
+		if (_uniforms[i].program == _program) uniforms = &_uniforms[i];
+	}
+	if (!uniforms)
+	{
+		_uniforms.push_back(ProgramUniforms());
+		uniforms = &_uniforms.back();
+		uniforms->program = _program;
+	}
+	if ((int)uniforms->sizes.size() <= location)
+	{
+		uniforms->sizes.resize(location + 1, 0);
+		uniforms->values.resize((location + 1) * 16);
+	}
+
+	GLfloat* remembered = &uniforms->values[location * 16];
+	if (uniforms->sizes[location] == size)
+	{
+		if (_checkState) CheckUniform(location, remembered, size);
+		if (memcmp(remembered, value, sizeof(GLfloat) * size) == 0)
+			return false;
+	}
+	memcpy(remembered, value, sizeof(GLfloat) * size);
+	uniforms->sizes[location] = size;
+	return true;
+}
+
+void GLRenderBackend::Check(const char* name, GLenum binding, GLint& remembered)
+{
+	if (remembered < 0)
+		return;
+
+	GLint actual = 0;
+	glGetIntegerv(binding, &actual);
+	if (actual == remembered)
+		return;
+
+	std::cout << "GL state desync: " << name << " is " << actual << ", the backend remembered " << remembered << std::endl;
+	++_numDesyncs;
+	remembered = actual;
+}
+
+void GLRenderBackend::CheckUniform(GLint location, GLfloat* remembered, int size)
+{
+	GLfloat actual[16];
+	glGetUniformfv(_program, location, actual);
+	if (memcmp(remembered, actual, sizeof(GLfloat) * size) == 0)
+		return;
+
+	std::cout << "GL state desync: uniform " << location << " of program " << _program << " differs from what the backend remembered" << std::endl;
+	++_numDesyncs;
+	memcpy(remembered, actual, sizeof(GLfloat) * size);
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "RenderBackend.h"
+
+#include <vector>
+
+// Passes every call on to the GL context current on the calling thread. Buffers are uploaded through
+// GL_COPY_WRITE_BUFFER, and every draw names its vao. The backend remembers the program, vao, buffer bindings, buffer
+// texture, depth test and uniform values it last set, and leaves out any call that would set them to what they already
+// are. Code that changes any of that with GL directly has to call Invalidate after it. With checkState every remembered value is read
+// back with glGet* before it is relied on, and any that GL disagrees with is logged and counted as a desync.
+class GLRenderBackend : public RenderBackend
+{
+public:
+	GLRenderBackend(bool checkState = false);
+	~GLRenderBackend();
+
+	GLuint CreateBuffer(GLsizeiptr size, const GLvoid* data, GLenum usage);
+	GLuint CreateMappedBuffer(GLsizeiptr size, GLvoid** mapped);
+	void BufferData(GLuint buffer, GLsizeiptr size, const GLvoid* data, GLenum usage);
+	void BufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+	void DeleteBuffer(GLuint buffer);
+	bool bufferStorage();
+
+	GLsync Fence();
+	void WaitFence(GLsync fence);
+	bool FenceSignaled(GLsync fence);
+	void DeleteFence(GLsync fence);
+
+	GLuint CreateVertexArray(GLuint elementBuffer);
+	void VertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor = 0);
+	void IntegerVertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor = 0);
+	void DeleteVertexArray(GLuint vao);
+	GLint AttribLocation(GLint program, const char* name);
+
+	GLuint CreateBufferTexture(GLuint buffer, GLenum format);
+	void BindBufferTexture(GLuint texture);
+	void DeleteTexture(GLuint texture);
+
+	GLint program();
+	void UseProgram(GLint program);
+	void DepthTest(bool enabled);
+	void Uniform(GLint location, const glm::mat4& value);
+	void Uniform(GLint location, const glm::vec4& value);
+
+	void DrawElements(GLuint vao, GLenum mode, GLsizei count, GLintptr indexOffset, GLint baseVertex);
+	void DrawElementsInstanced(GLuint vao, GLenum mode, GLsizei count, GLsizei instanceCount);
+	void MultiDrawElements(GLuint vao, GLenum mode, const GLsizei* counts, const GLvoid* const* indexOffsets, GLsizei drawCount, const GLint* baseVertices);
+	void CapturePoints(GLuint vao, GLsizei count, GLuint buffer, GLsizeiptr size, GLvoid* data);
+
+	void Invalidate();
+
+	// Calls left out because they would have changed nothing
+	int numSkipped();
+	// Remembered values GL disagreed with, only looked for with checkState
+	int numDesyncs();
+private:
+	// The uniform values set on one program, 16 floats for every location up to the highest one set
+	struct ProgramUniforms
+	{
+		GLint program;
+		std::vector<GLfloat> values;
+		// Floats set at each location, 0 when it hasn't been set through here
+		std::vector<int> sizes;
+	};
+
+	void BindVertexArray(GLuint vao);
+	void BindBuffer(GLenum target, GLuint buffer);
+	GLint& Binding(GLenum target);
+	// Remembers value for location of the program in use and says whether it differs from what was there before
+	bool UniformChanged(GLint location, const GLfloat* value, int size);
+
+	// Reads what GL has where remembered claims to know it, and takes GL's word for it when they differ
+	void Check(const char* name, GLenum binding, GLint& remembered);
+	void CheckUniform(GLint location, GLfloat* remembered, int size);
+private:
+	bool _checkState;
+	int _numSkipped;
+	int _numDesyncs;
+
+	// As last set through here, -1 when not known
+	GLint _program;
+	GLint _vertexArray;
+	GLint _copyWriteBuffer;
+	GLint _arrayBuffer;
+	GLint _bufferTexture;
+	int _depthTest;
+
+	// Kept through Invalidate, code calling GL directly only sets uniforms the backend never does
+	std::vector<ProgramUniforms> _uniforms;
+};
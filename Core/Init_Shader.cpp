@@ -1,32 +1,23 @@
-#include "init_shader.h"
+#include "Init_Shader.h"
 #include <fstream>
 #include <iostream>
 
 static char* textFileRead(char* fn)
 {
-	FILE* fp;
 	char* content = NULL;
-	errno_t err;
-
-	int count = 0;
 
 	if (fn != NULL)
 	{
-		err = fopen_s(&fp, fn, "rt");
+		std::ifstream file(fn, std::ios::binary | std::ios::ate);
 
-		if (fp != NULL)
+		if (file)
 		{
-			fseek(fp, 0, SEEK_END);
-			count = ftell(fp);
-			rewind(fp);
-
-			if (count > 0)
-			{
-				content = new char[count + 1];
-				count = fread(content, sizeof(char), count, fp);
-				content[count] = '\0';
-			}
-			err = fclose(fp);
+			std::streamoff count = file.tellg();
+			file.seekg(0);
+
+			content = new char[(size_t)count + 1];
+			file.read(content, count);
+			content[file.gcount()] = '\0';
 		}
 	}
 	return content;
@@ -0,0 +1,149 @@
+#include "NullRenderBackend.h"
+
+#include <cstring>
+
+NullRenderBackend::NullRenderBackend()
+{
+	// 0 means no buffer to GL, so it is never handed out
+	_nextHandle = 1;
+	_program = 0;
+	_numVertexArrays = 0;
+	ResetCounters();
+}
+NullRenderBackend::~NullRenderBackend()
+{
+	for (std::map<GLuint, std::vector<char>*>::iterator itr = _mappedBuffers.begin(); itr != _mappedBuffers.end(); ++itr)
+	{
+		delete itr->second;
+	}
+}
+
+GLuint NullRenderBackend::CreateBuffer(GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+	GLuint buffer = _nextHandle++;
+	_bufferSizes[buffer] = 0;
+	BufferData(buffer, size, data, usage);
+	return buffer;
+}
+
+GLuint NullRenderBackend::CreateMappedBuffer(GLsizeiptr size, GLvoid** mapped)
+{
+	GLuint buffer = _nextHandle++;
+	_bufferSizes[buffer] = size;
+
+	std::vector<char>* storage = new std::vector<char>(size);
+	_mappedBuffers[buffer] = storage;
+	*mapped = size > 0 ? (GLvoid*)&(*storage)[0] : NULL;
+	return buffer;
+}
+
+void NullRenderBackend::BufferData(GLuint buffer, GLsizeiptr size, const GLvoid* data, GLenum /*usage*/)
+{
+	_bufferSizes[buffer] = size;
+	if (data) _bytesUploaded += size;
+}
+
+void NullRenderBackend::BufferSubData(GLuint /*buffer*/, GLintptr /*offset*/, GLsizeiptr size, const GLvoid* /*data*/)
+{
+	_bytesUploaded += size;
+}
+
+void NullRenderBackend::DeleteBuffer(GLuint buffer)
+{
+	_bufferSizes.erase(buffer);
+
+	std::map<GLuint, std::vector<char>*>::iterator mapped = _mappedBuffers.find(buffer);
+	if (mapped != _mappedBuffers.end())
+	{
+		delete mapped->second;
+		_mappedBuffers.erase(mapped);
+	}
+}
+
+bool NullRenderBackend::bufferStorage() { return true; }
+
+// Nothing is ever in flight
+GLsync NullRenderBackend::Fence() { return NULL; }
+void NullRenderBackend::WaitFence(GLsync /*fence*/) { }
+bool NullRenderBackend::FenceSignaled(GLsync /*fence*/) { return true; }
+void NullRenderBackend::DeleteFence(GLsync /*fence*/) { }
+
+GLuint NullRenderBackend::CreateVertexArray(GLuint /*elementBuffer*/)
+{
+	++_numVertexArrays;
+	return _nextHandle++;
+}
+
+void NullRenderBackend::VertexAttribute(GLuint /*vao*/, GLuint /*buffer*/, GLint /*location*/, GLint /*size*/, GLsizei /*stride*/, GLintptr /*offset*/, GLuint /*divisor*/) { }
+void NullRenderBackend::IntegerVertexAttribute(GLuint /*vao*/, GLuint /*buffer*/, GLint /*location*/, GLint /*size*/, GLsizei /*stride*/, GLintptr /*offset*/, GLuint /*divisor*/) { }
+void NullRenderBackend::DeleteVertexArray(GLuint /*vao*/) { --_numVertexArrays; }
+GLint NullRenderBackend::AttribLocation(GLint /*program*/, const char* /*name*/) { return 0; }
+
+GLuint NullRenderBackend::CreateBufferTexture(GLuint /*buffer*/, GLenum /*format*/) { return _nextHandle++; }
+void NullRenderBackend::BindBufferTexture(GLuint /*texture*/) { }
+void NullRenderBackend::DeleteTexture(GLuint /*texture*/) { }
+
+GLint NullRenderBackend::program() { return _program; }
+void NullRenderBackend::UseProgram(GLint program) { _program = program; }
+void NullRenderBackend::DepthTest(bool /*enabled*/) { }
+void NullRenderBackend::Uniform(GLint /*location*/, const glm::mat4& /*value*/) { }
+void NullRenderBackend::Uniform(GLint /*location*/, const glm::vec4& /*value*/) { }
+
+void NullRenderBackend::DrawElements(GLuint /*vao*/, GLenum /*mode*/, GLsizei count, GLintptr /*indexOffset*/, GLint /*baseVertex*/)
+{
+	++_numDrawCalls;
+	++_numDraws;
+	_numIndices += count;
+}
+
+void NullRenderBackend::DrawElementsInstanced(GLuint /*vao*/, GLenum /*mode*/, GLsizei count, GLsizei instanceCount)
+{
+	++_numDrawCalls;
+	++_numDraws;
+	_numIndices += (long long)count * instanceCount;
+}
+
+void NullRenderBackend::MultiDrawElements(GLuint /*vao*/, GLenum /*mode*/, const GLsizei* counts, const GLvoid* const* /*indexOffsets*/, GLsizei drawCount, const GLint* /*baseVertices*/)
+{
+	++_numDrawCalls;
+	_numDraws += drawCount;
+	for (GLsizei i = 0; i < drawCount; ++i)
+	{
+		_numIndices += counts[i];
+	}
+}
+
+// Nothing is evaluated, so what comes back is zeros
+void NullRenderBackend::CapturePoints(GLuint /*vao*/, GLsizei /*count*/, GLuint /*buffer*/, GLsizeiptr size, GLvoid* data)
+{
+	++_numDrawCalls;
+	++_numDraws;
+	memset(data, 0, size);
+}
+
+// Remembers nothing it could be wrong about
+void NullRenderBackend::Invalidate() {}
+
+int NullRenderBackend::numBuffers() { return _bufferSizes.size(); }
+int NullRenderBackend::numVertexArrays() { return _numVertexArrays; }
+GLsizeiptr NullRenderBackend::bufferBytes()
+{
+	GLsizeiptr bytes = 0;
+	for (std::map<GLuint, GLsizeiptr>::iterator itr = _bufferSizes.begin(); itr != _bufferSizes.end(); ++itr)
+	{
+		bytes += itr->second;
+	}
+	return bytes;
+}
+
+GLsizeiptr NullRenderBackend::bytesUploaded() { return _bytesUploaded; }
+int NullRenderBackend::numDrawCalls() { return _numDrawCalls; }
+int NullRenderBackend::numDraws() { return _numDraws; }
+long long NullRenderBackend::numIndices() { return _numIndices; }
+void NullRenderBackend::ResetCounters()
+{
+	_bytesUploaded = 0;
+	_numDrawCalls = 0;
+	_numDraws = 0;
+	_numIndices = 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "RenderBackend.h"
+
+#include <map>
+#include <vector>
+
+// A backend for running without a window or GL context. Nothing is drawn, it hands out its own handles and keeps count
+// of the buffers it was asked to hold, the bytes uploaded into them and the draws it was given. Mapped buffers are
+// backed by plain memory and fences are passed straight away, so the persistently mapped paths run as they would on a gpu
+// that is never behind.
+class NullRenderBackend : public RenderBackend
+{
+public:
+	NullRenderBackend();
+	~NullRenderBackend();
+
+	GLuint CreateBuffer(GLsizeiptr size, const GLvoid* data, GLenum usage);
+	GLuint CreateMappedBuffer(GLsizeiptr size, GLvoid** mapped);
+	void BufferData(GLuint buffer, GLsizeiptr size, const GLvoid* data, GLenum usage);
+	void BufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+	void DeleteBuffer(GLuint buffer);
+	bool bufferStorage();
+
+	GLsync Fence();
+	void WaitFence(GLsync fence);
+	bool FenceSignaled(GLsync fence);
+	void DeleteFence(GLsync fence);
+
+	GLuint CreateVertexArray(GLuint elementBuffer);
+	void VertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor = 0);
+	void IntegerVertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor = 0);
+	void DeleteVertexArray(GLuint vao);
+	GLint AttribLocation(GLint program, const char* name);
+
+	GLuint CreateBufferTexture(GLuint buffer, GLenum format);
+	void BindBufferTexture(GLuint texture);
+	void DeleteTexture(GLuint texture);
+
+	GLint program();
+	void UseProgram(GLint program);
+	void DepthTest(bool enabled);
+	void Uniform(GLint location, const glm::mat4& value);
+	void Uniform(GLint location, const glm::vec4& value);
+
+	void DrawElements(GLuint vao, GLenum mode, GLsizei count, GLintptr indexOffset, GLint baseVertex);
+	void DrawElementsInstanced(GLuint vao, GLenum mode, GLsizei count, GLsizei instanceCount);
+	void MultiDrawElements(GLuint vao, GLenum mode, const GLsizei* counts, const GLvoid* const* indexOffsets, GLsizei drawCount, const GLint* baseVertices);
+	void CapturePoints(GLuint vao, GLsizei count, GLuint buffer, GLsizeiptr size, GLvoid* data);
+
+	void Invalidate();
+
+	// Buffers and vaos that exist right now, and the bytes the buffers hold
+	int numBuffers();
+	int numVertexArrays();
+	GLsizeiptr bufferBytes();
+
+	// Since the last ResetCounters. Every range of a multi-draw counts as a draw, and indices count once per instance.
+	GLsizeiptr bytesUploaded();
+	int numDrawCalls();
+	int numDraws();
+	long long numIndices();
+	void ResetCounters();
+private:
+	GLuint _nextHandle;
+	GLint _program;
+
+	std::map<GLuint, GLsizeiptr> _bufferSizes;
+	std::map<GLuint, std::vector<char>*> _mappedBuffers;
+	int _numVertexArrays;
+
+	GLsizeiptr _bytesUploaded;
+	int _numDrawCalls;
+	int _numDraws;
+	long long _numIndices;
+};
@@ -0,0 +1,48 @@
+#include "PatchLod.h"
+
+GLfloat PatchLod::_pixelError = 0.5f;
+glm::vec2 PatchLod::_screenSize = glm::vec2(800.0f, 600.0f);
+
+int PatchLod::LevelVerts(int level)
+{
+	return (1 << level) + 1;
+}
+
+int PatchLod::SelectLevel(const glm::vec3* controlPoints, const glm::mat4& modelViewProj)
+{
+	// Project the control net to pixels, anything touching the near plane gets the finest level
+	glm::vec2 screen[16];
+	for (int i = 0; i < 16; ++i)
+	{
+		glm::vec4 clip = modelViewProj * glm::vec4(controlPoints[i], 1.0f);
+		if (clip.w <= 0.0f) return NUM_LEVELS - 1;
+		screen[i] = glm::vec2(clip.x / clip.w, clip.y / clip.w) * _screenSize * 0.5f;
+	}
+
+	// Second differences of the control net bound the second derivative of the surface along each direction
+	GLfloat secondDiff = 0.0f;
+	for (int a = 0; a < 4; ++a)
+	{
+		for (int b = 0; b < 2; ++b)
+		{
+			glm::vec2 alongRow = screen[a * 4 + b] - 2.0f * screen[a * 4 + b + 1] + screen[a * 4 + b + 2];
+			glm::vec2 alongColumn = screen[b * 4 + a] - 2.0f * screen[(b + 1) * 4 + a] + screen[(b + 2) * 4 + a];
+			secondDiff = glm::max(secondDiff, glm::max(glm::length(alongRow), glm::length(alongColumn)));
+		}
+	}
+
+	// A cubic's second derivative is at most 6 times that, and linear interpolation over a segment of length h is off by
+	// at most h^2 / 8 of it, so n segments are enough once 0.75 * secondDiff / n^2 <= pixelError
+	GLfloat segments = glm::sqrt(0.75f * secondDiff / _pixelError);
+	for (int level = 0; level < NUM_LEVELS; ++level)
+	{
+		if ((GLfloat)(LevelVerts(level) - 1) >= segments) return level;
+	}
+	return NUM_LEVELS - 1;
+}
+
+GLfloat PatchLod::pixelError() { return _pixelError; }
+void PatchLod::pixelError(GLfloat newPixelError) { if (newPixelError > 0.0f) _pixelError = newPixelError; }
+
+glm::vec2 PatchLod::screenSize() { return _screenSize; }
+void PatchLod::screenSize(glm::vec2 newScreenSize) { _screenSize = newScreenSize; }
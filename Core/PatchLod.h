@@ -0,0 +1,28 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+
+// Picks how finely a bicubic patch is tessellated from how large it is on screen. Level l samples (2^l + 1) x (2^l + 1)
+// vertices, so every level contains all of the vertices of the levels below it.
+class PatchLod
+{
+public:
+	static const int NUM_LEVELS = 7;
+	static const int MAX_VERTS = (1 << (NUM_LEVELS - 1)) + 1;
+
+	static int LevelVerts(int level);
+
+	// Smallest level whose triangles stay within pixelError of the true surface once projected by modelViewProj
+	static int SelectLevel(const glm::vec3* controlPoints, const glm::mat4& modelViewProj);
+
+	// Largest allowed distance, in pixels, between the drawn triangles and the surface
+	static GLfloat pixelError();
+	static void pixelError(GLfloat newPixelError);
+
+	// Size of the viewport in pixels
+	static glm::vec2 screenSize();
+	static void screenSize(glm::vec2 newScreenSize);
+private:
+	static GLfloat _pixelError;
+	static glm::vec2 _screenSize;
+};
@@ -0,0 +1,176 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+std::atomic<bool> Profiler::_enabled(false);
+std::chrono::high_resolution_clock::time_point Profiler::_start;
+std::mutex Profiler::_lock;
+
+std::vector<Profiler::Zone*> Profiler::_zones = std::vector<Profiler::Zone*>();
+std::vector<std::thread::id> Profiler::_lanes = std::vector<std::thread::id>();
+std::vector<Profiler::Event> Profiler::_events = std::vector<Profiler::Event>();
+int Profiler::_maxEvents = 0;
+int Profiler::_frame = 0;
+
+void Profiler::Enable(int maxEvents)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	// Reserved up front so recording never allocates, the enabling thread is the first lane
+	_maxEvents = maxEvents;
+	_events.clear();
+	_events.reserve(maxEvents);
+	_lanes.clear();
+	_lanes.push_back(std::this_thread::get_id());
+	_frame = 0;
+	for (unsigned int i = 0; i < _zones.size(); ++i)
+	{
+		_zones[i]->currentMs = 0.0;
+		_zones[i]->currentAllocations = 0;
+	}
+
+	_start = std::chrono::high_resolution_clock::now();
+	_enabled = true;
+}
+
+void Profiler::Disable()
+{
+	_enabled = false;
+}
+
+void Profiler::BeginFrame()
+{
+	if (!enabled())
+		return;
+
+	std::lock_guard<std::mutex> lock(_lock);
+	if (_frame > 0)
+	{
+		int slot = (_frame - 1) % NUM_FRAMES;
+		for (unsigned int i = 0; i < _zones.size(); ++i)
+		{
+			_zones[i]->frameMs[slot] = _zones[i]->currentMs;
+			_zones[i]->currentMs = 0.0;
+			_zones[i]->frameAllocations[slot] = _zones[i]->currentAllocations;
+			_zones[i]->currentAllocations = 0;
+		}
+	}
+	++_frame;
+}
+
+int Profiler::frame() { return _frame; }
+
+void Profiler::PrintSummary(std::ostream& out)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	// The frame in progress isn't in the ring yet
+	int numFrames = std::min(_frame - 1, (int)NUM_FRAMES);
+	if (numFrames <= 0)
+		return;
+
+	// Leaves the stream formatted the way it was
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << "Last " << numFrames << " frames, ms" << std::setw(28) << "p50" << std::setw(10) << "p95" << std::setw(10) << "p99" << std::setw(10) << "allocs" << std::endl;
+
+	std::vector<double> sorted(numFrames);
+	for (unsigned int i = 0; i < _zones.size(); ++i)
+	{
+		Zone* zone = _zones[i];
+		std::copy(zone->frameMs, zone->frameMs + numFrames, sorted.begin());
+		std::sort(sorted.begin(), sorted.end());
+
+		out << std::left << std::setw(40) << zone->name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << sorted[(numFrames - 1) * 50 / 100]
+			<< std::setw(10) << sorted[(numFrames - 1) * 95 / 100]
+			<< std::setw(10) << sorted[(numFrames - 1) * 99 / 100]
+			<< std::setw(10) << *std::max_element(zone->frameAllocations, zone->frameAllocations + numFrames) << std::endl;
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+bool Profiler::WriteTrace(const char* path)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+
+	std::ofstream out(path);
+	if (!out)
+		return false;
+
+	out << "{\"traceEvents\":[" << std::endl;
+	for (unsigned int i = 0; i < _lanes.size(); ++i)
+	{
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i << ",\"args\":{\"name\":\"";
+		if (i == 0) out << "main";
+		else out << "thread " << i;
+		out << "\"}}," << std::endl;
+	}
+	for (unsigned int i = 0; i < _events.size(); ++i)
+	{
+		const Event& e = _events[i];
+		out << "{\"name\":\"" << _zones[e.zone]->name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.lane
+			<< ",\"ts\":" << e.start << ",\"dur\":" << e.end - e.start << ",\"args\":{\"allocations\":" << e.allocations << "}}"
+			<< (i + 1 < _events.size() ? "," : "") << std::endl;
+	}
+	out << "]}" << std::endl;
+	return true;
+}
+
+long long Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - _start).count();
+}
+
+void Profiler::EndZone(const char* name, long long start, long long startAllocations)
+{
+	long long end = Now();
+	long long allocations = AllocationTracker::numAllocations() - startAllocations;
+
+	std::lock_guard<std::mutex> lock(_lock);
+	int zone = FindZone(name);
+	_zones[zone]->currentMs += (end - start) / 1000.0;
+	_zones[zone]->currentAllocations += allocations;
+
+	if ((int)_events.size() < _maxEvents)
+	{
+		Event e = { zone, FindLane(std::this_thread::get_id()), start, end, allocations };
+		_events.push_back(e);
+	}
+}
+
+int Profiler::FindZone(const char* name)
+{
+	// Names are literals, so the same zone nearly always comes with the same pointer
+	for (unsigned int i = 0; i < _zones.size(); ++i)
+	{
+		if (_zones[i]->name == name || strcmp(_zones[i]->name, name) == 0)
+			return i;
+	}
+
+	Zone* zone = new Zone();
+	zone->name = name;
+	std::fill(zone->frameMs, zone->frameMs + NUM_FRAMES, 0.0);
+	zone->currentMs = 0.0;
+	std::fill(zone->frameAllocations, zone->frameAllocations + NUM_FRAMES, 0);
+	zone->currentAllocations = 0;
+	_zones.push_back(zone);
+	return _zones.size() - 1;
+}
+
+int Profiler::FindLane(std::thread::id thread)
+{
+	for (unsigned int i = 0; i < _lanes.size(); ++i)
+	{
+		if (_lanes[i] == thread)
+			return i;
+	}
+	_lanes.push_back(thread);
+	return _lanes.size() - 1;
+}
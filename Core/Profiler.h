@@ -0,0 +1,111 @@
+#pragma once
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Times named zones of code, see PROFILE_ZONE below. Every zone that ends between two BeginFrame calls adds to that
+// frame's total for its name, which go into a ring of the last NUM_FRAMES frames for the percentile summaries. Each
+// zone is also kept as an event on the lane of the thread it ran on, for a trace that chrome://tracing or Perfetto can
+// load. Zones count the heap allocations made while they ran as well, from any thread. Nothing is recorded until Enable,
+// and a zone costs a single branch while the profiler is off.
+class Profiler
+{
+public:
+	static const int NUM_FRAMES = 256;
+
+	// Events past maxEvents are dropped from the trace, the frame totals carry on
+	static void Enable(int maxEvents = 1 << 20);
+	static void Disable();
+
+	// In the header so a disabled zone doesn't pay for a call
+	static bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+	// Closes the totals of the frame before and starts a new one
+	static void BeginFrame();
+
+	// Frames begun since Enable
+	static int frame();
+
+	// p50, p95 and p99 of every zone's per frame total and the most it allocated in a frame, over the frames in the ring
+	static void PrintSummary(std::ostream& out);
+
+	// Every recorded event in the Chrome trace event format, one lane per thread
+	static bool WriteTrace(const char* path);
+
+	// Microseconds since Enable
+	static long long Now();
+
+	// Adds a zone that ran from start to now and the allocations made since there were startAllocations, called by ProfileZone
+	static void EndZone(const char* name, long long start, long long startAllocations);
+private:
+	struct Zone
+	{
+		const char* name;
+		double frameMs[NUM_FRAMES];
+		double currentMs;
+		long long frameAllocations[NUM_FRAMES];
+		long long currentAllocations;
+	};
+
+	struct Event
+	{
+		int zone;
+		int lane;
+		long long start;
+		long long end;
+		long long allocations;
+	};
+
+	// Index of the zone with that name, adding it the first time. Only called with _lock held.
+	static int FindZone(const char* name);
+	static int FindLane(std::thread::id thread);
+private:
+	static std::atomic<bool> _enabled;
+	static std::chrono::high_resolution_clock::time_point _start;
+	static std::mutex _lock;
+
+	static std::vector<Zone*> _zones;
+	static std::vector<std::thread::id> _lanes;
+	static std::vector<Event> _events;
+	static int _maxEvents;
+	static int _frame;
+};
+
+// Times the rest of the enclosing scope as the zone name, which has to be a string literal
+class ProfileZone
+{
+public:
+	ProfileZone(const char* name)
+	{
+		_name = name;
+		_start = -1;
+		_startAllocations = 0;
+		if (Profiler::enabled())
+		{
+			_start = Profiler::Now();
+			_startAllocations = AllocationTracker::numAllocations();
+		}
+	}
+	~ProfileZone()
+	{
+		if (_start >= 0) Profiler::EndZone(_name, _start, _startAllocations);
+	}
+private:
+	const char* _name;
+	long long _start;
+	long long _startAllocations;
+};
+
+// Defining NO_PROFILER compiles every zone out
+#ifdef NO_PROFILER
+#define PROFILE_ZONE(name)
+#else
+#define PROFILE_ZONE_JOIN(a, b) a##b
+#define PROFILE_ZONE_NAME(line) PROFILE_ZONE_JOIN(profileZone, line)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_NAME(__LINE__)(name)
+#endif
@@ -0,0 +1,27 @@
+#include "RenderBackend.h"
+#include "NullRenderBackend.h"
+
+RenderBackend* RenderBackend::_current = NULL;
+
+RenderBackend::~RenderBackend()
+{
+
+}
+
+RenderBackend& RenderBackend::Get()
+{
+	if (!_current) _current = new NullRenderBackend();
+	return *_current;
+}
+
+void RenderBackend::Set(RenderBackend* backend)
+{
+	delete _current;
+	_current = backend;
+}
+
+void RenderBackend::Release()
+{
+	delete _current;
+	_current = NULL;
+}
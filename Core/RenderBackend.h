@@ -0,0 +1,72 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+#include <GLM/gtc/matrix_transform.hpp>
+
+// Everything the geometry and drawing code asks of the graphics api goes through the current backend, so the same
+// Update and Draw can run against GL or against a NullRenderBackend that only counts what it is handed. Handles and
+// enums are GL's own, a backend without GL makes up its own handles. Buffers are named directly instead of bound
+// first, so uploading one never disturbs whichever vao happens to be bound.
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend();
+
+	// The backend every call goes to, a NullRenderBackend until Set is given another one. Programs with a GL context Set a
+	// GLRenderBackend once it is current, which keeps GL out of everything that only needs this class.
+	static RenderBackend& Get();
+
+	// Takes ownership of backend and deletes the one before it. Has to happen before anything creates buffers.
+	static void Set(RenderBackend* backend);
+	static void Release();
+
+	virtual GLuint CreateBuffer(GLsizeiptr size, const GLvoid* data, GLenum usage) = 0;
+
+	// Immutable write-only storage that stays mapped for the life of the buffer, only when bufferStorage() is true
+	virtual GLuint CreateMappedBuffer(GLsizeiptr size, GLvoid** mapped) = 0;
+	virtual void BufferData(GLuint buffer, GLsizeiptr size, const GLvoid* data, GLenum usage) = 0;
+	virtual void BufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data) = 0;
+	virtual void DeleteBuffer(GLuint buffer) = 0;
+	virtual bool bufferStorage() = 0;
+
+	// Fences around persistently mapped memory, Wait blocks until the gpu has passed the fence and Signaled only asks
+	virtual GLsync Fence() = 0;
+	virtual void WaitFence(GLsync fence) = 0;
+	virtual bool FenceSignaled(GLsync fence) = 0;
+	virtual void DeleteFence(GLsync fence) = 0;
+
+	// A vao drawing indices out of elementBuffer, attributes are added one at a time. A divisor of 1 steps the attribute
+	// once per instance instead of once per vertex.
+	virtual GLuint CreateVertexArray(GLuint elementBuffer) = 0;
+	virtual void VertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor = 0) = 0;
+	// Ints read by the shader as ints instead of converted to floats
+	virtual void IntegerVertexAttribute(GLuint vao, GLuint buffer, GLint location, GLint size, GLsizei stride, GLintptr offset, GLuint divisor = 0) = 0;
+	virtual void DeleteVertexArray(GLuint vao) = 0;
+	virtual GLint AttribLocation(GLint program, const char* name) = 0;
+
+	// A texture reading the whole of buffer as texels of format. There is only texture unit 0, which is where every
+	// sampler starts out pointing.
+	virtual GLuint CreateBufferTexture(GLuint buffer, GLenum format) = 0;
+	virtual void BindBufferTexture(GLuint texture) = 0;
+	virtual void DeleteTexture(GLuint texture) = 0;
+
+	virtual GLint program() = 0;
+	virtual void UseProgram(GLint program) = 0;
+	virtual void DepthTest(bool enabled) = 0;
+	virtual void Uniform(GLint location, const glm::mat4& value) = 0;
+	virtual void Uniform(GLint location, const glm::vec4& value) = 0;
+
+	// Unsigned int indices starting indexOffset bytes into the vao's element buffer
+	virtual void DrawElements(GLuint vao, GLenum mode, GLsizei count, GLintptr indexOffset, GLint baseVertex) = 0;
+	virtual void DrawElementsInstanced(GLuint vao, GLenum mode, GLsizei count, GLsizei instanceCount) = 0;
+	virtual void MultiDrawElements(GLuint vao, GLenum mode, const GLsizei* counts, const GLvoid* const* indexOffsets, GLsizei drawCount, const GLint* baseVertices) = 0;
+
+	// Draws count points from the vao without rasterizing them, capturing the transform feedback varyings of the program in
+	// use into buffer, and reads the first size bytes of it back into data
+	virtual void CapturePoints(GLuint vao, GLsizei count, GLuint buffer, GLsizeiptr size, GLvoid* data) = 0;
+
+	// Forgets whatever bindings and enable bits the backend remembers setting, for code that has just changed them with GL
+	// directly, so the next call sets them again instead of being left out
+	virtual void Invalidate() = 0;
+private:
+	static RenderBackend* _current;
+};
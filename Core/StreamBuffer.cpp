@@ -0,0 +1,119 @@
+#include "StreamBuffer.h"
+#include "RenderBackend.h"
+
+int StreamBuffer::_persistent = -1;
+GLsizeiptr StreamBuffer::_bytesUploaded = 0;
+GLsizeiptr StreamBuffer::_bytesLastFrame = 0;
+
+StreamBuffer::StreamBuffer(GLsizei vertexSize, GLsizei maxVerts)
+{
+	_vbo = 0;
+	_ownsBuffer = true;
+	_firstVertex = 0;
+	_vertexSize = vertexSize;
+	_regionSize = (GLsizeiptr)vertexSize * maxVerts;
+	_maxVerts = maxVerts;
+	_region = 0;
+	_mappedRegion = -1;
+	_mapped = NULL;
+	for (int i = 0; i < NUM_REGIONS; ++i)
+	{
+		_fences[i] = 0;
+	}
+
+	if (persistent())
+	{
+		GLvoid* mapped = NULL;
+		_vbo = RenderBackend::Get().CreateMappedBuffer(_regionSize * NUM_REGIONS, &mapped);
+		_mapped = (char*)mapped;
+	}
+	else
+	{
+		_vbo = RenderBackend::Get().CreateBuffer(_regionSize, NULL, GL_DYNAMIC_DRAW);
+		_staging.resize(_regionSize);
+	}
+}
+StreamBuffer::StreamBuffer(GLuint vbo, GLvoid* mapped, GLint firstVertex, GLsizei vertexSize, GLsizei maxVerts)
+{
+	_vbo = vbo;
+	_ownsBuffer = false;
+	_firstVertex = firstVertex;
+	_vertexSize = vertexSize;
+	_regionSize = (GLsizeiptr)vertexSize * maxVerts;
+	_maxVerts = maxVerts;
+	_region = 0;
+	_mappedRegion = -1;
+	_mapped = mapped ? (char*)mapped + (GLsizeiptr)vertexSize * firstVertex : NULL;
+	for (int i = 0; i < NUM_REGIONS; ++i)
+	{
+		_fences[i] = 0;
+	}
+
+	if (!persistent()) _staging.resize(_regionSize);
+}
+StreamBuffer::~StreamBuffer()
+{
+	for (int i = 0; i < NUM_REGIONS; ++i)
+	{
+		if (_fences[i]) RenderBackend::Get().DeleteFence(_fences[i]);
+	}
+	if (_ownsBuffer) RenderBackend::Get().DeleteBuffer(_vbo);
+}
+
+GLsizei StreamBuffer::FootprintVerts(GLsizei maxVerts) { return persistent() ? maxVerts * NUM_REGIONS : maxVerts; }
+
+GLvoid* StreamBuffer::Map()
+{
+	if (!persistent())
+		return (GLvoid*)&_staging[0];
+
+	// Wait for the gpu to finish the draws that were still reading this region when it was last replaced
+	_mappedRegion = (_region + 1) % NUM_REGIONS;
+	GLsync& fence = _fences[_mappedRegion];
+	if (fence)
+	{
+		RenderBackend::Get().WaitFence(fence);
+		RenderBackend::Get().DeleteFence(fence);
+		fence = 0;
+	}
+	return (GLvoid*)(_mapped + _regionSize * _mappedRegion);
+}
+
+void StreamBuffer::Unmap(GLsizeiptr begin, GLsizeiptr end)
+{
+	if (end <= begin)
+		return;
+	_bytesUploaded += end - begin;
+
+	if (!persistent())
+	{
+		if (_ownsBuffer && begin == 0 && end == _regionSize)
+		{
+			// Everything is replaced, let the driver hand out fresh storage instead of waiting on the old one
+			RenderBackend::Get().BufferData(_vbo, _regionSize, NULL, GL_DYNAMIC_DRAW);
+		}
+		RenderBackend::Get().BufferSubData(_vbo, (GLsizeiptr)_vertexSize * _firstVertex + begin, end - begin, (GLvoid*)&_staging[begin]);
+		return;
+	}
+
+	// Every draw from the old region has been issued by now, the next write to it has to wait for them
+	_fences[_region] = RenderBackend::Get().Fence();
+	_region = _mappedRegion;
+	_mappedRegion = -1;
+}
+
+GLuint StreamBuffer::vbo() { return _vbo; }
+GLint StreamBuffer::baseVertex() { return _firstVertex + _region * _maxVerts; }
+
+bool StreamBuffer::persistent()
+{
+	if (_persistent < 0) _persistent = RenderBackend::Get().bufferStorage() ? 1 : 0;
+	return _persistent == 1;
+}
+GLsizeiptr StreamBuffer::bytesUploaded() { return _bytesUploaded; }
+GLsizeiptr StreamBuffer::bytesLastFrame() { return _bytesLastFrame; }
+void StreamBuffer::EndFrame()
+{
+	_bytesLastFrame = _bytesUploaded;
+	_bytesUploaded = 0;
+}
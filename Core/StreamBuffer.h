@@ -0,0 +1,65 @@
+#pragma once
+#include <GLEW/GL/glew.h>
+#include <vector>
+
+// Vertex buffer for data that is rewritten while the gpu may still be drawing the previous version of it.
+// When ARB_buffer_storage is available the buffer holds NUM_REGIONS copies of the data in persistently mapped memory.
+// Each new version is written straight into the next copy once the fence placed when that copy was last replaced has
+// passed, and is drawn from there with a base vertex. Otherwise new versions are written to a copy in client memory and
+// only the bytes that changed go through glBufferSubData, orphaning the storage when all of it is replaced.
+class StreamBuffer
+{
+public:
+	static const int NUM_REGIONS = 3;
+
+	StreamBuffer(GLsizei vertexSize, GLsizei maxVerts);
+
+	// A stream over part of a buffer owned by someone else, FootprintVerts(maxVerts) vertices starting at firstVertex.
+	// mapped is the start of that buffer's persistent mapping, or NULL when persistent() is false.
+	StreamBuffer(GLuint vbo, GLvoid* mapped, GLint firstVertex, GLsizei vertexSize, GLsizei maxVerts);
+	~StreamBuffer();
+
+	// Vertices a stream of maxVerts takes up in its buffer
+	static GLsizei FootprintVerts(GLsizei maxVerts);
+
+	// Memory to write the next version of the data to, maxVerts vertices long. Anything not rewritten is undefined when
+	// persistently mapped, and still holds the previous version otherwise.
+	GLvoid* Map();
+
+	// Hands the bytes from begin to end of the mapped data to the gpu
+	void Unmap(GLsizeiptr begin, GLsizeiptr end);
+
+	GLuint vbo();
+
+	// Offset to add to every index drawn from the buffer
+	GLint baseVertex();
+
+	// Whether the persistently mapped path is in use, decided the first time it is asked for
+	static bool persistent();
+
+	// Bytes handed to the gpu since the last EndFrame, and in the frame before it
+	static GLsizeiptr bytesUploaded();
+	static GLsizeiptr bytesLastFrame();
+	static void EndFrame();
+private:
+	GLuint _vbo;
+	bool _ownsBuffer;
+	GLint _firstVertex;
+	GLsizei _vertexSize;
+	GLsizeiptr _regionSize;
+	GLsizei _maxVerts;
+
+	// Region the gpu draws from, and the one being written to between Map and Unmap
+	int _region;
+	int _mappedRegion;
+
+	char* _mapped;
+	GLsync _fences[NUM_REGIONS];
+
+	// Client side copy for the fallback path
+	std::vector<char> _staging;
+
+	static int _persistent;
+	static GLsizeiptr _bytesUploaded;
+	static GLsizeiptr _bytesLastFrame;
+};
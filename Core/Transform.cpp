@@ -0,0 +1,93 @@
+#include "Transform.h"
+#include "TransformManager.h"
+
+Transform::Transform()
+{
+	_handle = TransformManager::Add(this);
+}
+Transform::Transform(const Transform& other)
+{
+	_handle = TransformManager::Add(this);
+	TransformManager::Copy(_handle, other._handle);
+}
+Transform::~Transform()
+{
+	TransformManager::Remove(_handle);
+}
+
+Transform& Transform::operator=(const Transform& other)
+{
+	if (&other != this) TransformManager::Copy(_handle, other._handle);
+	return *this;
+}
+
+const glm::vec3& Transform::position() { return TransformManager::_positions[TransformManager::_slots[_handle]]; }
+void Transform::position(const glm::vec3& newPosition)
+{
+	TransformManager::_positions[TransformManager::_slots[_handle]] = newPosition;
+	TransformManager::MarkDirty(_handle);
+}
+
+const glm::vec3& Transform::rotationOrigin() { return TransformManager::_rotationOrigins[TransformManager::_slots[_handle]]; }
+void Transform::rotationOrigin(const glm::vec3& newRotationOrigin)
+{
+	TransformManager::_rotationOrigins[TransformManager::_slots[_handle]] = newRotationOrigin;
+	TransformManager::MarkDirty(_handle);
+}
+
+const glm::quat& Transform::rotation() { return TransformManager::_rotations[TransformManager::_slots[_handle]]; }
+void Transform::rotation(const glm::quat& newRotation)
+{
+	TransformManager::_rotations[TransformManager::_slots[_handle]] = newRotation;
+	TransformManager::MarkDirty(_handle);
+}
+
+const glm::vec3& Transform::scale() { return TransformManager::_scales[TransformManager::_slots[_handle]]; }
+void Transform::scale(const glm::vec3& newScale)
+{
+	TransformManager::_scales[TransformManager::_slots[_handle]] = newScale;
+	TransformManager::MarkDirty(_handle);
+}
+
+const glm::vec3& Transform::scaleOrigin() { return TransformManager::_scaleOrigins[TransformManager::_slots[_handle]]; }
+void Transform::scaleOrigin(const glm::vec3& newScaleOrigin)
+{
+	TransformManager::_scaleOrigins[TransformManager::_slots[_handle]] = newScaleOrigin;
+	TransformManager::MarkDirty(_handle);
+}
+
+// Velocities don't change the matrix until TransformManager::Integrate moves by them
+const glm::vec3& Transform::linearVelocity()
+{
+	int motion = TransformManager::_motions[TransformManager::_slots[_handle]];
+	return motion >= 0 ? TransformManager::_linearVelocities[motion] : TransformManager::_noLinearVelocity;
+}
+void Transform::linearVelocity(const glm::vec3& newLinearVelocity)
+{
+	TransformManager::Motion(_handle, newLinearVelocity, angularVelocity());
+}
+
+const glm::quat& Transform::angularVelocity()
+{
+	int motion = TransformManager::_motions[TransformManager::_slots[_handle]];
+	return motion >= 0 ? TransformManager::_angularVelocities[motion] : TransformManager::_noAngularVelocity;
+}
+void Transform::angularVelocity(const glm::quat& newAngularVelocity)
+{
+	TransformManager::Motion(_handle, linearVelocity(), newAngularVelocity);
+}
+
+Transform* Transform::parent()
+{
+	// A parent removed since the last update still holds its slot, without a handle
+	int parentSlot = TransformManager::_parents[TransformManager::_slots[_handle]];
+	int parentHandle = parentSlot >= 0 ? TransformManager::_handles[parentSlot] : -1;
+	return parentHandle >= 0 ? TransformManager::_transforms[parentHandle] : NULL;
+}
+void Transform::parent(Transform* newParent)
+{
+	TransformManager::Parent(_handle, newParent ? newParent->_handle : -1);
+}
+
+const glm::mat4& Transform::modelMat() { return TransformManager::_modelMats[TransformManager::_slots[_handle]]; }
+unsigned int Transform::generation() { return TransformManager::_generations[TransformManager::_slots[_handle]]; }
@@ -0,0 +1,40 @@
+#pragma once
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+// A handle to a local position, rotation and scale held by TransformManager. The setters only mark the transform, its
+// model matrix is rebuilt by the next TransformManager::Update. A copy gets a slot of its own with the same values.
+class Transform
+{
+public:
+	Transform();
+	Transform(const Transform& other);
+	~Transform();
+	Transform& operator=(const Transform& other);
+
+	const glm::vec3& position();
+	void position(const glm::vec3& newPosition);
+	const glm::vec3& rotationOrigin();
+	void rotationOrigin(const glm::vec3& newRotationOrigin);
+	const glm::quat& rotation();
+	void rotation(const glm::quat& newRotation);
+	const glm::vec3& scale();
+	void scale(const glm::vec3& newScale);
+	const glm::vec3& scaleOrigin();
+	void scaleOrigin(const glm::vec3& newScaleOrigin);
+
+	const glm::vec3& linearVelocity();
+	void linearVelocity(const glm::vec3& newLinearVelocity);
+	const glm::quat& angularVelocity();
+	void angularVelocity(const glm::quat& newAngularVelocity);
+
+	Transform* parent();
+	void parent(Transform* newParent);
+
+	// As of the last TransformManager::Update
+	const glm::mat4& modelMat();
+	// Changes whenever TransformManager::Update rebuilds the model matrix, so a copy of it can tell when it went stale
+	unsigned int generation();
+private:
+	int _handle;
+};
@@ -0,0 +1,346 @@
+#include "TransformManager.h"
+#include "Transform.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+std::vector<glm::vec3> TransformManager::_positions = std::vector<glm::vec3>();
+std::vector<glm::vec3> TransformManager::_rotationOrigins = std::vector<glm::vec3>();
+std::vector<glm::quat> TransformManager::_rotations = std::vector<glm::quat>();
+std::vector<glm::vec3> TransformManager::_scales = std::vector<glm::vec3>();
+std::vector<glm::vec3> TransformManager::_scaleOrigins = std::vector<glm::vec3>();
+std::vector<int> TransformManager::_parents = std::vector<int>();
+std::vector<char> TransformManager::_dirty = std::vector<char>();
+std::vector<glm::mat4> TransformManager::_modelMats = std::vector<glm::mat4>();
+std::vector<unsigned int> TransformManager::_generations = std::vector<unsigned int>();
+std::vector<int> TransformManager::_handles = std::vector<int>();
+std::vector<int> TransformManager::_motions = std::vector<int>();
+
+std::vector<int> TransformManager::_movingSlots = std::vector<int>();
+std::vector<glm::vec3> TransformManager::_linearVelocities = std::vector<glm::vec3>();
+std::vector<glm::quat> TransformManager::_angularVelocities = std::vector<glm::quat>();
+glm::vec3 TransformManager::_noLinearVelocity = glm::vec3();
+glm::quat TransformManager::_noAngularVelocity = glm::quat();
+
+std::vector<int> TransformManager::_snapshotHandles = std::vector<int>();
+std::vector<glm::vec3> TransformManager::_snapshotMoves = std::vector<glm::vec3>();
+std::vector<glm::quat> TransformManager::_snapshotTurns = std::vector<glm::quat>();
+float TransformManager::_snapshotDt = 0.0f;
+
+std::vector<int> TransformManager::_slots = std::vector<int>();
+std::vector<Transform*> TransformManager::_transforms = std::vector<Transform*>();
+std::vector<int> TransformManager::_freeHandles = std::vector<int>();
+
+std::vector<int> TransformManager::_order = std::vector<int>();
+std::vector<int> TransformManager::_depths = std::vector<int>();
+
+bool TransformManager::_reorder = false;
+
+void TransformManager::Integrate(float dt)
+{
+	Integrate(dt, 0, numMoving());
+}
+
+void TransformManager::Integrate(float dt, int begin, int end)
+{
+	// Every moving transform has a linear velocity to add, even if it is zero, so this loop has no branches
+	for (int i = begin; i < end; ++i)
+	{
+		int slot = _movingSlots[i];
+		_positions[slot] += _linearVelocities[i] * dt;
+		_dirty[slot] = 1;
+	}
+	for (int i = begin; i < end; ++i)
+	{
+		const glm::quat& angularVelocity = _angularVelocities[i];
+		if (angularVelocity == _noAngularVelocity)
+			continue;
+		glm::quat& rotation = _rotations[_movingSlots[i]];
+		rotation = glm::slerp(rotation, rotation * angularVelocity, dt);
+	}
+}
+
+int TransformManager::numMoving() { return _movingSlots.size(); }
+
+int TransformManager::Snapshot(float dt)
+{
+	// Handles rather than slots, the slots may be reordered before it is applied
+	int numMoving = _movingSlots.size();
+	_snapshotHandles.resize(numMoving);
+	for (int i = 0; i < numMoving; ++i)
+	{
+		_snapshotHandles[i] = _handles[_movingSlots[i]];
+	}
+	_snapshotMoves.assign(_linearVelocities.begin(), _linearVelocities.end());
+	_snapshotTurns.assign(_angularVelocities.begin(), _angularVelocities.end());
+	_snapshotDt = dt;
+	return numMoving;
+}
+
+void TransformManager::IntegrateSnapshot(int begin, int end)
+{
+	// Over constant velocities, moving and turning for the whole time at once is the same as frame by frame
+	for (int i = begin; i < end; ++i)
+	{
+		_snapshotMoves[i] *= _snapshotDt;
+	}
+	for (int i = begin; i < end; ++i)
+	{
+		glm::quat& turn = _snapshotTurns[i];
+		if (turn != _noAngularVelocity) turn = glm::slerp(_noAngularVelocity, turn, _snapshotDt);
+	}
+}
+
+int TransformManager::numSnapshot() { return _snapshotMoves.size(); }
+
+void TransformManager::ApplySnapshot()
+{
+	// Added rather than set, so a transform moved since the snapshot keeps that move too
+	int numSnapshot = _snapshotHandles.size();
+	for (int i = 0; i < numSnapshot; ++i)
+	{
+		int handle = _snapshotHandles[i];
+		if (handle < 0)
+			continue;
+		int slot = _slots[handle];
+		_positions[slot] += _snapshotMoves[i];
+		if (_snapshotTurns[i] != _noAngularVelocity) _rotations[slot] = _rotations[slot] * _snapshotTurns[i];
+		_dirty[slot] = 1;
+	}
+	_snapshotHandles.clear();
+	_snapshotMoves.clear();
+	_snapshotTurns.clear();
+}
+
+void TransformManager::Update()
+{
+	PROFILE_ZONE("TransformManager::Update");
+
+	if (_reorder) Reorder();
+
+	// Parents come first, so a marked parent has passed its mark on before any child of it is reached
+	bool anyDirty = false;
+	unsigned int numSlots = _positions.size();
+	for (unsigned int slot = 0; slot < numSlots; ++slot)
+	{
+		int parent = _parents[slot];
+		if (parent >= 0 && _dirty[parent]) _dirty[slot] = 1;
+		if (!_dirty[slot])
+			continue;
+
+		_modelMats[slot] = parent >= 0 ? _modelMats[parent] * LocalMat(slot) : LocalMat(slot);
+		++_generations[slot];
+		anyDirty = true;
+	}
+	if (anyDirty) std::fill(_dirty.begin(), _dirty.end(), 0);
+}
+
+int TransformManager::Add(Transform* transform)
+{
+	int handle;
+	if (_freeHandles.empty())
+	{
+		handle = _slots.size();
+		_slots.push_back(0);
+		_transforms.push_back(NULL);
+	}
+	else
+	{
+		handle = _freeHandles.back();
+		_freeHandles.pop_back();
+	}
+	_slots[handle] = _positions.size();
+	_transforms[handle] = transform;
+
+	// New slots go on the end, where they come after any parent they get
+	_positions.push_back(glm::vec3());
+	_rotationOrigins.push_back(glm::vec3());
+	_rotations.push_back(glm::quat());
+	_scales.push_back(glm::vec3(1.0f, 1.0f, 1.0f));
+	_scaleOrigins.push_back(glm::vec3());
+	_parents.push_back(-1);
+	_dirty.push_back(1);
+	_modelMats.push_back(glm::mat4());
+	_generations.push_back(0);
+	_handles.push_back(handle);
+	_motions.push_back(-1);
+	return handle;
+}
+
+void TransformManager::Remove(int handle)
+{
+	// The slot stays as a gap until the next update closes it, so removing many at once stays linear
+	if (_motions[_slots[handle]] >= 0) RemoveMotion(_slots[handle]);
+	// The handle could be given to another transform before a snapshot still holding it is applied
+	std::replace(_snapshotHandles.begin(), _snapshotHandles.end(), handle, -1);
+	_handles[_slots[handle]] = -1;
+	_slots[handle] = -1;
+	_transforms[handle] = NULL;
+	_freeHandles.push_back(handle);
+	_reorder = true;
+}
+
+void TransformManager::Copy(int handle, int source)
+{
+	int slot = _slots[handle];
+	int sourceSlot = _slots[source];
+	_positions[slot] = _positions[sourceSlot];
+	_rotationOrigins[slot] = _rotationOrigins[sourceSlot];
+	_rotations[slot] = _rotations[sourceSlot];
+	_scales[slot] = _scales[sourceSlot];
+	_scaleOrigins[slot] = _scaleOrigins[sourceSlot];
+	_parents[slot] = _parents[sourceSlot];
+	_dirty[slot] = 1;
+	if (_parents[slot] > slot) _reorder = true;
+
+	int motion = _motions[sourceSlot];
+	if (motion >= 0) Motion(handle, _linearVelocities[motion], _angularVelocities[motion]);
+	else Motion(handle, _noLinearVelocity, _noAngularVelocity);
+}
+
+void TransformManager::Parent(int handle, int parentHandle)
+{
+	int slot = _slots[handle];
+	_parents[slot] = parentHandle >= 0 ? _slots[parentHandle] : -1;
+	_dirty[slot] = 1;
+	if (_parents[slot] > slot) _reorder = true;
+}
+
+void TransformManager::Motion(int handle, const glm::vec3& linearVelocity, const glm::quat& angularVelocity)
+{
+	// Copied first, they may point into the arrays about to change
+	glm::vec3 linear = linearVelocity;
+	glm::quat angular = angularVelocity;
+
+	int slot = _slots[handle];
+	if (linear == _noLinearVelocity && angular == _noAngularVelocity)
+	{
+		if (_motions[slot] >= 0) RemoveMotion(slot);
+		return;
+	}
+
+	if (_motions[slot] < 0)
+	{
+		_motions[slot] = _movingSlots.size();
+		_movingSlots.push_back(slot);
+		_linearVelocities.push_back(linear);
+		_angularVelocities.push_back(angular);
+		return;
+	}
+	_linearVelocities[_motions[slot]] = linear;
+	_angularVelocities[_motions[slot]] = angular;
+}
+
+void TransformManager::RemoveMotion(int slot)
+{
+	// The last one moves into the hole
+	int motion = _motions[slot];
+	int last = _movingSlots.size() - 1;
+	_movingSlots[motion] = _movingSlots[last];
+	_linearVelocities[motion] = _linearVelocities[last];
+	_angularVelocities[motion] = _angularVelocities[last];
+	_motions[_movingSlots[motion]] = motion;
+	_movingSlots.pop_back();
+	_linearVelocities.pop_back();
+	_angularVelocities.pop_back();
+	_motions[slot] = -1;
+}
+
+void TransformManager::MarkDirty(int handle)
+{
+	_dirty[_slots[handle]] = 1;
+}
+
+void TransformManager::Reorder()
+{
+	unsigned int numSlots = _positions.size();
+
+	// A transform whose parent went away hangs off nothing from then on
+	_depths.assign(numSlots, -1);
+	int maxDepth = 0;
+	for (unsigned int slot = 0; slot < numSlots; ++slot)
+	{
+		if (_handles[slot] < 0)
+			continue;
+		int parent = _parents[slot];
+		if (parent >= 0 && _handles[parent] < 0)
+		{
+			_parents[slot] = -1;
+			_dirty[slot] = 1;
+		}
+	}
+	for (unsigned int slot = 0; slot < numSlots; ++slot)
+	{
+		if (_handles[slot] >= 0) maxDepth = std::max(maxDepth, Depth(slot));
+	}
+
+	// Stable by depth, so transforms at the same depth keep the order they were made in
+	_order.clear();
+	for (int depth = 0; depth <= maxDepth; ++depth)
+	{
+		for (unsigned int slot = 0; slot < numSlots; ++slot)
+		{
+			if (_handles[slot] >= 0 && _depths[slot] == depth) _order.push_back(slot);
+		}
+	}
+
+	Permute(_positions);
+	Permute(_rotationOrigins);
+	Permute(_rotations);
+	Permute(_scales);
+	Permute(_scaleOrigins);
+	Permute(_parents);
+	Permute(_dirty);
+	Permute(_modelMats);
+	Permute(_generations);
+	Permute(_handles);
+	Permute(_motions);
+
+	// Depths are done with, they now hold where each old slot went
+	for (unsigned int slot = 0; slot < _order.size(); ++slot)
+	{
+		_depths[_order[slot]] = slot;
+	}
+	for (unsigned int slot = 0; slot < _order.size(); ++slot)
+	{
+		if (_parents[slot] >= 0) _parents[slot] = _depths[_parents[slot]];
+		_slots[_handles[slot]] = slot;
+	}
+	for (unsigned int i = 0; i < _movingSlots.size(); ++i)
+	{
+		_movingSlots[i] = _depths[_movingSlots[i]];
+	}
+	_reorder = false;
+}
+
+int TransformManager::Depth(int slot)
+{
+	if (_depths[slot] < 0) _depths[slot] = _parents[slot] >= 0 ? Depth(_parents[slot]) + 1 : 0;
+	return _depths[slot];
+}
+
+template <typename T> void TransformManager::Permute(std::vector<T>& values)
+{
+	std::vector<T> permuted = std::vector<T>(_order.size());
+	for (unsigned int slot = 0; slot < _order.size(); ++slot)
+	{
+		permuted[slot] = values[_order[slot]];
+	}
+	values.swap(permuted);
+}
+
+glm::mat4 TransformManager::LocalMat(int slot)
+{
+	glm::mat3 rotation = glm::mat3_cast(_rotations[slot]);
+	const glm::vec3& scale = _scales[slot];
+	const glm::vec3& rotationOrigin = _rotationOrigins[slot];
+	const glm::vec3& scaleOrigin = _scaleOrigins[slot];
+
+	// Scaling after rotating scales the rows of the rotation, each origin only shifts the translation
+	glm::vec3 translation = _positions[slot] + scale * (rotationOrigin - rotation * rotationOrigin) + scaleOrigin - scale * scaleOrigin;
+	return glm::mat4(
+		glm::vec4(scale * rotation[0], 0.0f),
+		glm::vec4(scale * rotation[1], 0.0f),
+		glm::vec4(scale * rotation[2], 0.0f),
+		glm::vec4(translation, 1.0f));
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include <vector>
+
+class Transform;
+
+// Keeps the local position, rotation and scale of every Transform in one array per value, ordered so a parent always
+// comes before its children. Setting a value only marks the transform, Update rebuilds the model matrices of the marked
+// ones and everything below them in a single pass, so a child always sees the finished matrix of its parent and nothing
+// that stood still is rebuilt. Transforms refer to their slot through a handle, which stays put when the slots move.
+// Velocities are kept apart, packed for just the transforms that have one, so a still transform is never integrated.
+class TransformManager
+{
+public:
+	// Moves every transform that has a velocity by it
+	static void Integrate(float dt);
+	// Only the moving transforms in [begin, end), each writes nothing but its own slot so ranges can run on any thread
+	static void Integrate(float dt, int begin, int end);
+	static int numMoving();
+
+	// Pipelined frames integrate from a snapshot instead, so the motion can run on another thread while the arrays are
+	// read and changed as usual. Snapshot copies the velocities of the moving transforms and returns how many,
+	// IntegrateSnapshot turns ranges of them into how far each moves and turns in dt on any thread, and ApplySnapshot adds
+	// that to the transforms once it is done.
+	static int Snapshot(float dt);
+	static void IntegrateSnapshot(int begin, int end);
+	static int numSnapshot();
+	static void ApplySnapshot();
+
+	// Rebuilds the model matrix of every transform set since the last update, and of every child of one
+	static void Update();
+private:
+	friend class Transform;
+
+	static int Add(Transform* transform);
+	static void Remove(int handle);
+	static void Copy(int handle, int source);
+	static void Parent(int handle, int parentHandle);
+	// A transform with neither velocity leaves the moving arrays
+	static void Motion(int handle, const glm::vec3& linearVelocity, const glm::quat& angularVelocity);
+	static void RemoveMotion(int slot);
+	static void MarkDirty(int handle);
+
+	// Puts parents back before their children and closes the gaps left by removed transforms
+	static void Reorder();
+	static int Depth(int slot);
+	template <typename T> static void Permute(std::vector<T>& values);
+
+	// translate(position) * scaleOrigin * scale * scaleOrigin^-1 * rotationOrigin * rotation * rotationOrigin^-1, with the
+	// inverses of the origins written out as the negated translations they are
+	static glm::mat4 LocalMat(int slot);
+private:
+	// By slot, parents before children
+	static std::vector<glm::vec3> _positions;
+	static std::vector<glm::vec3> _rotationOrigins;
+	static std::vector<glm::quat> _rotations;
+	static std::vector<glm::vec3> _scales;
+	static std::vector<glm::vec3> _scaleOrigins;
+	static std::vector<int> _parents;
+	static std::vector<char> _dirty;
+	static std::vector<glm::mat4> _modelMats;
+	// Bumped whenever Update rebuilds the slot's model matrix
+	static std::vector<unsigned int> _generations;
+	static std::vector<int> _handles;
+	// Index into the moving arrays, -1 for a transform without a velocity
+	static std::vector<int> _motions;
+
+	// By moving index, the slot each one moves
+	static std::vector<int> _movingSlots;
+	static std::vector<glm::vec3> _linearVelocities;
+	static std::vector<glm::quat> _angularVelocities;
+	// What the velocities of a transform that isn't moving read as
+	static glm::vec3 _noLinearVelocity;
+	static glm::quat _noAngularVelocity;
+
+	// By snapshot index, the handle of each moving transform and its velocities, which IntegrateSnapshot turns into the
+	// move and turn over _snapshotDt. Only the handles are touched while it runs, removing a transform clears its own.
+	static std::vector<int> _snapshotHandles;
+	static std::vector<glm::vec3> _snapshotMoves;
+	static std::vector<glm::quat> _snapshotTurns;
+	static float _snapshotDt;
+
+	// By handle
+	static std::vector<int> _slots;
+	static std::vector<Transform*> _transforms;
+	static std::vector<int> _freeHandles;
+
+	// Scratch for Reorder, slot each new slot comes from
+	static std::vector<int> _order;
+	static std::vector<int> _depths;
+
+	static bool _reorder;
+};